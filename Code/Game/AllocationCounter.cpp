@@ -0,0 +1,263 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/AllocationCounter.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/PlatformMemory.hpp"
+//Standard
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Plain globals with constant initialization, so they are valid for allocations made before main
+static std::atomic<bool> gIsCountingEnabled{ false };
+static std::atomic<uint64_t> gNumCountedAllocations{ 0 };
+static std::atomic<uint64_t> gNumCountedBytes{ 0 };
+
+static AllocationScopeFailure gScopeFailures[AllocationCounter::MAX_SCOPE_FAILURES];
+static int gNumScopeFailures = 0;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void* CountedAllocate(size_t size)
+{
+	AllocationCounter::CountAllocation(size);
+	return malloc(size == 0 ? 1 : size);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void* CountedAlignedAllocate(size_t size, std::align_val_t alignment)
+{
+	//PlatformMemory counts the block itself. posix_memalign wants at least pointer alignment
+	size_t alignmentBytes = (size_t)alignment < sizeof(void*) ? sizeof(void*) : (size_t)alignment;
+	return PlatformMemory::AlignedAllocate(size == 0 ? 1 : size, alignmentBytes);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new(size_t size)
+{
+	void* ptr = CountedAllocate(size);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete[](void* ptr) noexcept
+{
+	free(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete[](void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* ptr = CountedAlignedAllocate(size, alignment);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return CountedAlignedAllocate(size, alignment);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return CountedAlignedAllocate(size, alignment);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	PlatformMemory::AlignedFree(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+	PlatformMemory::AlignedFree(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+	PlatformMemory::AlignedFree(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+	PlatformMemory::AlignedFree(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	PlatformMemory::AlignedFree(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	PlatformMemory::AlignedFree(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationCounter::SetEnabled(bool isEnabled)
+{
+	gIsCountingEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool AllocationCounter::IsEnabled()
+{
+	return gIsCountingEnabled.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationCounter::CountAllocation(size_t numBytes)
+{
+	if (gIsCountingEnabled.load(std::memory_order_relaxed))
+	{
+		gNumCountedAllocations.fetch_add(1, std::memory_order_relaxed);
+		gNumCountedBytes.fetch_add(numBytes, std::memory_order_relaxed);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const char* AllocationCounter::GetCoverageDescription()
+{
+	return "operator new, aligned new and PlatformMemory blocks including PhysX pool slabs, plain malloc is not counted";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t AllocationCounter::GetNumAllocations()
+{
+	return gNumCountedAllocations.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t AllocationCounter::GetNumBytes()
+{
+	return gNumCountedBytes.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationCounter::RecordScopeFailure(const char* scopeName, uint64_t numAllocations, uint64_t numBytes)
+{
+	//Fixed storage, recording a failure must not allocate and trip the next scope
+	if (gNumScopeFailures == MAX_SCOPE_FAILURES)
+	{
+		return;
+	}
+
+	AllocationScopeFailure& failure = gScopeFailures[gNumScopeFailures];
+	failure.m_scopeName = scopeName;
+	failure.m_numAllocations = numAllocations;
+	failure.m_numBytes = numBytes;
+	gNumScopeFailures++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC int AllocationCounter::GetNumScopeFailures()
+{
+	return gNumScopeFailures;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const AllocationScopeFailure& AllocationCounter::GetScopeFailure(int failureIndex)
+{
+	return gScopeFailures[failureIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void AllocationCounter::ClearScopeFailures()
+{
+	gNumScopeFailures = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ScopedAllocationCheck::ScopedAllocationCheck(const char* scopeName)
+	: m_scopeName(scopeName)
+{
+	m_numAllocationsAtStart = AllocationCounter::GetNumAllocations();
+	m_numBytesAtStart = AllocationCounter::GetNumBytes();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ScopedAllocationCheck::~ScopedAllocationCheck()
+{
+	if (!AllocationCounter::IsEnabled())
+	{
+		return;
+	}
+
+	uint64_t numAllocations = AllocationCounter::GetNumAllocations() - m_numAllocationsAtStart;
+	if (numAllocations > 0)
+	{
+		AllocationCounter::RecordScopeFailure(m_scopeName, numAllocations, AllocationCounter::GetNumBytes() - m_numBytesAtStart);
+	}
+}
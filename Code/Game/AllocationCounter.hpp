@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Standard
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct AllocationScopeFailure
+{
+	const char*							m_scopeName = nullptr;
+	uint64_t							m_numAllocations = 0;
+	uint64_t							m_numBytes = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Counts heap allocations while enabled: global operator new, the C++17 aligned operator new, and every block that
+// PlatformMemory::AlignedAllocate hands out, which covers the PhysX pool slabs and large pool blocks. Plain malloc is not
+// seen, that includes the PhysX foundation's own default allocator and anything the Engine or drivers malloc directly.
+// The replacement operators live in AllocationCounter.cpp and always forward to the heap, enabling only turns the counting
+// on. Used by the allocation test mode, which enables it after a warm-up and fails on any ScopedAllocationCheck that allocates
+//------------------------------------------------------------------------------------------------------------------------------
+class AllocationCounter
+{
+public:
+	static const int MAX_SCOPE_FAILURES = 16;
+
+public:
+	static void							SetEnabled(bool isEnabled);
+	static bool							IsEnabled();
+
+	//For heap paths that don't go through operator new
+	static void							CountAllocation(size_t numBytes);
+	//What the counts cover, printed next to them
+	static const char*					GetCoverageDescription();
+
+	//Totals across every thread since counting was enabled
+	static uint64_t						GetNumAllocations();
+	static uint64_t						GetNumBytes();
+
+	//Failures recorded since the last clear, the App drains these once a frame
+	static void							RecordScopeFailure(const char* scopeName, uint64_t numAllocations, uint64_t numBytes);
+	static int							GetNumScopeFailures();
+	static const AllocationScopeFailure&	GetScopeFailure(int failureIndex);
+	static void							ClearScopeFailures();
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Marks a steady-state path that must not touch the heap. Does nothing unless the counter is enabled. Allocations made by
+// other threads while the scope is open are attributed to it too
+//------------------------------------------------------------------------------------------------------------------------------
+class ScopedAllocationCheck
+{
+public:
+	explicit ScopedAllocationCheck(const char* scopeName);
+	~ScopedAllocationCheck();
+
+private:
+	const char*							m_scopeName = nullptr;
+	uint64_t							m_numAllocationsAtStart = 0;
+	uint64_t							m_numBytesAtStart = 0;
+};
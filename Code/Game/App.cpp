@@ -14,7 +14,10 @@
 #include "Engine/Renderer/RenderContext.hpp"
 #include "Engine/PhysXSystem/PhysXSystem.hpp"
 //Game Systems
+#include "Game/AllocationCounter.hpp"
+#include "Game/FrameArena.hpp"
 #include "Game/Game.hpp"
+#include "Game/Profiler.hpp"
 
 App* g_theApp = nullptr;
 
@@ -55,10 +58,20 @@ void App::LoadGameBlackBoard()
 		XMLElement* rootElement = gameconfig.RootElement();
 		g_gameConfigBlackboard.PopulateFromXmlElementAttributes(*rootElement);
 	}
+
+	m_fixedPhysicsStep = g_gameConfigBlackboard.GetValue("physicsStep", m_fixedPhysicsStep);
+	m_maxPhysicsStepsPerFrame = g_gameConfigBlackboard.GetValue("maxPhysicsStepsPerFrame", m_maxPhysicsStepsPerFrame);
+	m_pipelinedPhysics = g_gameConfigBlackboard.GetValue("pipelinedPhysics", m_pipelinedPhysics);
+	m_inPlaceSceneReset = g_gameConfigBlackboard.GetValue("inPlaceSceneReset", m_inPlaceSceneReset);
+	m_frameArenaKB = g_gameConfigBlackboard.GetValue("frameArenaKB", m_frameArenaKB);
+	m_allocationTestMode = g_gameConfigBlackboard.GetValue("allocationTestMode", m_allocationTestMode);
+	m_allocationTestWarmupFrames = g_gameConfigBlackboard.GetValue("allocationTestWarmupFrames", m_allocationTestWarmupFrames);
 }
 
 void App::StartUp()
 {
+	Profiler::SetThreadName("Main");
+
 	LoadGameBlackBoard();
 
 	g_eventSystem = new EventSystems();
@@ -85,6 +98,8 @@ void App::StartUp()
 
 	g_RNG = new RandomNumberGenerator(0);
 
+	g_frameArena = new FrameArena((size_t)m_frameArenaKB * 1024);
+
 	m_game = new Game();
 	m_game->StartUp();
 	
@@ -93,6 +108,11 @@ void App::StartUp()
 
 void App::ShutDown()
 {
+	FinishPhysicsStep();
+
+	//Game releases its PhysX objects, so it has to go before the PhysX system
+	m_game->Shutdown();
+
 	delete g_ImGUI;
 	g_ImGUI = nullptr;
 
@@ -120,47 +140,106 @@ void App::ShutDown()
 	delete g_RNG;
 	g_RNG = nullptr;
 
-	m_game->Shutdown();
+	delete g_frameArena;
+	g_frameArena = nullptr;
 }
 
 void App::RunFrame()
 {
-	BeginFrame();	
+	{
+		PROFILE_SCOPE("App::RunFrame");
+
+		BeginFrame();	
 	
-	Update();
-	Render();	
+		Update();
+		Render();	
 
-	PostRender();
+		PostRender();
 
-	EndFrame();
+		EndFrame();
+	}
+
+	//After the frame zone has closed so the last frame of a capture is complete
+	if (Profiler::EndFrame())
+	{
+		char report[256];
+		snprintf(report, sizeof(report), "Profile capture: %d zones (%d dropped) %s %s", Profiler::GetLastNumEvents(), Profiler::GetLastNumDroppedEvents(),
+			Profiler::WasLastTraceWritten() ? "written to" : "could not be written to", Profiler::GetLastTracePath().c_str());
+		g_devConsole->PrintString(Profiler::WasLastTraceWritten() ? Rgba::GREEN : Rgba::RED, report);
+	}
 }
 
 void App::BeginFrame()
 {
-	g_renderContext->BeginFrame();
-	g_inputSystem->BeginFrame();
-	g_audio->BeginFrame();
-	g_devConsole->BeginFrame();
-	g_eventSystem->BeginFrame();
-	g_debugRenderer->BeginFrame();
-	g_ImGUI->BeginFrame();
-	g_PxPhysXSystem->BeginFrame();
+	PROFILE_SCOPE("App::BeginFrame");
+
+	{ PROFILE_SCOPE("RenderContext::BeginFrame");	g_renderContext->BeginFrame(); }
+	{ PROFILE_SCOPE("InputSystem::BeginFrame");		g_inputSystem->BeginFrame(); }
+	//The controller state every fixed step reads this frame was polled just now, not when the step runs
+	m_game->GetInputLatencyTracker().OnInputSampled(InputLatencyTracker::GetTimeSeconds());
+	{ PROFILE_SCOPE("AudioSystem::BeginFrame");		g_audio->BeginFrame(); }
+	{ PROFILE_SCOPE("DevConsole::BeginFrame");		g_devConsole->BeginFrame(); }
+	{ PROFILE_SCOPE("EventSystems::BeginFrame");	g_eventSystem->BeginFrame(); }
+	{ PROFILE_SCOPE("DebugRender::BeginFrame");		g_debugRenderer->BeginFrame(); }
+	{ PROFILE_SCOPE("ImGUISystem::BeginFrame");		g_ImGUI->BeginFrame(); }
+	{ PROFILE_SCOPE("PhysXSystem::BeginFrame");		g_PxPhysXSystem->BeginFrame(); }
+
+	if (m_allocationTestMode && m_frameIndex == m_allocationTestWarmupFrames)
+	{
+		//Caches, pools and lazily built meshes have all been filled by now
+		AllocationCounter::SetEnabled(true);
+		g_devConsole->PrintString(Rgba::WHITE, "Allocation test armed, steady-state scopes must not allocate from here on");
+	}
 }
 
 void App::EndFrame()
 {
-	g_renderContext->EndFrame();
-	g_inputSystem->EndFrame();
-	g_audio->EndFrame();
-	g_devConsole->EndFrame();
-	g_eventSystem->EndFrame();
-	g_debugRenderer->EndFrame();
-	g_ImGUI->EndFrame();
-	g_PxPhysXSystem->EndFrame();
+	PROFILE_SCOPE("App::EndFrame");
+
+	//Present happens in here, so this zone also shows time spent waiting on the GPU
+	{ PROFILE_SCOPE("RenderContext::EndFrame");		g_renderContext->EndFrame(); }
+	{ PROFILE_SCOPE("InputSystem::EndFrame");		g_inputSystem->EndFrame(); }
+	{ PROFILE_SCOPE("AudioSystem::EndFrame");		g_audio->EndFrame(); }
+	{ PROFILE_SCOPE("DevConsole::EndFrame");		g_devConsole->EndFrame(); }
+	{ PROFILE_SCOPE("EventSystems::EndFrame");		g_eventSystem->EndFrame(); }
+	{ PROFILE_SCOPE("DebugRender::EndFrame");		g_debugRenderer->EndFrame(); }
+	{ PROFILE_SCOPE("ImGUISystem::EndFrame");		g_ImGUI->EndFrame(); }
+	{ PROFILE_SCOPE("PhysXSystem::EndFrame");		g_PxPhysXSystem->EndFrame(); }
+
+	g_frameArena->Reset();
+	CheckSteadyStateAllocations();
+	m_frameIndex++;
+}
+
+void App::CheckSteadyStateAllocations()
+{
+	int numFailures = AllocationCounter::GetNumScopeFailures();
+	if (numFailures == 0)
+	{
+		return;
+	}
+
+	char report[256];
+	for (int failureIndex = 0; failureIndex < numFailures; ++failureIndex)
+	{
+		const AllocationScopeFailure& failure = AllocationCounter::GetScopeFailure(failureIndex);
+		snprintf(report, sizeof(report), "Frame %d: %s made %llu heap allocations (%llu bytes)", m_frameIndex, failure.m_scopeName,
+			(unsigned long long)failure.m_numAllocations, (unsigned long long)failure.m_numBytes);
+		g_devConsole->PrintString(Rgba::RED, report);
+	}
+
+	g_devConsole->PrintString(Rgba::RED, AllocationCounter::GetCoverageDescription());
+
+	const AllocationScopeFailure& firstFailure = AllocationCounter::GetScopeFailure(0);
+	snprintf(report, sizeof(report), "Allocation test failed: %s allocated %llu times on frame %d", firstFailure.m_scopeName,
+		(unsigned long long)firstFailure.m_numAllocations, m_frameIndex);
+	ERROR_AND_DIE(report);
 }
 
 void App::Update()
 {	
+	PROFILE_SCOPE("App::Update");
+
 	m_timeAtLastFrameBegin = m_timeAtThisFrameBegin;
 	m_timeAtThisFrameBegin = GetCurrentTimeSeconds();
 
@@ -182,20 +261,166 @@ void App::Update()
 	g_debugRenderer->DebugAddToLog(options, text, Rgba::WHITE, 0.f, deltaTime);
 
 	g_devConsole->UpdateConsole(deltaTime);
-	g_PxPhysXSystem->Update(deltaTime);
+	UpdatePhysics(deltaTime);
+
+	text = "Physics Steps %d";
+	g_debugRenderer->DebugAddToLog(options, text, Rgba::WHITE, 0.f, m_physicsStepsThisFrame);
+
+	text = "Dropped Physics Time %f";
+	g_debugRenderer->DebugAddToLog(options, text, m_droppedPhysicsSeconds > 0.f ? Rgba::YELLOW : Rgba::WHITE, 0.f, m_droppedPhysicsSeconds);
 
 	m_game->Update(deltaTime);
 
 	g_debugRenderer->Update(deltaTime);
 }
 
+void App::UpdatePhysics(float deltaTime)
+{
+	PROFILE_SCOPE("App::UpdatePhysics");
+
+	if (m_pipelinedPhysics)
+	{
+		UpdatePhysicsPipelined(deltaTime);
+		return;
+	}
+
+	ProcessQueuedSceneChanges();
+
+	//Physics always advances in fixed steps. Whatever is left over carries to the next frame and is used to interpolate render poses
+	m_physicsAccumulator += deltaTime;
+	m_physicsStepsThisFrame = 0;
+
+	while (m_physicsAccumulator >= m_fixedPhysicsStep && m_physicsStepsThisFrame < m_maxPhysicsStepsPerFrame)
+	{
+		m_game->FixedUpdate(m_fixedPhysicsStep);
+		{
+			PROFILE_SCOPE("PhysXSystem::Update");
+			g_PxPhysXSystem->Update(m_fixedPhysicsStep);
+		}
+		m_game->PostPhysicsStep();
+
+		m_physicsAccumulator -= m_fixedPhysicsStep;
+		m_physicsStepsThisFrame++;
+	}
+
+	DropPhysicsBacklog();
+	m_game->SetPhysicsInterpolation(m_physicsAccumulator / m_fixedPhysicsStep);
+}
+
+void App::UpdatePhysicsPipelined(float deltaTime)
+{
+	m_physicsAccumulator += deltaTime;
+	m_physicsStepsThisFrame = 0;
+
+	//Retire the step kicked last frame. This is the only point we block on the simulation
+	if (m_isPhysicsStepInFlight)
+	{
+		FinishPhysicsStep();
+		m_game->PostPhysicsStep();
+	}
+
+	//Game::Update runs while the next step simulates, so anything that writes the scene from it waits until here
+	ProcessQueuedSceneChanges();
+
+	//Only one step can be in flight. When more than one is due the extra ones run blocking first, so simulated time keeps
+	//up with wall time the same way it does in the serial loop
+	while (m_physicsAccumulator >= 2.f * m_fixedPhysicsStep && m_physicsStepsThisFrame < m_maxPhysicsStepsPerFrame - 1)
+	{
+		m_game->FixedUpdate(m_fixedPhysicsStep);
+		{
+			PROFILE_SCOPE("PhysXSystem::Update");
+			g_PxPhysXSystem->Update(m_fixedPhysicsStep);
+		}
+		m_game->PostPhysicsStep();
+
+		m_physicsAccumulator -= m_fixedPhysicsStep;
+		m_physicsStepsThisFrame++;
+	}
+
+	if (m_physicsAccumulator >= m_fixedPhysicsStep)
+	{
+		m_game->FixedUpdate(m_fixedPhysicsStep);
+		KickPhysicsStep();
+
+		m_physicsAccumulator -= m_fixedPhysicsStep;
+		m_physicsStepsThisFrame++;
+	}
+
+	DropPhysicsBacklog();
+	m_game->SetPhysicsInterpolation(m_physicsAccumulator / m_fixedPhysicsStep);
+}
+
+void App::ProcessQueuedSceneChanges()
+{
+	if (!m_isSceneResetQueued)
+	{
+		return;
+	}
+
+	m_isSceneResetQueued = false;
+
+	if (m_inPlaceSceneReset)
+	{
+		m_game->ResetScene();
+		m_physicsAccumulator = 0.f;
+		return;
+	}
+
+	//Kill and restart the app. The destructor only frees the simulation, Shutdown takes the render resources with it
+	m_game->Shutdown();
+	delete m_game;
+	m_game = nullptr;
+	m_game = new Game();
+	m_game->StartUp();
+	m_physicsAccumulator = 0.f;
+}
+
+void App::DropPhysicsBacklog()
+{
+	//At the step cap, drop the backlog instead of trying to catch up next frame and falling further behind. What was given
+	//up is added to the debug log total, so a run that can't keep up shows it
+	if (m_physicsStepsThisFrame == m_maxPhysicsStepsPerFrame && m_physicsAccumulator > m_fixedPhysicsStep)
+	{
+		m_droppedPhysicsSeconds += m_physicsAccumulator - m_fixedPhysicsStep;
+		m_physicsAccumulator = m_fixedPhysicsStep;
+	}
+}
+
+void App::KickPhysicsStep()
+{
+	PROFILE_SCOPE("PxScene::simulate");
+
+	//Game update and render only read the pose snapshot while this runs. Vehicle updates already happened in FixedUpdate
+	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
+	scene->simulate(m_fixedPhysicsStep);
+	m_isPhysicsStepInFlight = true;
+}
+
+void App::FinishPhysicsStep()
+{
+	if (!m_isPhysicsStepInFlight)
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("PxScene::fetchResults");
+
+	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
+	scene->fetchResults(true);
+	m_isPhysicsStepInFlight = false;
+}
+
 void App::Render() const
 {
+	PROFILE_SCOPE("App::Render");
+	ScopedAllocationCheck allocationCheck("App::Render");
 	m_game->Render();	
 }
 
 void App::PostRender()
 {
+	PROFILE_SCOPE("App::PostRender");
+	ScopedAllocationCheck allocationCheck("App::PostRender");
 	m_game->PostRender();
 }
 
@@ -234,11 +459,8 @@ bool App::HandleKeyPressed(unsigned char keyCode)
 		}
 		case F8_KEY:
 		{
-			//Kill and restart the app
-			delete m_game;
-			m_game = nullptr;
-			m_game = new Game();
-			m_game->StartUp();
+			//The scene can't be touched while a step is still running, UpdatePhysics resets or restarts once it is retired
+			m_isSceneResetQueued = true;
 			return true;
 		}
 		case KEY_ESC:
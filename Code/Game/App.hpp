@@ -31,9 +31,16 @@ private:
 	//Private methods
 	void BeginFrame();
 	void Update();
+	void UpdatePhysics(float deltaTime);
+	void UpdatePhysicsPipelined(float deltaTime);
+	void KickPhysicsStep();
+	void FinishPhysicsStep();
+	void ProcessQueuedSceneChanges();
+	void DropPhysicsBacklog();
 	void Render() const;
 	void PostRender();
 	void EndFrame();
+	void CheckSteadyStateAllocations();
 
 public:
 	//public variables
@@ -52,4 +59,29 @@ private:
 	double		m_timeAtLastFrameBegin = 0;
 	double		m_timeAtThisFrameBegin = 0;
 
+	//Fixed step physics
+	float		m_fixedPhysicsStep = 1.f / 60.f;
+	int			m_maxPhysicsStepsPerFrame = 4;
+	float		m_physicsAccumulator = 0.f;
+	int			m_physicsStepsThisFrame = 0;
+	//Simulated time given up at the step cap since start up, shown in the debug log
+	float		m_droppedPhysicsSeconds = 0.f;
+
+	//When pipelined, simulate() for the next step runs while the game updates and renders from the last fetched step
+	bool		m_pipelinedPhysics = false;
+	bool		m_isPhysicsStepInFlight = false;
+
+	//F8 restores the initial poses in place instead of recreating the Game
+	bool		m_inPlaceSceneReset = true;
+	//F8 waits for UpdatePhysics, where no step is in flight and the last one has been through PostPhysicsStep
+	bool		m_isSceneResetQueued = false;
+
+	//Scratch memory reset every EndFrame
+	int			m_frameArenaKB = 256;
+
+	//Test mode that fails on any heap allocation in a steady-state scope once the warm-up frames are over
+	bool		m_allocationTestMode = false;
+	int			m_allocationTestWarmupFrames = 120;
+	int			m_frameIndex = 0;
+
 };
\ No newline at end of file
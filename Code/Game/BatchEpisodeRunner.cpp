@@ -0,0 +1,426 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/BatchEpisodeRunner.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/CarController.hpp"
+#include "Game/Game.hpp"
+#include "Game/HeadlessApp.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/VehicleManager.hpp"
+#include "Game/WorkerPool.hpp"
+//Standard
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+#include <unordered_set>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Template actors are read in batches of this many
+const PxU32 gBatchEpisodeActorBatch = 64;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static double GetBatchTimeSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+BatchEpisodeRunner::BatchEpisodeRunner(const BatchEpisodeSettings& settings)
+	: m_settings(settings)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+BatchEpisodeRunner::~BatchEpisodeRunner()
+{
+	ShutDown();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::SetInputScript(const std::vector<ScriptedVehicleInput>& inputScript, float scriptLoopSeconds)
+{
+	m_inputScript = &inputScript;
+	m_scriptLoopSeconds = scriptLoopSeconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::StartUp(const Game& templateGame)
+{
+	if (m_settings.m_numEpisodes <= 0 || m_settings.m_numStepsPerEpisode <= 0 || m_settings.m_stepSeconds <= 0.f)
+	{
+		ERROR_AND_DIE(">> Batch episodes need a positive episode count, step count and step size");
+	}
+
+	if (!m_stepFunction && m_inputScript == nullptr)
+	{
+		ERROR_AND_DIE(">> Batch episodes need an input script or a step function to drive the player car");
+	}
+
+	if (m_playerDescriptors != nullptr && (int)m_playerDescriptors->size() < m_settings.m_numEpisodes)
+	{
+		ERROR_AND_DIE(">> Batch episodes need a player descriptor for every episode");
+	}
+
+	double startUpStart = GetBatchTimeSeconds();
+
+	//Episode threads and dispatcher threads come out of the same cores, so left at 0 the episode threads take what the
+	//dispatcher leaves instead of both asking for every core
+	m_numHardwareThreads = (int)std::thread::hardware_concurrency();
+	m_numHardwareThreads = m_numHardwareThreads > 0 ? m_numHardwareThreads : 1;
+	m_numThreadsUsed = m_settings.m_numThreads > 0 ? m_settings.m_numThreads : m_numHardwareThreads - m_settings.m_numDispatcherThreads;
+	m_numThreadsUsed = m_numThreadsUsed > 0 ? m_numThreadsUsed : 1;
+
+	if (m_numThreadsUsed + m_settings.m_numDispatcherThreads > m_numHardwareThreads)
+	{
+		printf("\n >> Batch episodes : %i episode threads and %i dispatcher threads oversubscribe %i hardware threads, throughput will suffer",
+			m_numThreadsUsed, m_settings.m_numDispatcherThreads, m_numHardwareThreads);
+	}
+	m_cpuDispatcher = PxDefaultCpuDispatcherCreate((PxU32)m_settings.m_numDispatcherThreads);
+
+	m_templateGame = &templateGame;
+	m_aiVehicleRoute = templateGame.GetAIVehicleRoute();
+	m_aiVehicleThrottle = templateGame.m_aiVehicleThrottle;
+
+	m_episodes.resize(m_settings.m_numEpisodes);
+	if (!m_settings.m_runInWaves)
+	{
+		CreateEpisodes(0, m_settings.m_numEpisodes);
+	}
+
+	m_startUpSeconds = GetBatchTimeSeconds() - startUpStart;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::CreateEpisodes(int firstEpisodeIndex, int endEpisodeIndex)
+{
+	//Built one after the other on this thread, the archetype registry is not thread safe and the template scene is read without locks
+	for (int episodeIndex = firstEpisodeIndex; episodeIndex < endEpisodeIndex; ++episodeIndex)
+	{
+		CreateEpisode(*m_templateGame, episodeIndex);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::CreateEpisode(const Game& templateGame, int episodeIndex)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	const PxScene& templateScene = *g_PxPhysXSystem->GetPhysXScene();
+
+	BatchEpisode& episode = m_episodes[episodeIndex];
+	episode.m_episodeIndex = episodeIndex;
+	episode.m_scriptOffsetSeconds = m_scriptLoopSeconds * (float)episodeIndex / (float)m_settings.m_numEpisodes;
+
+	//Same simulation setup as the engine's scene, only the dispatcher is swapped for the shared one
+	PxSceneDesc sceneDesc(physX->getTolerancesScale());
+	sceneDesc.gravity = templateScene.getGravity();
+	sceneDesc.cpuDispatcher = m_cpuDispatcher;
+	sceneDesc.filterShader = templateScene.getFilterShader();
+	sceneDesc.filterShaderData = templateScene.getFilterShaderData();
+	sceneDesc.filterShaderDataSize = templateScene.getFilterShaderDataSize();
+	sceneDesc.solverType = templateScene.getSolverType();
+	sceneDesc.broadPhaseType = templateScene.getBroadPhaseType();
+	sceneDesc.frictionType = templateScene.getFrictionType();
+	sceneDesc.flags = templateScene.getFlags();
+	//Nothing renders an episode, so there is no one to read the active actor list
+	sceneDesc.flags.clear(PxSceneFlag::eENABLE_ACTIVE_ACTORS);
+
+	episode.m_scene = physX->createScene(sceneDesc);
+	if (episode.m_scene == nullptr)
+	{
+		ERROR_AND_DIE(">> Could not create a batch episode scene");
+	}
+
+	CloneTemplateActors(templateGame, episode);
+
+	//Every vehicle of the template comes back at the same pose, the player car gets a CarController of its own
+	const VehicleManager& templateVehicles = *templateGame.GetVehicleManager();
+	const PxVehicleDrive4W* templatePlayer = templateGame.GetCarController()->GetVehicle();
+
+	episode.m_vehicleManager = new VehicleManager(templateVehicles.GetNumVehicles(), *episode.m_scene, m_vehicleArchetypes);
+	episode.m_vehicleManager->SetQueryLODSettings(templateGame.m_vehicleRaycastDistance, templateGame.m_vehicleCachedQuerySteps);
+	episode.m_vehicleManager->SetSimLODSettings(templateGame.m_vehicleKinematicDistance, templateGame.m_vehicleLODHysteresis, templateGame.m_vehicleReducedQuerySteps,
+		templateGame.m_vehicleMaxFullLOD, templateGame.m_vehicleMaxReducedLOD);
+
+	episode.m_vehicleManager->SetDefaultDescriptor(templateVehicles.GetDefaultDescriptor());
+
+	for (int vehicleIndex = 0; vehicleIndex < templateVehicles.GetNumVehicles(); ++vehicleIndex)
+	{
+		const PxVehicleDrive4W* templateVehicle = templateVehicles.GetVehicle(vehicleIndex);
+		PxTransform startPose = templateVehicle->getRigidDynamicActor()->getGlobalPose();
+
+		if (templateVehicle == templatePlayer)
+		{
+			const VehicleDescriptor& descriptor = m_playerDescriptors != nullptr ? (*m_playerDescriptors)[episodeIndex] : templateVehicles.GetDefaultDescriptor();
+			int episodeVehicleIndex = episode.m_vehicleManager->SpawnVehicle(startPose, descriptor);
+
+			PxVehicleDrive4W* vehicle = episode.m_vehicleManager->GetVehicle(episodeVehicleIndex);
+			episode.m_carController = new CarController(*vehicle, *episode.m_vehicleManager->GetVehicleInputData(episodeVehicleIndex));
+			episode.m_vehicleManager->SetQueryQualityOverride(episodeVehicleIndex, VEHICLE_QUERY_SWEEP);
+			episode.m_vehicleManager->SetSimLODOverride(episodeVehicleIndex, VEHICLE_LOD_FULL);
+			episode.m_playerVehicleIndex = episodeVehicleIndex;
+			episode.m_startPosition = startPose.p;
+		}
+		else if (m_settings.m_spawnTemplateAIVehicles)
+		{
+			int episodeVehicleIndex = episode.m_vehicleManager->SpawnVehicle(startPose);
+			PxVehicleDrive4WRawInputData* inputData = episode.m_vehicleManager->GetVehicleInputData(episodeVehicleIndex);
+			inputData->setAnalogAccel(templateVehicles.GetVehicleInputData(vehicleIndex)->getAnalogAccel());
+			episode.m_vehicleManager->SetLODSpline(episodeVehicleIndex, templateVehicles.GetLODSpline(vehicleIndex));
+		}
+	}
+
+	if (episode.m_carController == nullptr)
+	{
+		ERROR_AND_DIE(">> The batch episode template has no player car");
+	}
+
+	m_numVehiclesPerEpisode = episode.m_vehicleManager->GetNumVehicles();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::CloneTemplateActors(const Game& templateGame, BatchEpisode& episode)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	const PxScene& templateScene = *g_PxPhysXSystem->GetPhysXScene();
+
+	//Vehicles are spawned again through the episode's own VehicleManager
+	std::unordered_set<const PxActor*> vehicleActors;
+	const VehicleManager& templateVehicles = *templateGame.GetVehicleManager();
+	for (int vehicleIndex = 0; vehicleIndex < templateVehicles.GetNumVehicles(); ++vehicleIndex)
+	{
+		vehicleActors.insert(templateVehicles.GetVehicle(vehicleIndex)->getRigidDynamicActor());
+	}
+
+	PxActorTypeFlags actorTypes = PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC;
+	PxU32 numActors = templateScene.getNbActors(actorTypes);
+	std::vector<PxRigidDynamic*> sleepingActors;
+
+	PxActor* actors[gBatchEpisodeActorBatch];
+	for (PxU32 startIndex = 0; startIndex < numActors; startIndex += gBatchEpisodeActorBatch)
+	{
+		PxU32 numInBatch = templateScene.getActors(actorTypes, actors, gBatchEpisodeActorBatch, startIndex);
+		for (PxU32 actorIndex = 0; actorIndex < numInBatch; ++actorIndex)
+		{
+			const PxRigidActor* templateActor = static_cast<const PxRigidActor*>(actors[actorIndex]);
+
+			//Pooled projectiles are parked with simulation off, and joints are not cloned so jointed bodies would fall apart
+			bool isSimulated = !templateActor->getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION);
+			if (vehicleActors.count(templateActor) > 0 || !isSimulated || templateActor->getNbConstraints() > 0)
+			{
+				continue;
+			}
+
+			//Shared shapes stay shared, so every episode points at the same geometry and cooked meshes
+			PxTransform pose = templateActor->getGlobalPose();
+			if (templateActor->getType() == PxActorType::eRIGID_STATIC)
+			{
+				episode.m_clonedActors.push_back(PxCloneStatic(*physX, pose, *templateActor));
+				continue;
+			}
+
+			const PxRigidDynamic* templateDynamic = static_cast<const PxRigidDynamic*>(templateActor);
+			PxRigidDynamic* clone = PxCloneDynamic(*physX, pose, *templateDynamic);
+			episode.m_clonedActors.push_back(clone);
+
+			bool isKinematic = templateDynamic->getRigidBodyFlags().isSet(PxRigidBodyFlag::eKINEMATIC);
+			if (!isKinematic && templateDynamic->isSleeping())
+			{
+				sleepingActors.push_back(clone);
+			}
+		}
+	}
+
+	//One insert for the whole layout, like the bulk spawner
+	if (!episode.m_clonedActors.empty())
+	{
+		episode.m_scene->addActors(&episode.m_clonedActors[0], (PxU32)episode.m_clonedActors.size());
+	}
+
+	//Sleep can only be set once the actor is in a scene
+	for (int actorIndex = 0; actorIndex < (int)sleepingActors.size(); ++actorIndex)
+	{
+		sleepingActors[actorIndex]->putToSleep();
+	}
+
+	m_numActorsPerEpisode = (int)episode.m_clonedActors.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::Run()
+{
+	int numEpisodes = (int)m_episodes.size();
+	int waveSize = m_settings.m_runInWaves ? m_numThreadsUsed : numEpisodes;
+
+	//Whole episodes are the jobs. Idle threads keep claiming the next unstarted one of the wave, so uneven episodes still balance out
+	WorkerPool workerPool(m_numThreadsUsed);
+	m_runWallSeconds = 0.0;
+	for (int waveStart = 0; waveStart < numEpisodes; waveStart += waveSize)
+	{
+		int waveEnd = waveStart + waveSize < numEpisodes ? waveStart + waveSize : numEpisodes;
+		if (m_settings.m_runInWaves)
+		{
+			double buildStart = GetBatchTimeSeconds();
+			CreateEpisodes(waveStart, waveEnd);
+			m_startUpSeconds += GetBatchTimeSeconds() - buildStart;
+		}
+
+		double runStart = GetBatchTimeSeconds();
+		workerPool.ParallelFor(waveEnd - waveStart, [this, waveStart](int waveIndex)
+		{
+			RunEpisode(m_episodes[waveStart + waveIndex]);
+		});
+		m_runWallSeconds += GetBatchTimeSeconds() - runStart;
+
+		if (m_settings.m_runInWaves)
+		{
+			//Results stay on the episode, only the scene and its vehicles go
+			for (int episodeIndex = waveStart; episodeIndex < waveEnd; ++episodeIndex)
+			{
+				ReleaseEpisode(m_episodes[episodeIndex]);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::RunEpisode(BatchEpisode& episode)
+{
+	PROFILE_SCOPE("BatchEpisodeRunner::RunEpisode");
+
+	double episodeStart = GetBatchTimeSeconds();
+	float stepSeconds = m_settings.m_stepSeconds;
+	PxRigidDynamic* playerActor = episode.m_carController->GetVehicle()->getRigidDynamicActor();
+
+	for (int stepIndex = 0; stepIndex < m_settings.m_numStepsPerEpisode; ++stepIndex)
+	{
+		if (m_stepFunction)
+		{
+			if (!m_stepFunction(episode, stepIndex))
+			{
+				break;
+			}
+		}
+		else
+		{
+			float scriptTime = episode.m_scriptOffsetSeconds + (float)stepIndex * stepSeconds;
+			HeadlessApp::ApplyInputScript(*episode.m_carController, *m_inputScript, m_scriptLoopSeconds, scriptTime);
+		}
+
+		episode.m_vehicleManager->SetLODFocus(playerActor->getGlobalPose().p);
+		if (m_aiVehicleRoute != nullptr)
+		{
+			Game::SteerRouteVehicles(*episode.m_vehicleManager, m_aiVehicleThrottle);
+		}
+		episode.m_vehicleManager->Update(stepSeconds);
+
+		episode.m_scene->simulate(stepSeconds);
+		episode.m_scene->fetchResults(true);
+		episode.m_numStepsTaken++;
+	}
+
+	episode.m_wallSeconds = GetBatchTimeSeconds() - episodeStart;
+	episode.m_distanceTravelled = (playerActor->getGlobalPose().p - episode.m_startPosition).magnitude();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::ShutDown()
+{
+	for (int episodeIndex = 0; episodeIndex < (int)m_episodes.size(); ++episodeIndex)
+	{
+		ReleaseEpisode(m_episodes[episodeIndex]);
+	}
+	m_episodes.clear();
+
+	//Only after every scene using it is gone
+	PX_RELEASE(m_cpuDispatcher);
+	m_vehicleArchetypes.ReleaseArchetypes();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::ReleaseEpisode(BatchEpisode& episode)
+{
+	delete episode.m_carController;
+	episode.m_carController = nullptr;
+
+	//Releases the spawned vehicles and the batch queries, both need the scene still alive
+	delete episode.m_vehicleManager;
+	episode.m_vehicleManager = nullptr;
+
+	for (int actorIndex = 0; actorIndex < (int)episode.m_clonedActors.size(); ++actorIndex)
+	{
+		episode.m_clonedActors[actorIndex]->release();
+	}
+	episode.m_clonedActors.clear();
+
+	PX_RELEASE(episode.m_scene);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double BatchEpisodeRunner::GetSimulatedSeconds() const
+{
+	//Episodes a step function ended early only count the steps they took
+	double numSteps = 0.0;
+	for (int episodeIndex = 0; episodeIndex < (int)m_episodes.size(); ++episodeIndex)
+	{
+		numSteps += (double)m_episodes[episodeIndex].m_numStepsTaken;
+	}
+
+	return numSteps * (double)m_settings.m_stepSeconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double BatchEpisodeRunner::GetSimulatedSecondsPerWallSecond() const
+{
+	if (m_runWallSeconds <= 0.0)
+	{
+		return 0.0;
+	}
+
+	return GetSimulatedSeconds() / m_runWallSeconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BatchEpisodeRunner::PrintReport() const
+{
+	int numEpisodes = (int)m_episodes.size();
+	if (numEpisodes == 0)
+	{
+		return;
+	}
+
+	double minEpisodeSeconds = m_episodes[0].m_wallSeconds;
+	double maxEpisodeSeconds = m_episodes[0].m_wallSeconds;
+	double totalEpisodeSeconds = 0.0;
+	float totalDistance = 0.f;
+	for (int episodeIndex = 0; episodeIndex < numEpisodes; ++episodeIndex)
+	{
+		const BatchEpisode& episode = m_episodes[episodeIndex];
+		minEpisodeSeconds = episode.m_wallSeconds < minEpisodeSeconds ? episode.m_wallSeconds : minEpisodeSeconds;
+		maxEpisodeSeconds = episode.m_wallSeconds > maxEpisodeSeconds ? episode.m_wallSeconds : maxEpisodeSeconds;
+		totalEpisodeSeconds += episode.m_wallSeconds;
+		totalDistance += episode.m_distanceTravelled;
+	}
+
+	double simulatedSeconds = GetSimulatedSeconds();
+	double numSteps = simulatedSeconds / (double)m_settings.m_stepSeconds;
+
+	printf("\n >> Batch episodes : %i scenes x %i steps of %f s on %i episode threads and %i PhysX dispatcher threads, %i hardware threads",
+		numEpisodes, m_settings.m_numStepsPerEpisode, m_settings.m_stepSeconds, m_numThreadsUsed, m_settings.m_numDispatcherThreads, m_numHardwareThreads);
+	printf("\n >> Per scene : %i cloned actors and %i vehicles, %.2f ms to build every scene%s", m_numActorsPerEpisode, m_numVehiclesPerEpisode,
+		m_startUpSeconds * 1000.0, m_settings.m_runInWaves ? ", built and released in waves of one per thread" : "");
+	printf("\n >> Vehicle archetypes : %i models on %i wheel and chassis mesh sets shared by every scene", m_vehicleArchetypes.GetNumArchetypes(),
+		m_vehicleArchetypes.GetNumShapeMeshes());
+	printf("\n >> Wall time : %f s for %f simulated seconds (%.0f steps per second)", m_runWallSeconds, simulatedSeconds,
+		m_runWallSeconds > 0.0 ? numSteps / m_runWallSeconds : 0.0);
+	//Only comparable between runs with the same thread split, it is the whole machine's figure for the split printed above
+	printf("\n >> Throughput : %.2f simulated seconds per wall second with %i episode threads and %i dispatcher threads", GetSimulatedSecondsPerWallSecond(),
+		m_numThreadsUsed, m_settings.m_numDispatcherThreads);
+	printf("\n >> Episode wall time : min %.2f ms, mean %.2f ms, max %.2f ms", minEpisodeSeconds * 1000.0,
+		totalEpisodeSeconds * 1000.0 / (double)numEpisodes, maxEpisodeSeconds * 1000.0);
+	printf("\n >> Player car : %.1f m mean distance from the start pose\n", totalDistance / (float)numEpisodes);
+}
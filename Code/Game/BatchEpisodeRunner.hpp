@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Game Systems
+#include "Game/VehicleArchetype.hpp"
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <functional>
+#include <vector>
+
+using namespace physx;
+
+class CarController;
+class Game;
+class VehicleManager;
+class VehicleSpline;
+
+struct ScriptedVehicleInput;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct BatchEpisodeSettings
+{
+	//0 leaves the batch runner off
+	int									m_numEpisodes = 0;
+	int									m_numStepsPerEpisode = 3600;
+	float								m_stepSeconds = 1.f / 60.f;
+	//Threads that episodes are handed out to, 0 uses every hardware thread the dispatcher threads leave free
+	int									m_numThreads = 0;
+	//Worker threads of the one PxCpuDispatcher every episode scene shares. Episodes are the parallel unit, so the default of
+	//0 runs each scene's tasks on the thread stepping it and every core steps an episode of its own
+	int									m_numDispatcherThreads = 0;
+	//Off leaves the player car alone in every scene
+	bool								m_spawnTemplateAIVehicles = true;
+	//On builds, runs and releases one episode per thread at a time, so only that many scenes are ever alive. Off builds
+	//every scene in StartUp, which lets idle threads pick up any unstarted episode
+	bool								m_runInWaves = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One independent copy of the template scene, stepped start to finish by whichever thread picked it up
+//------------------------------------------------------------------------------------------------------------------------------
+struct BatchEpisode
+{
+	int									m_episodeIndex = 0;
+	PxScene*							m_scene = nullptr;
+	VehicleManager*						m_vehicleManager = nullptr;
+	CarController*						m_carController = nullptr;
+	int									m_playerVehicleIndex = -1;
+	//Static and dynamic actors cloned from the template, released with the episode
+	std::vector<PxActor*>				m_clonedActors;
+
+	//Episodes start at different points of the input script so they don't all drive the same line
+	float								m_scriptOffsetSeconds = 0.f;
+	PxVec3								m_startPosition = PxVec3(0.f, 0.f, 0.f);
+
+	int									m_numStepsTaken = 0;
+	double								m_wallSeconds = 0.0;
+	float								m_distanceTravelled = 0.f;
+};
+
+//Drives an episode's player car before each step. Returning false ends that episode early
+typedef std::function<bool(BatchEpisode& episode, int stepIndex)> BatchEpisodeStepFunction;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Runs many independent copies of a headless Game's scene as fast as the cores allow, for tuning and training throughput.
+// Every episode gets its own PxScene, obstacles and vehicles, cloned from the template Game's scene after SetupPhysX and
+// SetupVehicles. Episodes share the PxPhysics, the shapes and cooked meshes of the cloned obstacles, the tire friction
+// pairs, the vehicle archetypes and one CPU dispatcher. No App frame loop is involved, the runner steps the scenes itself
+//------------------------------------------------------------------------------------------------------------------------------
+class BatchEpisodeRunner
+{
+public:
+	explicit BatchEpisodeRunner(const BatchEpisodeSettings& settings);
+	~BatchEpisodeRunner();
+
+	//Without a step function every player car follows the input script
+	void								SetInputScript(const std::vector<ScriptedVehicleInput>& inputScript, float scriptLoopSeconds);
+	void								SetStepFunction(const BatchEpisodeStepFunction& stepFunction) { m_stepFunction = stepFunction; }
+	//One per episode, used for the player car in place of the template's handling
+	void								SetPlayerDescriptors(const std::vector<VehicleDescriptor>& descriptors) { m_playerDescriptors = &descriptors; }
+
+	//The template must not be stepped while the episodes exist, its scene is only read from. In waves it has to last until Run returns
+	void								StartUp(const Game& templateGame);
+	void								Run();
+	void								ShutDown();
+
+	void								PrintReport() const;
+
+	int									GetNumEpisodes() const { return (int)m_episodes.size(); }
+	const BatchEpisode&					GetEpisode(int episodeIndex) const { return m_episodes[episodeIndex]; }
+	double								GetSimulatedSeconds() const;
+	double								GetSimulatedSecondsPerWallSecond() const;
+
+private:
+	void								CreateEpisodes(int firstEpisodeIndex, int endEpisodeIndex);
+	void								CreateEpisode(const Game& templateGame, int episodeIndex);
+	void								CloneTemplateActors(const Game& templateGame, BatchEpisode& episode);
+	void								RunEpisode(BatchEpisode& episode);
+	void								ReleaseEpisode(BatchEpisode& episode);
+
+private:
+	BatchEpisodeSettings				m_settings;
+	std::vector<BatchEpisode>			m_episodes;
+
+	PxDefaultCpuDispatcher*				m_cpuDispatcher = nullptr;
+	//Every episode's cars of one model are instances of the same archetype
+	VehicleArchetypeRegistry			m_vehicleArchetypes;
+	int									m_numThreadsUsed = 0;
+	int									m_numHardwareThreads = 0;
+
+	const std::vector<ScriptedVehicleInput>*	m_inputScript = nullptr;
+	float								m_scriptLoopSeconds = 0.f;
+	BatchEpisodeStepFunction			m_stepFunction;
+	const std::vector<VehicleDescriptor>*	m_playerDescriptors = nullptr;
+
+	const Game*							m_templateGame = nullptr;
+	//The template's AI route, read only so every episode thread can share it. The template Game has to outlive the run
+	const VehicleSpline*				m_aiVehicleRoute = nullptr;
+	float								m_aiVehicleThrottle = 0.f;
+
+	int									m_numActorsPerEpisode = 0;
+	int									m_numVehiclesPerEpisode = 0;
+	//Scene building and stepping are timed apart, also when waves interleave them
+	double								m_startUpSeconds = 0.0;
+	double								m_runWallSeconds = 0.0;
+};
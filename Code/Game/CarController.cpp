@@ -1,31 +1,20 @@
 //------------------------------------------------------------------------------------------------------------------------------
 #include "Game/CarController.hpp"
 #include "Engine/Commons/EngineCommon.hpp"
-#include "Engine/Input/XboxController.hpp"
-#include "Engine/Input/InputSystem.hpp"
-//PhysX
-#include "ThirdParty/PhysX/include/vehicle/PxVehicleUtil.h"
-
-//------------------------------------------------------------------------------------------------------------------------------
-// GLOBAL DATA
-//------------------------------------------------------------------------------------------------------------------------------
-float gSteerVsForwardSpeedData[2 * 8] =
-{
-	//SteerAmount	to	Forward Speed
-	0.0f,		0.75f,
-	5.0f,		0.75f,
-	30.0f,		0.125f,
-	120.0f,		0.1f,
-};
+#include "Game/VehicleManager.hpp"
 
 //------------------------------------------------------------------------------------------------------------------------------
 CarController::CarController()
 {
 	SetupVehicle();
 	m_vehicleInputData = new PxVehicleDrive4WRawInputData();
+}
 
-	//Setup the steer to speed table
-	m_SteerVsForwardSpeedTable = PxFixedSizeLookupTable<8>(gSteerVsForwardSpeedData, 4);
+//------------------------------------------------------------------------------------------------------------------------------
+CarController::CarController(PxVehicleDrive4W& vehicle, PxVehicleDrive4WRawInputData& inputData)
+	: m_vehicle4W(&vehicle)
+	, m_vehicleInputData(&inputData)
+{
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -44,119 +33,29 @@ void CarController::SetupVehicle()
 void CarController::SetDigitalControlMode(bool digitalControlEnabled)
 {
 	m_digitalControlEnabled = digitalControlEnabled;
-}
 
-//------------------------------------------------------------------------------------------------------------------------------
-bool CarController::IsDigitalInputEnabled() const
-{
-	return m_digitalControlEnabled;
+	if (m_vehicleManager != nullptr)
+	{
+		m_vehicleManager->SetDigitalInput(m_vehicleIndex, m_digitalControlEnabled);
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarController::Update(float deltaTime)
+void CarController::RegisterWithVehicleManager(VehicleManager& vehicleManager, const VehicleDescriptor& descriptor)
 {
-	VehiclePhysicsUpdate(deltaTime);
+	m_vehicleManager = &vehicleManager;
+	m_vehicleIndex = m_vehicleManager->AddVehicle(*m_vehicle4W, *m_vehicleInputData, descriptor);
+	m_vehicleManager->SetDigitalInput(m_vehicleIndex, m_digitalControlEnabled);
 
-	UpdateInputs();
+	//The car the player is looking at always gets the most accurate suspension and is never simplified
+	m_vehicleManager->SetQueryQualityOverride(m_vehicleIndex, VEHICLE_QUERY_SWEEP);
+	m_vehicleManager->SetSimLODOverride(m_vehicleIndex, VEHICLE_LOD_FULL);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarController::UpdateInputs()
-{
-	//First reset all the input on the car
-	ReleaseAllControls();
-
-	//Get Xbox controller data
-	XboxController playerController = g_inputSystem->GetXboxController(0);
-	AnalogJoyStick leftStick = playerController.GetLeftJoystick();
-	AnalogJoyStick rightStick = playerController.GetRightJoystick();
-
-	float rightTrigger = playerController.GetRightTrigger();
-	float leftTrigger = playerController.GetLeftTrigger();
-
-	if (leftStick.GetAngleDegrees() != 0.f)
-	{
-		Vec2 stickPosition = leftStick.GetPosition();
-		if (stickPosition.x > 0.f)
-		{
-			Steer(leftStick.GetMagnitude());
-		}
-		else
-		{
-			Steer(leftStick.GetMagnitude() * -1.f);
-		}
-	}
-
-	//Check acceleration forward/reverse
-	if (rightTrigger > 0.1f)
-	{
-		AccelerateForward(rightTrigger);
-	}
-	else
-	{
-		if (leftTrigger > 0.1f)
-		{
-			AccelerateReverse(leftTrigger);
-		}
-	}
-
-	//Check brake button
-	KeyButtonState buttonAState = playerController.GetButtonState(XBOX_BUTTON_ID_A);
-	if (buttonAState.IsPressed())
-	{
-		Brake();
-	}
-
-	//Check hand brake button
-	KeyButtonState buttonBState = playerController.GetButtonState(XBOX_BUTTON_ID_B);
-	if (buttonBState.IsPressed())
-	{
-		Handbrake();
-	}
-
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void CarController::VehiclePhysicsUpdate(float deltaTime)
+bool CarController::IsDigitalInputEnabled() const
 {
-	VehicleSceneQueryData* vehicleSceneQueryData = g_PxPhysXSystem->GetVehicleSceneQueryData();
-	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
-	PxBatchQuery* batchQuery = g_PxPhysXSystem->GetPhysXBatchQuery();
-	PxVehicleDrivableSurfaceToTireFrictionPairs* tireFrictionPairs = g_PxPhysXSystem->GetVehicleTireFrictionPairs();
-
-	PxVehicleDrive4W* vehicle4W = GetVehicle();
-	PxVehicleDrive4WRawInputData* vehicleInputData = GetVehicleInputData();
-
-	if (vehicle4W == nullptr)
-	{
-		return;
-	}
-
-	//Update the control inputs for the vehicle.
-	if (IsDigitalInputEnabled())
-	{
-		PxVehicleDrive4WSmoothDigitalRawInputsAndSetAnalogInputs(m_keySmoothingData, m_SteerVsForwardSpeedTable, *vehicleInputData, deltaTime, m_isVehicleInAir, *vehicle4W);
-	}
-	else
-	{
-		PxVehicleDrive4WSmoothAnalogRawInputsAndSetAnalogInputs(m_padSmoothingData, m_SteerVsForwardSpeedTable, *vehicleInputData, deltaTime, m_isVehicleInAir, *vehicle4W);
-	}
-
-	//Raycasts.
-	PxVehicleWheels* vehicleWheels[6] = { vehicle4W };
-	PxRaycastQueryResult* raycastResults = vehicleSceneQueryData->getRaycastQueryResultBuffer(0);
-	const PxU32 raycastResultsSize = vehicleSceneQueryData->getQueryResultBufferSize();
-	PxVehicleSuspensionRaycasts(batchQuery, 1, vehicleWheels, raycastResultsSize, raycastResults);
-
-	//Vehicle update.
-	const PxVec3 grav = scene->getGravity();
-	PxWheelQueryResult wheelQueryResults[PX_MAX_NB_WHEELS];
-	PxVehicleWheelQueryResult vehicleQueryResults[1] = { {wheelQueryResults, vehicle4W->mWheelsSimData.getNbWheels()} };
-	int numVehicles = 1;
-	PxVehicleUpdates(deltaTime, grav, *tireFrictionPairs, numVehicles, vehicleWheels, vehicleQueryResults);
-
-	//Work out if the vehicle is in the air.
-	m_isVehicleInAir = vehicle4W->getRigidDynamicActor()->isSleeping() ? false : PxVehicleIsInAir(vehicleQueryResults[0]);
+	return m_digitalControlEnabled;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -197,7 +96,7 @@ void CarController::AccelerateForward(float analogAcc)
 	//If I am going reverse, change to first gear
 	if (m_vehicle4W->mDriveDynData.getCurrentGear() == PxVehicleGearsData::eREVERSE)
 	{
-		m_vehicle4W->mDriveDynData.forceGearChange(PxVehicleGearsData::eFIRST);
+		ForceGear(PxVehicleGearsData::eFIRST);
 	}
 
 	if (m_digitalControlEnabled)
@@ -214,7 +113,7 @@ void CarController::AccelerateForward(float analogAcc)
 void CarController::AccelerateReverse(float analogAcc /*= 0.f*/)
 {
 	//Force gear change to reverse
-	m_vehicle4W->mDriveDynData.forceGearChange(PxVehicleGearsData::eREVERSE);
+	ForceGear(PxVehicleGearsData::eREVERSE);
 
 	if (m_digitalControlEnabled)
 	{
@@ -265,9 +164,23 @@ void CarController::Handbrake()
 	}
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void CarController::ForceGear(int gear)
+{
+	if (gear < 0)
+	{
+		return;
+	}
+
+	m_vehicle4W->mDriveDynData.forceGearChange((PxU32)gear);
+	m_forcedGearThisStep = gear;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void CarController::ReleaseAllControls()
 {
+	m_forcedGearThisStep = -1;
+
 	if (m_digitalControlEnabled)
 	{
 		m_vehicleInputData->setDigitalAccel(false);
@@ -1,10 +1,15 @@
 #pragma once
 #include "Engine/PhysXSystem/PhysXSystem.hpp"
 
+struct VehicleDescriptor;
+class VehicleManager;
+
 class CarController
 {
 public:
 	CarController();
+	//Drives a vehicle someone else created, like a VehicleManager spawn in a batch episode scene
+	CarController(PxVehicleDrive4W& vehicle, PxVehicleDrive4WRawInputData& inputData);
 	~CarController();
 
 	void	SetupVehicle();
@@ -12,9 +17,14 @@ public:
 
 	bool	IsDigitalInputEnabled() const;
 
-	void	Update(float deltaTime);
+	void	RegisterWithVehicleManager(VehicleManager& vehicleManager, const VehicleDescriptor& descriptor);
+	int		GetVehicleManagerIndex() const { return m_vehicleIndex; }
+
+	//Polls the Xbox controller, lives in CarControllerInput.cpp which only the windowed build compiles
 	void	UpdateInputs();
-	void	VehiclePhysicsUpdate(float deltaTime);
+	//Gear the last UpdateInputs forced on the drive data, -1 if none. Kept with recorded input
+	int		GetForcedGearThisStep() const { return m_forcedGearThisStep; }
+	void	ForceGear(int gear);
 
 	//Vehicle Getters
 	PxVehicleDrive4W* GetVehicle() const;
@@ -37,46 +47,12 @@ private:
 
 private:
 	bool		m_digitalControlEnabled = false;
-	bool		m_isVehicleInAir = false;
+	int			m_forcedGearThisStep = -1;
+
+	//The player car is stepped with every other vehicle by the manager
+	VehicleManager*						m_vehicleManager = nullptr;
+	int									m_vehicleIndex = -1;
 
 	PxVehicleDrive4W*					m_vehicle4W = nullptr;
 	PxVehicleDrive4WRawInputData*		m_vehicleInputData = nullptr;
-
-public:
-	PxFixedSizeLookupTable<8>			m_SteerVsForwardSpeedTable;
-	PxVehicleKeySmoothingData			m_keySmoothingData =
-	{
-		{
-			6.0f,	//rise rate eANALOG_INPUT_ACCEL
-			6.0f,	//rise rate eANALOG_INPUT_BRAKE		
-			6.0f,	//rise rate eANALOG_INPUT_HANDBRAKE	
-			2.5f,	//rise rate eANALOG_INPUT_STEER_LEFT
-			2.5f,	//rise rate eANALOG_INPUT_STEER_RIGHT
-		},
-		{
-			10.0f,	//fall rate eANALOG_INPUT_ACCEL
-			10.0f,	//fall rate eANALOG_INPUT_BRAKE		
-			10.0f,	//fall rate eANALOG_INPUT_HANDBRAKE	
-			5.0f,	//fall rate eANALOG_INPUT_STEER_LEFT
-			5.0f	//fall rate eANALOG_INPUT_STEER_RIGHT
-		}
-	};
-
-	PxVehiclePadSmoothingData			m_padSmoothingData =
-	{
-		{
-			6.0f,	//rise rate eANALOG_INPUT_ACCEL
-			6.0f,	//rise rate eANALOG_INPUT_BRAKE		
-			6.0f,	//rise rate eANALOG_INPUT_HANDBRAKE	
-			2.5f,	//rise rate eANALOG_INPUT_STEER_LEFT
-			2.5f,	//rise rate eANALOG_INPUT_STEER_RIGHT
-		},
-		{
-			10.0f,	//fall rate eANALOG_INPUT_ACCEL
-			10.0f,	//fall rate eANALOG_INPUT_BRAKE		
-			10.0f,	//fall rate eANALOG_INPUT_HANDBRAKE	
-			5.0f,	//fall rate eANALOG_INPUT_STEER_LEFT
-			5.0f	//fall rate eANALOG_INPUT_STEER_RIGHT
-		}
-	};
 };
\ No newline at end of file
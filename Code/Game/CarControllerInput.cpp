@@ -0,0 +1,64 @@
+//------------------------------------------------------------------------------------------------------------------------------
+// Controller polling for the windowed build. Kept out of CarController.cpp so the headless build doesn't need the InputSystem
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/CarController.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Input/XboxController.hpp"
+#include "Engine/Input/InputSystem.hpp"
+#include "Game/GameCommon.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarController::UpdateInputs()
+{
+	//First reset all the input on the car
+	ReleaseAllControls();
+
+	//Get Xbox controller data
+	XboxController playerController = g_inputSystem->GetXboxController(0);
+	AnalogJoyStick leftStick = playerController.GetLeftJoystick();
+	AnalogJoyStick rightStick = playerController.GetRightJoystick();
+
+	float rightTrigger = playerController.GetRightTrigger();
+	float leftTrigger = playerController.GetLeftTrigger();
+
+	if (leftStick.GetAngleDegrees() != 0.f)
+	{
+		Vec2 stickPosition = leftStick.GetPosition();
+		if (stickPosition.x > 0.f)
+		{
+			Steer(leftStick.GetMagnitude());
+		}
+		else
+		{
+			Steer(leftStick.GetMagnitude() * -1.f);
+		}
+	}
+
+	//Check acceleration forward/reverse
+	if (rightTrigger > 0.1f)
+	{
+		AccelerateForward(rightTrigger);
+	}
+	else
+	{
+		if (leftTrigger > 0.1f)
+		{
+			AccelerateReverse(leftTrigger);
+		}
+	}
+
+	//Check brake button
+	KeyButtonState buttonAState = playerController.GetButtonState(XBOX_BUTTON_ID_A);
+	if (buttonAState.IsPressed())
+	{
+		Brake();
+	}
+
+	//Check hand brake button
+	KeyButtonState buttonBState = playerController.GetButtonState(XBOX_BUTTON_ID_B);
+	if (buttonBState.IsPressed())
+	{
+		Handbrake();
+	}
+
+}
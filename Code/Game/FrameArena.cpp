@@ -0,0 +1,65 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/FrameArena.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Standard
+#include <cstddef>
+#include <new>
+
+FrameArena* g_frameArena = nullptr;
+
+//Overflow blocks come from operator new, which only guarantees this much
+const size_t gMaxOverflowAlignment = alignof(std::max_align_t);
+
+//------------------------------------------------------------------------------------------------------------------------------
+FrameArena::FrameArena(size_t capacityBytes)
+	: m_capacityBytes(capacityBytes)
+{
+	m_block = static_cast<char*>(::operator new(m_capacityBytes));
+
+	//Keeps overflow bookkeeping itself from allocating unless a frame overflows badly
+	m_overflowBlocks.reserve(16);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+FrameArena::~FrameArena()
+{
+	Reset();
+
+	::operator delete(m_block);
+	m_block = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* FrameArena::Allocate(size_t numBytes, size_t alignment)
+{
+	size_t alignedOffset = (m_usedBytes + alignment - 1) & ~(alignment - 1);
+	if (alignedOffset + numBytes <= m_capacityBytes)
+	{
+		m_usedBytes = alignedOffset + numBytes;
+		m_highWaterBytes = m_usedBytes > m_highWaterBytes ? m_usedBytes : m_highWaterBytes;
+		return m_block + alignedOffset;
+	}
+
+	if (alignment > gMaxOverflowAlignment)
+	{
+		ERROR_AND_DIE("Frame arena overflow can't satisfy the requested alignment");
+	}
+
+	m_numOverflows++;
+	void* overflowBlock = ::operator new(numBytes);
+	m_overflowBlocks.push_back(overflowBlock);
+	return overflowBlock;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameArena::Reset()
+{
+	for (int blockIndex = 0; blockIndex < (int)m_overflowBlocks.size(); ++blockIndex)
+	{
+		::operator delete(m_overflowBlocks[blockIndex]);
+	}
+	m_overflowBlocks.clear();
+
+	m_usedBytes = 0;
+}
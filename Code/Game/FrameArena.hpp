@@ -0,0 +1,40 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Standard
+#include <stddef.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Bump allocator for scratch memory that only lives until the end of the frame. The App resets it in EndFrame (the
+// headless app after every step), so nothing handed out here may be kept across frames. Memory is not constructed or
+// destructed, only plain data belongs here. Main thread only.
+// Running past the capacity falls back to the heap, which the allocation test mode then reports like any other allocation
+//------------------------------------------------------------------------------------------------------------------------------
+class FrameArena
+{
+public:
+	explicit FrameArena(size_t capacityBytes);
+	~FrameArena();
+
+	void*								Allocate(size_t numBytes, size_t alignment = 16);
+	template <typename T>
+	T*									AllocateArray(int count) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+	void								Reset();
+
+	size_t								GetCapacityBytes() const { return m_capacityBytes; }
+	size_t								GetUsedBytes() const { return m_usedBytes; }
+	size_t								GetHighWaterBytes() const { return m_highWaterBytes; }
+	int									GetNumOverflows() const { return m_numOverflows; }
+
+private:
+	char*								m_block = nullptr;
+	size_t								m_capacityBytes = 0;
+	size_t								m_usedBytes = 0;
+	size_t								m_highWaterBytes = 0;
+
+	std::vector<void*>					m_overflowBlocks;
+	int									m_numOverflows = 0;
+};
+
+extern FrameArena* g_frameArena;
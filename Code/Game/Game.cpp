@@ -5,6 +5,7 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/EventSystems.hpp"
 #include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/NamedStrings.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Core/WindowContext.hpp"
@@ -12,7 +13,6 @@
 #include "Engine/Math/AABB3.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/Matrix44.hpp"
-#include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Math/Vertex_Lit.hpp"
 #include "Engine/PhysXSystem/PhysXSystem.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
@@ -21,12 +21,21 @@
 #include "Engine/Renderer/CPUMesh.hpp"
 #include "Engine/Renderer/DebugRender.hpp"
 #include "Engine/Renderer/GPUMesh.hpp"
+#include "Engine/Renderer/IsoSpriteDefenition.hpp"
+#include "Engine/Renderer/Material.hpp"
 #include "Engine/Renderer/Model.hpp"
 #include "Engine/Renderer/RenderContext.hpp"
 #include "Engine/Renderer/SpriteSheet.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Renderer/TextureView.hpp"
-#include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
+//Game Systems
+#include "Game/AllocationCounter.hpp"
+#include "Game/CarCamera.hpp"
+#include "Game/FrameArena.hpp"
+#include "Game/Profiler.hpp"
+//Standard
+#include <math.h>
+#include <stdio.h>
 //PhysX Includes
 //#include "ThirdParty/PhysX/include/PxPhysicsAPI.h"
 
@@ -37,28 +46,36 @@ extern RenderContext* g_renderContext;
 extern AudioSystem* g_audio;
 bool g_debugMode = false;
 
+//Defaults for the ProfileCapture command and the ImGui capture button
+const int gDefaultProfileCaptureFrames = 120;
+const char* gDefaultProfileTracePath = "Profile.json";
+
+//------------------------------------------------------------------------------------------------------------------------------
+// ImGui::PlotLines reads the ring buffer through this, a counter of -1 plots the frame time
 //------------------------------------------------------------------------------------------------------------------------------
-Game::Game()
+struct PhysXStatsPlotData
 {
-	m_isGameAlive = true;
-	m_testAudioID = g_audio->CreateOrGetSound("Data/Audio/UproarLilWayne.mp3");
-
-	m_squirrelFont = g_renderContext->CreateOrGetBitmapFontFromFile("SquirrelFixedFont");
-
-	g_devConsole->SetBitmapFont(*m_squirrelFont);
-	g_debugRenderer->SetDebugFont(m_squirrelFont);
-}
+	const PhysXStatsRecorder*			m_recorder = nullptr;
+	int									m_counter = -1;
+};
 
-//------------------------------------------------------------------------------------------------------------------------------
-Game::~Game()
+static float GetPhysXStatsPlotValue(void* data, int sampleIndex)
 {
-	m_isGameAlive = false;
-	Shutdown();
+	const PhysXStatsPlotData* plotData = static_cast<const PhysXStatsPlotData*>(data);
+	const PhysXStatsSample& sample = plotData->m_recorder->GetSample(sampleIndex);
+	return plotData->m_counter < 0 ? sample.m_frameMs : (float)sample.m_counters[plotData->m_counter];
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::StartUp()
 {
+	m_testAudioID = g_audio->CreateOrGetSound("Data/Audio/UproarLilWayne.mp3");
+
+	m_squirrelFont = g_renderContext->CreateOrGetBitmapFontFromFile("SquirrelFixedFont");
+
+	g_devConsole->SetBitmapFont(*m_squirrelFont);
+	g_debugRenderer->SetDebugFont(m_squirrelFont);
+
 	SetupMouseData();
 	SetupCameras();
 
@@ -79,6 +96,8 @@ void Game::StartUp()
 	g_eventSystem->SubscribeEventCallBackFn("ToggleLight3", ToggleLight3);
 	g_eventSystem->SubscribeEventCallBackFn("ToggleLight4", ToggleLight4);
 	g_eventSystem->SubscribeEventCallBackFn("ToggleAllPointLights", ToggleAllPointLights);
+	g_eventSystem->SubscribeEventCallBackFn("PhysXMemory", PrintPhysXMemory);
+	g_eventSystem->SubscribeEventCallBackFn("ProfileCapture", StartProfileCapture);
 
 	CreateInitialMeshes();
 
@@ -88,8 +107,32 @@ void Game::StartUp()
 	DebugRenderOptionsT options;
 	options.space = DEBUG_RENDER_SCREEN;
 
+	m_numAIVehicles = g_gameConfigBlackboard.GetValue("numAIVehicles", m_numAIVehicles);
+	m_vehicleUpdateThreads = g_gameConfigBlackboard.GetValue("vehicleUpdateThreads", m_vehicleUpdateThreads);
+	m_vehiclesPerChunk = g_gameConfigBlackboard.GetValue("vehiclesPerChunk", m_vehiclesPerChunk);
+	m_vehicleRaycastDistance = g_gameConfigBlackboard.GetValue("vehicleRaycastDistance", m_vehicleRaycastDistance);
+	m_vehicleCachedQuerySteps = g_gameConfigBlackboard.GetValue("vehicleCachedQuerySteps", m_vehicleCachedQuerySteps);
+	m_vehicleKinematicDistance = g_gameConfigBlackboard.GetValue("vehicleKinematicDistance", m_vehicleKinematicDistance);
+	m_vehicleLODHysteresis = g_gameConfigBlackboard.GetValue("vehicleLODHysteresis", m_vehicleLODHysteresis);
+	m_vehicleReducedQuerySteps = g_gameConfigBlackboard.GetValue("vehicleReducedQuerySteps", m_vehicleReducedQuerySteps);
+	m_vehicleMaxFullLOD = g_gameConfigBlackboard.GetValue("vehicleMaxFullLOD", m_vehicleMaxFullLOD);
+	m_vehicleMaxReducedLOD = g_gameConfigBlackboard.GetValue("vehicleMaxReducedLOD", m_vehicleMaxReducedLOD);
+	m_aiVehicleRoutePoints = g_gameConfigBlackboard.GetValue("aiVehicleRoute", m_aiVehicleRoutePoints);
+	m_useSceneSnapshot = g_gameConfigBlackboard.GetValue("useSceneSnapshot", m_useSceneSnapshot);
+	m_numBulkObstacles = g_gameConfigBlackboard.GetValue("numBulkObstacles", m_numBulkObstacles);
+	m_projectilePoolSize = g_gameConfigBlackboard.GetValue("projectilePoolSize", m_projectilePoolSize);
+	m_projectileLifetime = g_gameConfigBlackboard.GetValue("projectileLifetime", m_projectileLifetime);
+	m_vehicleDescriptorPath = g_gameConfigBlackboard.GetValue("vehicleDescriptor", m_vehicleDescriptorPath);
+
+	m_physXProfilerBridge.Install();
+
 	m_carController = new CarController();
 	SetupPhysX();	
+	SetupVehicles();
+	CaptureInitialPoses();
+	SetupProjectilePool();
+	m_renderProxies.StartUp(*g_PxPhysXSystem->GetPhysXScene());
+	PrintQueuedConsoleReports();
 
 	Vec3 camEuler = Vec3(-12.5f, -196.f, 0.f);
 	m_mainCamera->SetEuler(camEuler);
@@ -305,338 +348,6 @@ void Game::SetStartupDebugRenderObjects()
 	g_debugRenderer->DebugAddToLog(options, debugText2, Rgba::GREEN, 20.f);
 }
 
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::SetupPhysX()
-{
-	/*
-	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
-	PxScene* pxScene = g_PxPhysXSystem->GetPhysXScene();
-
-	PxMaterial* pxMat;
-	pxMat = g_PxPhysXSystem->GetDefaultPxMaterial();
-
-	//Add things to your scene
-	PxRigidStatic* groundPlane = PxCreatePlane(*physX, PxPlane(0, 1, 0, 0), *pxMat);
-	pxScene->addActor(*groundPlane);
-
-	for (int setIndex = 0; setIndex < 5; setIndex++)
-	{
-		CreatePhysXStack(Vec3(0, 0, m_anotherTestTempHackStackZ -= 10.f), 10, 2.f);
-	}
-
-	CreatePhysXConvexHull();
-	CreatePhysXChains(m_chainPosition, m_chainLength, PxBoxGeometry(2.0f, 0.5f, 0.5f), m_chainSeperation);
-	CreatePhysXArticulationChain();
-	*/
-
-	//Vehicle SDK only
-	CreatePhysXVehicleObstacles();
-	CreatePhysXVehicleRamp();
-	CreatePhysXVehicleBoxWall();
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::CreatePhysXVehicleBoxWall()
-{
-	//Add a wall made of dynamic objects with cuboid shapes for bricks.
-	PxTransform t(PxVec3(-20.f, 0.f, 0.f), PxQuat(-0.000002f, -0.837118f, -0.000004f, 0.547022f));
-	CreateObstacleWall(12, 4, 1.0f, t.p, t.q);
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::CreateObstacleWall(const int numHorizontalBoxes, const int numVerticalBoxes, const float boxSize, const PxVec3& pos, const PxQuat& quat)
-{
-	const PxF32 density = 50.0f;
-
-	const PxF32 sizeX = boxSize;
-	const PxF32 sizeY = boxSize;
-	const PxF32 sizeZ = boxSize;
-
-	const PxF32 mass = sizeX * sizeY*sizeZ*density;
-	const PxVec3 halfExtents(sizeX*0.5f, sizeY*0.5f, sizeZ*0.5f);
-	PxBoxGeometry geometry(halfExtents);
-	PxTransform shapeTransforms[1] = { PxTransform(PxIdentity) };
-	PxGeometry* shapeGeometries[1] = { &geometry };
-	PxMaterial* shapeMaterials[1] = { g_PxPhysXSystem->GetDefaultPxMaterial() };
-
-	const PxF32 spacing = 0.0001f;
-	PxVec3 relPos(0.0f, sizeY / 2, 0.0f);
-	PxF32 offsetX = -(numHorizontalBoxes * (sizeX + spacing) * 0.5f);
-	PxF32 offsetZ = 0.0f;
-
-	for (PxU32 k = 0; k < (PxU32)numVerticalBoxes; k++)
-	{
-		for (PxU32 i = 0; i < (PxU32)numHorizontalBoxes; i++)
-		{
-			relPos.x = offsetX + (sizeX + spacing)*i;
-			relPos.z = offsetZ;
-			PxTransform transform(pos + quat.rotate(relPos), quat);
-			g_PxPhysXSystem->AddDynamicObstacle(transform, mass, 1, shapeTransforms, shapeGeometries, shapeMaterials);
-		}
-
-		if (0 == (k % 2))
-		{
-			offsetX += sizeX / 2;
-		}
-		else
-		{
-			offsetX -= sizeX / 2;
-		}
-		relPos.y += (sizeY + spacing);
-	}
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::CreatePhysXVehicleRamp()
-{
-	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
-	PxCooking* pxCooking = g_PxPhysXSystem->GetPhysXCookingModule();
-	PxMaterial* pxMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
-
-	//Add a really big ramp to jump over the car stack.
-	{
-		PxVec3 halfExtentsRamp(5.0f, 1.9f, 7.0f);
-		PxConvexMeshGeometry geomRamp(g_PxPhysXSystem->CreateWedgeConvexMesh(halfExtentsRamp, *physX, *pxCooking));
-		PxTransform shapeTransforms[1] = { PxTransform(PxIdentity) };
-		PxMaterial* shapeMaterials[1] = { pxMaterial };
-		PxGeometry* shapeGeometries[1] = { &geomRamp };
-
-		Matrix44 bigRampModel;
-		bigRampModel.MakeTranslation3D(Vec3(-10.f, 0.f, 0.f));
-		Matrix44 rotation = Matrix44::MakeYRotationDegrees(180.f);
-		bigRampModel = bigRampModel.AppendMatrix(rotation);
-
-		PxTransform tRamp(g_PxPhysXSystem->VecToPxVector(bigRampModel.GetTBasis()), g_PxPhysXSystem->MakeQuaternionFromMatrix(bigRampModel) );
-		g_PxPhysXSystem->AddStaticObstacle(tRamp, 1, shapeTransforms, shapeGeometries, shapeMaterials);
-	}
-
-	//Add two ramps side by side with a gap in between
-	{
-		PxVec3 halfExtents(3.0f, 1.5f, 3.5f);
-		PxConvexMeshGeometry geometry(g_PxPhysXSystem->CreateWedgeConvexMesh(halfExtents, *physX, *pxCooking));
-		PxTransform shapeTransforms[1] = { PxTransform(PxIdentity) };
-		PxMaterial* shapeMaterials[1] = { pxMaterial };
-		PxGeometry* shapeGeometries[1] = { &geometry };
-		PxTransform t1(PxVec3(-60.f, 0.f, 0.f), PxQuat(0.000013f, -0.406322f, 0.000006f, 0.913730f));
-		g_PxPhysXSystem->AddStaticObstacle(t1, 1, shapeTransforms, shapeGeometries, shapeMaterials);
-		PxTransform t2(PxVec3(-80, 0.f, 0.f), PxQuat(0.000013f, -0.406322f, 0.000006f, 0.913730f));
-		g_PxPhysXSystem->AddStaticObstacle(t2, 1, shapeTransforms, shapeGeometries, shapeMaterials);
-	}
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::CreatePhysXVehicleObstacles()
-{
-	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
-	PxScene* pxScene = g_PxPhysXSystem->GetPhysXScene();
-
-	PxMaterial* pxMat;
-	pxMat = g_PxPhysXSystem->GetDefaultPxMaterial();
-
-	const float boxHalfHeight = 1.0f;
-	const float boxZ = 30.0f;
-	PxTransform t(PxVec3(0.f, boxHalfHeight, boxZ), PxQuat(PxIdentity));
-	PxRigidStatic* rs = physX->createRigidStatic(t);
-
-	PxBoxGeometry boxGeom(PxVec3(3.0f, boxHalfHeight, 3.0f));
-	PxShape* shape = PxRigidActorExt::createExclusiveShape(*rs, boxGeom, *pxMat);
-
-	PxFilterData simFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_WHEEL, PxPairFlag::eMODIFY_CONTACTS | PxPairFlag::eDETECT_CCD_CONTACT, 0);
-	shape->setSimulationFilterData(simFilterData);
-	PxFilterData qryFilterData;
-	setupDrivableSurface(qryFilterData);
-	shape->setQueryFilterData(qryFilterData);
-
-	pxScene->addActor(*rs);
-
-	for (PxU32 i = 0; i < 64; i++)
-	{
-		t = PxTransform(PxVec3(20.f + i * 0.01f, 2.0f + i * 0.25f, 20.0f + i * 0.025f), PxQuat(PxPi*0.5f, PxVec3(0, 1, 0)));
-		PxRigidDynamic* rd = physX->createRigidDynamic(t);
-
-		boxGeom = PxBoxGeometry(PxVec3(0.08f, 0.25f, 1.0f));
-		shape = PxRigidActorExt::createExclusiveShape(*rd, boxGeom, *pxMat);
-
-		simFilterData = PxFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_OBSTACLE_AGAINST, PxPairFlag::eMODIFY_CONTACTS | PxPairFlag::eDETECT_CCD_CONTACT, 0);
-		shape->setSimulationFilterData(simFilterData);
-		setupDrivableSurface(qryFilterData);
-		shape->setQueryFilterData(qryFilterData);
-
-		PxRigidBodyExt::updateMassAndInertia(*rd, 30.0f);
-
-		pxScene->addActor(*rd);
-	}
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::CreatePhysXArticulationChain()
-{
-	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
-	PxMaterial* material = g_PxPhysXSystem->GetDefaultPxMaterial();
-	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
-	PxArticulation* articulation = physX->createArticulation();
-
-	// Stabilization can create artifacts on jointed objects so we just disable it
-	articulation->setStabilizationThreshold(0.0f);
-
-	articulation->setMaxProjectionIterations(16);
-	articulation->setSeparationTolerance(0.001f);
-
-	const float radius = 0.5f * m_articulationScale;
-	const float halfHeight = 1.0f * m_articulationScale;
-
-	const PxVec3 initPos(50.0f, 24.0f, 0.0f);
-	PxVec3 pos = initPos;
-	PxShape* capsuleShape = physX->createShape(PxCapsuleGeometry(radius, halfHeight), *material);
-	PxArticulationLink* firstLink = nullptr;
-	PxArticulationLink* parent = nullptr;
-
-	const bool overlappingLinks = true;	// Change this for another kind of rope
-
-	articulation->setSolverIterationCounts(16);
-
-	// Create rope
-	for (int linkIndex = 0; linkIndex < m_numCapsules; linkIndex++)
-	{
-		PxArticulationLink* link = articulation->createLink(parent, PxTransform(pos));
-		if (!firstLink)
-			firstLink = link;
-
-		link->attachShape(*capsuleShape);
-		PxRigidBodyExt::setMassAndUpdateInertia(*link, m_capsuleMass);
-
-		link->setLinearDamping(m_linkLinearDamping);
-		link->setAngularDamping(m_linkAngularDamping);
-
-		link->setMaxAngularVelocity(m_linkMaxAngularVelocity);
-		link->setMaxLinearVelocity(m_linkMaxLinearVelocity);
-
-		PxArticulationJointBase* joint = link->getInboundJoint();
-
-		if (joint)	// Will be null for root link
-		{
-			if (overlappingLinks)
-			{
-				joint->setParentPose(PxTransform(PxVec3(halfHeight, 0.0f, 0.0f)));
-				joint->setChildPose(PxTransform(PxVec3(-halfHeight, 0.0f, 0.0f)));
-			}
-			else
-			{
-				joint->setParentPose(PxTransform(PxVec3(radius + halfHeight, 0.0f, 0.0f)));
-				joint->setChildPose(PxTransform(PxVec3(-radius - halfHeight, 0.0f, 0.0f)));
-			}
-		}
-
-		if (overlappingLinks)
-			pos.x += (radius + halfHeight * 2.0f);
-		else
-			pos.x += (radius + halfHeight) * 2.0f;
-		parent = link;
-	}
-
-	//Attach large & heavy box at the end of the rope
-	{
-		PxShape* boxShape = physX->createShape(PxBoxGeometry(m_weightSize, m_weightSize, m_weightSize), *material);
-
-		pos.x -= (radius + halfHeight) * 2.0f;
-		pos.x += (radius + halfHeight) + m_weightSize;
-
-		PxArticulationLink* link = articulation->createLink(parent, PxTransform(pos));
-
-		link->setLinearDamping(m_linkLinearDamping);
-		link->setAngularDamping(m_linkAngularDamping);
-		link->setMaxAngularVelocity(m_linkMaxAngularVelocity);
-		link->setMaxLinearVelocity(m_linkMaxLinearVelocity);
-
-		link->attachShape(*boxShape);
-		PxRigidBodyExt::setMassAndUpdateInertia(*link, m_weightMass);
-
-		PxArticulationJointBase* joint = link->getInboundJoint();
-
-		if (joint)	// Will be null for root link
-		{
-			joint->setParentPose(PxTransform(PxVec3(radius + halfHeight, 0.0f, 0.0f)));
-			joint->setChildPose(PxTransform(PxVec3(-m_weightSize, 0.0f, 0.0f)));
-		}
-	}
-	scene->addArticulation(*articulation);
-
-
-	// Attach articulation to static world
-	PxShape* anchorShape = physX->createShape(PxSphereGeometry(0.05f), *material);
-	PxRigidStatic* anchor = PxCreateStatic(*physX, PxTransform(initPos), *anchorShape);
-	scene->addActor(*anchor);
-	PxSphericalJoint* sphericalJoint = PxSphericalJointCreate(*physX, anchor, PxTransform(PxVec3(0.0f)), firstLink, PxTransform(PxVec3(0.0f)));
-	PX_UNUSED(sphericalJoint);
-
-	// Create obstacle
-	PxShape* boxShape = physX->createShape(PxBoxGeometry(1.0f, 0.1f, 2.0f), *material);
-	PxRigidStatic* obstacle = PxCreateStatic(*physX, PxTransform(initPos + PxVec3(10.0f, -3.0f, 0.0f)), *boxShape);
-	scene->addActor(*obstacle);
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::CreatePhysXChains(const Vec3& position, int length, const PxGeometry& geometry, float separation)
-{
-	Vec3 offsetZ = Vec3(0.f, 0.f, 20.f);
-	Vec3 offsetY = Vec3(0.f, 20.f, 0.f);
-
-	g_PxPhysXSystem->CreateSimpleSphericalChain(position, length, geometry, separation);
-	g_PxPhysXSystem->CreateLimitedSphericalChain(position + offsetY, length, geometry, separation, m_defaultConeFreedomY, m_defaultConeFreedomZ, m_defaultContactDistance);
-
-	g_PxPhysXSystem->CreateSimpleFixedChain(position + offsetZ, length, geometry, separation);
-	g_PxPhysXSystem->CreateBreakableFixedChain(position + offsetZ + offsetY, length, geometry, separation, m_defaultBreakForce, m_defaultBreakTorque);
-
-	g_PxPhysXSystem->CreateDampedD6Chain(position + (offsetZ * 2.f), length, geometry, separation, m_defaultDriveStiffness, m_defaultDriveDamping, m_defaultDriveForceLimit, m_isDriveAccelerating);
-}
-
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::CreatePhysXConvexHull()
-{
-	std::vector<Vec3> vertexArray;
-
-	const int numVerts = 64;
-
-	// Prepare random verts
-	for (PxU32 i = 0; i < numVerts; i++)
-	{
-		vertexArray.push_back(Vec3(g_RNG->GetRandomFloatInRange(-5.f, 5.f) , g_RNG->GetRandomFloatInRange(0.f, 5.f), g_RNG->GetRandomFloatInRange(-5.f, 5.f)));
-	}
-
-	g_PxPhysXSystem->CreateRandomConvexHull(vertexArray, 16, false);
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::CreatePhysXStack(const Vec3& position, uint size, float halfExtent)
-{
-	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
-	PxScene* pxScene = g_PxPhysXSystem->GetPhysXScene();
-
-	PxTransform pxTransform = PxTransform(PxVec3(position.x, position.y, position.z));
-
-	//We are going to make a stack of boxes
-	PxBoxGeometry box = PxBoxGeometry((PxReal)halfExtent, (PxReal)halfExtent, (PxReal)halfExtent);
-	PxMaterial* pxMaterial = physX->createMaterial(0.5f, 0.5f, 0.6f);
-	PxShape* shape = physX->createShape(box, *pxMaterial);
-	
-	//Loop to stack everything in a pyramid shape
-	for (PxU32 layerIndex = 0; layerIndex < size; layerIndex++)
-	{
-		for (PxU32 indexInLayer = 0; indexInLayer < size - layerIndex; indexInLayer++)
-		{
-			PxTransform localTm(PxVec3(PxReal(indexInLayer * 2) - PxReal(size - layerIndex), PxReal(layerIndex * 2 + 1), 0) * halfExtent);
-			PxRigidDynamic* body = physX->createRigidDynamic(pxTransform.transform(localTm));
-			body->attachShape(*shape);
-			PxRigidBodyExt::updateMassAndInertia(*body, 10.0f);
-			pxScene->addActor(*body);
-		}
-	}
-
-	//release the shape now, we don't need it anymore since everything has been added to the PhysX scene
-	shape->release();
-}
-
 //------------------------------------------------------------------------------------------------------------------------------
 STATIC bool Game::TestEvent(EventArgs& args)
 {
@@ -732,6 +443,47 @@ STATIC bool Game::ToggleAllPointLights( EventArgs& args )
 	return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Game::PrintPhysXMemory(EventArgs& args)
+{
+	UNUSED(args);
+
+	char line[256];
+	snprintf(line, sizeof(line), "PhysX memory: live %.1f KB, peak %.1f KB, pools %.1f KB reserved, %lld shared pool locks",
+		g_PxPoolAllocator.GetLiveBytes() / 1024.0, g_PxPoolAllocator.GetPeakBytes() / 1024.0, g_PxPoolAllocator.GetReservedPoolBytes() / 1024.0,
+		(long long)g_PxPoolAllocator.GetNumSharedPoolLocks());
+	g_devConsole->PrintString(Rgba::WHITE, line);
+
+	std::vector<PhysXAllocationTagStats> tagStats;
+	g_PxPoolAllocator.GetTagStats(tagStats);
+	for (int tagIndex = 0; tagIndex < (int)tagStats.size(); ++tagIndex)
+	{
+		snprintf(line, sizeof(line), "  %s: live %.1f KB, peak %.1f KB, %lld allocs, %.1f allocs/s", tagStats[tagIndex].m_name,
+			tagStats[tagIndex].m_liveBytes / 1024.0, tagStats[tagIndex].m_peakBytes / 1024.0, (long long)tagStats[tagIndex].m_numAllocations,
+			tagStats[tagIndex].m_allocationsPerSecond);
+		g_devConsole->PrintString(Rgba::WHITE, line);
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Game::StartProfileCapture(EventArgs& args)
+{
+	//ProfileCapture frames=120 file=Profile.json
+	int numFrames = args.GetValue("frames", gDefaultProfileCaptureFrames);
+	std::string tracePath = args.GetValue("file", std::string(gDefaultProfileTracePath));
+
+	if (Profiler::IsCapturing())
+	{
+		g_devConsole->PrintString(Rgba::RED, "A profile capture is already running");
+		return false;
+	}
+
+	Profiler::BeginCapture(numFrames, tracePath);
+	g_devConsole->PrintString(Rgba::WHITE, "Profile capture started");
+	return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::HandleKeyPressed(unsigned char keyCode)
 {
@@ -763,7 +515,9 @@ void Game::HandleKeyPressed(unsigned char keyCode)
 			
 			velocity = m_mainCamera->GetCameraForward() * 100.f;
 
-			g_PxPhysXSystem->CreateDynamicObject(PxSphereGeometry(3.f), velocity, m_mainCamera->GetModelMatrix(), m_dynamicObjectDensity);
+			Matrix44 cameraModel = m_mainCamera->GetModelMatrix();
+			PxTransform pose(g_PxPhysXSystem->VecToPxVector(cameraModel.GetTBasis()), g_PxPhysXSystem->MakeQuaternionFromMatrix(cameraModel));
+			QueueProjectile(pose, g_PxPhysXSystem->VecToPxVector(velocity));
 		}
 		break;
 		case N_KEY:
@@ -870,7 +624,7 @@ void Game::DebugEnabled()
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::Shutdown()
 {
-	//m_carController->ReleaseVehicle();
+	ShutdownSimulation();
 
 	delete m_mainCamera;
 	m_mainCamera = nullptr;
@@ -896,20 +650,27 @@ void Game::Shutdown()
 	delete m_capsule;
 	m_capsule = nullptr;
 
-	delete m_pxCube;
-	m_pxCube = nullptr;
-
-	delete m_pxSphere;
-	m_pxSphere = nullptr;
+	delete m_carColliderDebugMesh;
+	m_carColliderDebugMesh = nullptr;
 
-	delete m_pxConvexMesh;
-	m_pxConvexMesh = nullptr;
-
-	delete m_pxCapMesh;
-	m_pxCapMesh = nullptr;
+	for (int slotIndex = 0; slotIndex < (int)m_pxUnitMeshes.size(); ++slotIndex)
+	{
+		delete m_pxUnitMeshes[slotIndex].m_mesh;
+	}
+	m_pxUnitMeshes.clear();
 	//FreeResources();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::PrintQueuedConsoleReports()
+{
+	for (int reportIndex = 0; reportIndex < (int)m_queuedConsoleReports.size(); ++reportIndex)
+	{
+		g_devConsole->PrintString(Rgba::WHITE, m_queuedConsoleReports[reportIndex].c_str());
+	}
+	m_queuedConsoleReports.clear();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::HandleKeyReleased(unsigned char keyCode)
 {
@@ -955,6 +716,9 @@ bool Game::HandleMouseScroll(float wheelDelta)
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::Render() const
 {
+	PROFILE_SCOPE("Game::Render");
+	ScopedAllocationCheck allocationCheck("Game::Render");
+
 	//Get the ColorTargetView from rendercontext
 	ColorTargetView *colorTargetView = g_renderContext->GetFrameColorTarget();
 
@@ -1006,11 +770,11 @@ void Game::Render() const
 
 	if(!m_consoleDebugOnce)
 	{
-		EventArgs* args = new EventArgs();
+		EventArgs args;
 		std::string key = "TestString";
 		std::string value = "This is a test";
-		args->SetValue(key, value);
-		g_devConsole->Command_Test(*args);
+		args.SetValue(key, value);
+		g_devConsole->Command_Test(args);
 		g_devConsole->ExecuteCommandLine("Exec Health=25");
 		g_devConsole->ExecuteCommandLine("Exec Health=85 Armor=100");
 	}
@@ -1050,57 +814,34 @@ void Game::RenderUsingMaterial() const
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::RenderPhysXScene() const
 {
-	//Get the actors in the scene
-	PxScene* scene;
-	PxGetPhysics().getScenes(&scene, 1);
+	PROFILE_SCOPE("Game::RenderPhysXScene");
+	ScopedAllocationCheck allocationCheck("Game::RenderPhysXScene");
 
 	//Bind Material
 	g_renderContext->BindMaterial(m_defaultMaterial);
 
-	int numActors = scene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC);
-	if (numActors > 0)
-	{
-		std::vector<PxRigidActor*> actors(numActors);
-		scene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC, reinterpret_cast<PxActor**>(&actors[0]), numActors);
-
-		Rgba color = Rgba(0.f, 0.4f, 0.f, 1.f);
-		RenderPhysXActors(actors, (int)actors.size(), color);
-	}
+	//Static, sleeping and moving actors all come from the proxy cache. Nothing here walks the PxScene
+	RenderPhysXActors();
 
-	int numArticulations = scene->getNbArticulations();
-	if (numArticulations > 0)
+	//Only for Vehicle SDK
+	for (int vehicleIndex = 0; vehicleIndex < m_vehicleManager->GetNumVehicles(); vehicleIndex++)
 	{
-		PxArticulationBase* articulation;
-		scene->getArticulations(&articulation, 1);
-
-		int numLinks = articulation->getNbLinks();
-		std::vector<PxArticulationLink*> links(numLinks);
-		articulation->getLinks(&links[0], numLinks);
-
-		std::vector<PxRigidActor*> actors;
-		for (int i = 0; i < numLinks; ++i)
-		{
-			actors.push_back(reinterpret_cast<PxRigidActor*>(links[i]));
-		}
-
-		Rgba color = Rgba(1.f, 1.f, 1.f, 1.f);
-		RenderPhysXActors(actors, (int)actors.size(), color);
+		PxVehicleDrive4W* vehicle = m_vehicleManager->GetVehicle(vehicleIndex);
+		RenderPhysXCar(*vehicle, vehicle == m_carController->GetVehicle());
 	}
-
-	//Only for Vehicle SDK
-	RenderPhysXCar();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderPhysXCar() const
+void Game::RenderPhysXCar(const PxVehicleDrive4W& vehicle, bool isPlayerCar) const
 {
+	PROFILE_SCOPE("Game::RenderPhysXCar");
+	ScopedAllocationCheck allocationCheck("Game::RenderPhysXCar");
+
 	//Draw a maximum of 10 shapes
 	PxShape* shapes[10] = { nullptr };
-	CPUMesh carMesh;
-	CPUMesh cvxMesh;
 	Matrix44 model;
 
-	PxRigidActor *car = m_carController->GetVehicle()->getRigidDynamicActor();
+	const PxRigidActor* car = vehicle.getRigidDynamicActor();
 	int numShapes = car->getNbShapes();
 	car->getShapes(shapes, numShapes);
 
@@ -1109,7 +850,8 @@ void Game::RenderPhysXCar() const
 		PxConvexMeshGeometry geometry;
 		shapes[shapeIndex]->getConvexMeshGeometry(geometry);
 
-		PxMat44 pxMat = car->getGlobalPose() * shapes[shapeIndex]->getLocalPose();
+		PxTransform shapePose = m_renderProxies.GetRenderPose(*car) * shapes[shapeIndex]->getLocalPose();
+		PxMat44 pxMat = PxMat44(shapePose);
 
 		model.SetIBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column0));
 		model.SetJBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column1));
@@ -1124,24 +866,27 @@ void Game::RenderPhysXCar() const
 			g_renderContext->SetModelMatrix(model);
 
 			//Draw the car mesh
-			g_renderContext->BindMaterial(g_renderContext->CreateOrGetMaterialFromFile(m_carModel->GetDefaultMaterialName()));
+			g_renderContext->BindMaterial(m_carMaterial);
 			g_renderContext->SetModelMatrix(model);
 			g_renderContext->DrawMesh(m_carModel);
 
-			if (m_debugViewCarCollider)
+			if (isPlayerCar && m_debugViewCarCollider && m_carColliderDebugMesh != nullptr)
 			{
-				g_renderContext->SetModelMatrix(Matrix44::IDENTITY);
+				Matrix44 colliderModel;
+				colliderModel.SetIBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column0));
+				colliderModel.SetJBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column1));
+				colliderModel.SetKBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column2));
+				colliderModel.SetTBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column3));
+
 				g_renderContext->BindMaterial(m_defaultMaterial);
-				AddMeshForConvexMesh(cvxMesh, *car, *shapes[shapeIndex], Rgba(1.f, 0.f, 1.f, 0.3f));
-				GPUMesh debugMesh(g_renderContext);
-				debugMesh.CreateFromCPUMesh<Vertex_Lit>(&cvxMesh);
-				g_renderContext->DrawMesh(&debugMesh);
+				g_renderContext->SetModelMatrix(colliderModel);
+				g_renderContext->DrawMesh(m_carColliderDebugMesh);
 			}
 		
 		}
 		else
 		{
-			g_renderContext->BindMaterial(g_renderContext->CreateOrGetMaterialFromFile(m_wheelModel->GetDefaultMaterialName()));
+			g_renderContext->BindMaterial(m_wheelMaterial);
 			g_renderContext->SetModelMatrix(model);
 			if (shapeIndex == 1 || shapeIndex == 3)
 			{
@@ -1158,90 +903,204 @@ void Game::RenderPhysXCar() const
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderPhysXActors(const std::vector<PxRigidActor*> actors, int numActors, Rgba& color) const
+void Game::RenderPhysXActors() const
 {
-	//Look for maximum of 10 shapes to draw per actor
-	PxShape* shapes[10] = { nullptr };
+	PROFILE_SCOPE("Game::RenderPhysXActors");
+	ScopedAllocationCheck allocationCheck("Game::RenderPhysXActors");
 
-	CPUMesh boxMesh;
-	CPUMesh sphereMesh;
-	CPUMesh cvxMesh;
-	CPUMesh capMesh;
+	//Instances were packed in Update, all that is left is one model matrix and a draw per shape on a mesh that never changes.
+	//RenderContext has no instanced draw, so this stays a draw per shape
+	Matrix44 model;
+	bool isSphereShaderBound = false;
 
-	for (int actorIndex = 0; actorIndex < numActors; actorIndex++)
+	for (int slotIndex = 0; slotIndex < m_pxInstanceBatch.GetNumSlots(); ++slotIndex)
 	{
-		const int numShapes = actors[actorIndex]->getNbShapes();
-		actors[actorIndex]->getShapes(shapes, numShapes);
-
-		const bool sleeping = actors[actorIndex]->is<PxRigidDynamic>() ? actors[actorIndex]->is<PxRigidDynamic>()->isSleeping() : false;
+		int numInstances = m_pxInstanceBatch.GetNumInstances(slotIndex);
+		if (numInstances == 0)
+		{
+			continue;
+		}
 
-		for (int shapeIndex = 0; shapeIndex < numShapes; shapeIndex++)
+		const PhysXUnitMesh& unitMesh = m_pxUnitMeshes[slotIndex];
+		if (unitMesh.m_geometryType == PxGeometryType::eSPHERE && !isSphereShaderBound)
+		{
+			g_renderContext->BindShader(m_shader);
+			g_renderContext->BindTextureViewWithSampler(0U, m_sphereTexture);
+			isSphereShaderBound = true;
+		}
+		else if (unitMesh.m_geometryType != PxGeometryType::eSPHERE && isSphereShaderBound)
 		{
-			int type = shapes[shapeIndex]->getGeometryType();
+			g_renderContext->BindMaterial(m_defaultMaterial);
+			isSphereShaderBound = false;
+		}
 
-			switch (type)
-			{
-			case PxGeometryType::eBOX:
-			{
-				color = GetColorForGeometry(type, sleeping);
-				AddMeshForPxCube(boxMesh, *actors[actorIndex], *shapes[shapeIndex], color);
-			}
-			break;
-			case PxGeometryType::eSPHERE:
-			{
-				color = GetColorForGeometry(type, sleeping);
-				AddMeshForPxSphere(sphereMesh, *actors[actorIndex], *shapes[shapeIndex], color);
-			}
-			break;
-			case PxGeometryType::eCONVEXMESH:
-			{
-				if (numShapes == 1)
-				{
-					color = GetColorForGeometry(type, sleeping);
-					AddMeshForConvexMesh(cvxMesh, *actors[actorIndex], *shapes[shapeIndex], color);
-				}
-			}
-			break;
-			case PxGeometryType::eCAPSULE:
-			{
-				color = GetColorForGeometry(type, sleeping);
-				AddMeshForPxCapsule(capMesh, *actors[actorIndex], *shapes[shapeIndex], color);
-			}
-			break;
-			default:
-				break;
-			}
+		const PhysXShapeInstance* instances = m_pxInstanceBatch.GetInstances(slotIndex);
+		for (int instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex)
+		{
+			const float* basis = instances[instanceIndex].m_basis;
+			model.SetIBasis(g_PxPhysXSystem->PxVectorToVec(PxVec4(basis[0], basis[1], basis[2], 0.f)));
+			model.SetJBasis(g_PxPhysXSystem->PxVectorToVec(PxVec4(basis[3], basis[4], basis[5], 0.f)));
+			model.SetKBasis(g_PxPhysXSystem->PxVectorToVec(PxVec4(basis[6], basis[7], basis[8], 0.f)));
+			model.SetTBasis(g_PxPhysXSystem->PxVectorToVec(PxVec4(basis[9], basis[10], basis[11], 1.f)));
 
+			g_renderContext->SetModelMatrix(model);
+			g_renderContext->DrawMesh(unitMesh.m_mesh);
 		}
 	}
 
-	g_renderContext->SetModelMatrix(Matrix44::IDENTITY);
-	
-	if (boxMesh.GetVertexCount() > 0)
+	if (isSphereShaderBound)
 	{
-		m_pxCube->CreateFromCPUMesh<Vertex_Lit>(&boxMesh, GPU_MEMORY_USAGE_STATIC);
-		g_renderContext->DrawMesh(m_pxCube);
+		g_renderContext->BindMaterial(m_defaultMaterial);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int Game::GetOrCreatePhysXUnitMesh(int type, float radius, float halfHeight, const PxConvexMesh* convexMesh)
+{
+	PROFILE_SCOPE("Game::GetOrCreatePhysXUnitMesh");
+
+	for (int slotIndex = 0; slotIndex < (int)m_pxUnitMeshes.size(); slotIndex += 2)
+	{
+		const PhysXUnitMesh& unitMesh = m_pxUnitMeshes[slotIndex];
+		if (unitMesh.m_geometryType == type && unitMesh.m_radius == radius && unitMesh.m_halfHeight == halfHeight && unitMesh.m_convexMesh == convexMesh)
+		{
+			return slotIndex;
+		}
 	}
 
-	if (sphereMesh.GetVertexCount() > 0)
+	int awakeSlot = (int)m_pxUnitMeshes.size();
+
+	for (int sleepIndex = 0; sleepIndex < 2; ++sleepIndex)
 	{
-		m_pxSphere->CreateFromCPUMesh<Vertex_Lit>(&sphereMesh, GPU_MEMORY_USAGE_STATIC);
+		bool isSleeping = sleepIndex == 1;
+		Rgba color = GetColorForGeometry(type, isSleeping);
+
+		CPUMesh mesh;
+		switch (type)
+		{
+		case PxGeometryType::eBOX:
+		{
+			//Half extent of 1, the instance scale is the box half extents
+			CPUMeshAddCube(&mesh, AABB3(Vec3(-1.f, -1.f, -1.f), Vec3(1.f, 1.f, 1.f)), color);
+		}
+		break;
+		case PxGeometryType::eSPHERE:
+		{
+			CPUMeshAddUVSphere(&mesh, Vec3::ZERO, 1.f, color, 16, 8);
+		}
+		break;
+		case PxGeometryType::eCAPSULE:
+		{
+			//PhysX capsules run along X, the mesh is built along Y
+			Vec3 heightOffset = Vec3(0.f, halfHeight, 0.f);
+			CPUMeshAddUVCapsule(&mesh, heightOffset, -1.f * heightOffset, radius, color, 16, 8);
+			mesh.TransformVerticesInRange(0, mesh.GetVertexCount(), Matrix44::MakeZRotationDegrees(90.f));
+		}
+		break;
+		case PxGeometryType::eCONVEXMESH:
+		{
+			AddMeshForConvexMesh(mesh, *convexMesh, color);
+		}
+		break;
+		default:
+			break;
+		}
 
-		g_renderContext->BindShader(m_shader);
-		g_renderContext->BindTextureViewWithSampler(0U, m_sphereTexture);
-		g_renderContext->DrawMesh(m_pxSphere);
+		PhysXUnitMesh unitMesh;
+		unitMesh.m_geometryType = type;
+		unitMesh.m_isSleeping = isSleeping;
+		unitMesh.m_radius = radius;
+		unitMesh.m_halfHeight = halfHeight;
+		unitMesh.m_convexMesh = convexMesh;
+		unitMesh.m_mesh = new GPUMesh(g_renderContext);
+		unitMesh.m_mesh->CreateFromCPUMesh<Vertex_Lit>(&mesh, GPU_MEMORY_USAGE_STATIC);
+
+		m_pxUnitMeshes.push_back(unitMesh);
+	}
+
+	return awakeSlot;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::BuildPhysXInstances()
+{
+	PROFILE_SCOPE("Game::BuildPhysXInstances");
+
+	const std::vector<PhysXRenderActor>& renderActors = m_renderProxies.GetActors();
+	const std::vector<PhysXRenderShape>& renderShapes = m_renderProxies.GetShapes();
+
+	//Shape indices only stay valid for one generation of the proxy cache, resolve mesh slots again after a rebuild
+	if (m_pxShapeSlotsGeneration != m_renderProxies.GetGeneration())
+	{
+		m_pxShapeMeshSlots.clear();
+		m_pxShapeSlotsGeneration = m_renderProxies.GetGeneration();
 	}
 
-	if (cvxMesh.GetVertexCount() > 0)
+	for (int shapeIndex = (int)m_pxShapeMeshSlots.size(); shapeIndex < (int)renderShapes.size(); ++shapeIndex)
 	{
-		m_pxConvexMesh->CreateFromCPUMesh<Vertex_Lit>(&cvxMesh, GPU_MEMORY_USAGE_STATIC);
-		g_renderContext->DrawMesh(m_pxConvexMesh);
+		const PhysXRenderShape& renderShape = renderShapes[shapeIndex];
+		int slot = -1;
+
+		switch (renderShape.m_geometry.getType())
+		{
+		case PxGeometryType::eBOX:
+		{
+			slot = GetOrCreatePhysXUnitMesh(PxGeometryType::eBOX, 0.f, 0.f);
+		}
+		break;
+		case PxGeometryType::eSPHERE:
+		{
+			slot = GetOrCreatePhysXUnitMesh(PxGeometryType::eSPHERE, 0.f, 0.f);
+		}
+		break;
+		case PxGeometryType::eCAPSULE:
+		{
+			const PxCapsuleGeometry& capsule = renderShape.m_geometry.capsule();
+			slot = GetOrCreatePhysXUnitMesh(PxGeometryType::eCAPSULE, capsule.radius, capsule.halfHeight);
+		}
+		break;
+		case PxGeometryType::eCONVEXMESH:
+		{
+			//Multi shape convex actors (the car) are drawn by RenderPhysXCar
+			if (renderActors[renderShape.m_actorIndex].m_numShapes == 1)
+			{
+				slot = GetOrCreatePhysXUnitMesh(PxGeometryType::eCONVEXMESH, 0.f, 0.f, renderShape.m_geometry.convexMesh().convexMesh);
+			}
+		}
+		break;
+		default:
+			break;
+		}
+
+		m_pxShapeMeshSlots.push_back(slot);
 	}
 
-	if (capMesh.GetVertexCount() > 0)
+	m_pxInstanceBatch.Clear();
+
+	for (int shapeIndex = 0; shapeIndex < (int)renderShapes.size(); ++shapeIndex)
 	{
-		m_pxCapMesh->CreateFromCPUMesh<Vertex_Lit>(&capMesh, GPU_MEMORY_USAGE_STATIC);
-		g_renderContext->DrawMesh(m_pxCapMesh);
+		int slot = m_pxShapeMeshSlots[shapeIndex];
+		if (slot < 0)
+		{
+			continue;
+		}
+
+		const PhysXRenderShape& renderShape = renderShapes[shapeIndex];
+		const PhysXRenderActor& renderActor = renderActors[renderShape.m_actorIndex];
+		if (renderActor.m_isHidden)
+		{
+			continue;
+		}
+
+		PxVec3 scale = PhysXInstanceBatch::GetUnitMeshScale(renderShape.m_geometry);
+
+		if (renderActor.m_isSleeping)
+		{
+			slot++;
+		}
+
+		PxTransform pose = m_renderProxies.GetRenderPose(renderShape.m_actorIndex) * renderShape.m_localPose;
+		m_pxInstanceBatch.AddInstance(slot, pose, scale);
 	}
 }
 
@@ -1307,184 +1166,89 @@ Rgba Game::GetColorForGeometry(int type, bool isSleeping) const
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::AddMeshForPxCube(CPUMesh& boxMesh, const PxRigidActor& actor, const PxShape& shape, const Rgba& color) const
-{
-	PxBoxGeometry box;
-	shape.getBoxGeometry(box);
-	Vec3 halfExtents = g_PxPhysXSystem->PxVectorToVec(box.halfExtents);
-	PxMat44 pxTransform = actor.getGlobalPose();
-	PxVec3 pxPosition = pxTransform.getPosition();
-
-	Matrix44 pose;
-	pose.SetIBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column0));
-	pose.SetJBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column1));
-	pose.SetKBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column2));
-	pose.SetTBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column3));
-
-	AABB3 boxShape = AABB3(-1.f * halfExtents, halfExtents);
-	boxShape.TransfromUsingMatrix(pose);
-
-	CPUMeshAddCube(&boxMesh, boxShape, color);
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::AddMeshForPxSphere(CPUMesh& sphereMesh, const PxRigidActor& actor, const PxShape& shape, const Rgba& color) const
-{
-	PxSphereGeometry sphere;
-	shape.getSphereGeometry(sphere);
-
-	PxMat44 pxTransform = actor.getGlobalPose();
-	PxVec3 pxPosition = pxTransform.getPosition();
-
-	float radius = sphere.radius;
-
-	Matrix44 pose;
-	pose.SetIBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column0));
-	pose.SetJBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column1));
-	pose.SetKBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column2));
-	pose.SetTBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column3));
-
-	CPUMeshAddUVSphere(&sphereMesh, Vec3::ZERO, radius, color, 16, 8);
-
-	int numVerts = sphereMesh.GetVertexCount();
-	int limit = numVerts - ((16 + 1) * (8 + 1));
-
-	sphereMesh.TransformVerticesInRange(limit, numVerts, pose);
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::AddMeshForPxCapsule(CPUMesh& capMesh, const PxRigidActor& actor, const PxShape& shape, const Rgba& color) const
+void Game::AddMeshForConvexMesh(CPUMesh& cvxMesh, const PxConvexMesh& convexMesh, const Rgba& color) const
 {
-	PxCapsuleGeometry capsule;
-	shape.getCapsuleGeometry(capsule);
+	PROFILE_SCOPE("Game::AddMeshForConvexMesh");
 
-	PxMat44 pxTransform = actor.getGlobalPose();
-	PxVec3 pxPosition = pxTransform.getPosition();
+	//Local space and indexed. Each hull polygon gets its own vertices so it keeps a flat normal, then is fanned into triangles
+	const int nbPolys = convexMesh.getNbPolygons();
+	const uint8_t* polygons = convexMesh.getIndexBuffer();
+	const PxVec3* verts = convexMesh.getVertices();
+	int nbVerts = convexMesh.getNbVertices();
+	PX_UNUSED(nbVerts);
 
-	float radius = capsule.radius;
+	for (int index = 0; index < nbPolys; index++)
+	{
+		PxHullPolygon data;
+		convexMesh.getPolygonData(index, data);
 
-	Matrix44 pose;
-	pose.SetIBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column0));
-	pose.SetJBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column1));
-	pose.SetKBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column2));
-	pose.SetTBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column3));
+		//The polygon plane already holds the outward face normal
+		PxVec3 fnormal = PxVec3(data.mPlane[0], data.mPlane[1], data.mPlane[2]);
 
-	float halfHeight = capsule.halfHeight;
-	Vec3 heightOffset = Vec3(0.f, halfHeight, 0.f);
-	Vec3 start = Vec3::ZERO + heightOffset;
-	Vec3 end = Vec3::ZERO - heightOffset;
+		const int baseVertex = cvxMesh.GetVertexCount();
 
-	CPUMeshAddUVCapsule(&capMesh, start, end, radius, color, 16, 8);
+		VertexMaster vert;
+		vert.m_color = color;
+		vert.m_normal = g_PxPhysXSystem->PxVectorToVec(fnormal);
 
-	int numVerts = capMesh.GetVertexCount();
-	int limit = numVerts - ((16 + 1) * (8 + 1));
+		for (int polyVertIndex = 0; polyVertIndex < (int)data.mNbVerts; polyVertIndex++)
+		{
+			const int vref = polygons[data.mIndexBase + polyVertIndex];
+			PX_ASSERT(vref < nbVerts);
 
-	Matrix44 rotationMatrix = Matrix44::MakeZRotationDegrees(90.f);
+			vert.m_position = g_PxPhysXSystem->PxVectorToVec(verts[vref]);
+			cvxMesh.AddVertex(vert);
+		}
 
-	capMesh.TransformVerticesInRange(limit, numVerts, rotationMatrix);
-	capMesh.TransformVerticesInRange(limit, numVerts, pose);
+		//Wound 0, 2, 1 to match our handedness
+		const int nbTris = int(data.mNbVerts - 2);
+		for (int jIndex = 0; jIndex < nbTris; jIndex++)
+		{
+			cvxMesh.AddIndex(baseVertex);
+			cvxMesh.AddIndex(baseVertex + jIndex + 2);
+			cvxMesh.AddIndex(baseVertex + jIndex + 1);
+		}
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::AddMeshForConvexMesh(CPUMesh& cvxMesh, const PxRigidActor& actor, const PxShape& shape, const Rgba& color) const
+void Game::UpdateCarColliderDebugMesh()
 {
-	PxConvexMeshGeometry convexGeometry;
-	shape.getConvexMeshGeometry(convexGeometry);
-
-	//const Vec3& scale = g_PxPhysXSystem->PxVectorToVec(convexGeometry.scale.scale);
-	PxConvexMesh* pxCvxMesh = convexGeometry.convexMesh;
-	const int nbPolys = pxCvxMesh->getNbPolygons();
-	const uint8_t* polygons = pxCvxMesh->getIndexBuffer();
-	const PxVec3* verts = pxCvxMesh->getVertices();
-	int nbVerts = pxCvxMesh->getNbVertices();
-	PX_UNUSED(nbVerts);
+	PROFILE_SCOPE("Game::UpdateCarColliderDebugMesh");
 
-	PxMat44 pxTransform = actor.getGlobalPose() * shape.getLocalPose();
-	PxVec3 pxPosition = pxTransform.getPosition();
+	//The car is only replaced along with the whole Game, so its chassis collider is triangulated once on first use
+	if (!m_debugViewCarCollider || m_carColliderDebugMesh != nullptr)
+	{
+		return;
+	}
 
-	Matrix44 pose;
-	pose.SetIBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column0));
-	pose.SetJBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column1));
-	pose.SetKBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column2));
-	pose.SetTBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column3));
+	PxShape* shapes[10] = { nullptr };
+	PxRigidActor* car = m_carController->GetVehicle()->getRigidDynamicActor();
+	int numShapes = car->getShapes(shapes, 10);
 
-	int numTotalTriangles = 0;
-	for (int index = 0; index < nbPolys; index++)
+	for (int shapeIndex = 0; shapeIndex < numShapes; shapeIndex++)
 	{
-		PxHullPolygon data;
-		pxCvxMesh->getPolygonData(index, data);
+		PxConvexMeshGeometry geometry;
+		shapes[shapeIndex]->getConvexMeshGeometry(geometry);
 
-		const int nbTris = int(data.mNbVerts - 2);
-		const int vref0 = polygons[data.mIndexBase + 0];
-		PX_ASSERT(vref0 < nbVerts);
-		for (int jIndex = 0; jIndex < nbTris; jIndex++)
+		if (geometry.convexMesh->getNbVertices() == 8)
 		{
-			const int vref1 = polygons[data.mIndexBase + 0 + jIndex + 1];
-			const int vref2 = polygons[data.mIndexBase + 0 + jIndex + 2];
-
-			//generate face normal:
-			PxVec3 e0 = verts[vref1] - verts[vref0];
-			PxVec3 e1 = verts[vref2] - verts[vref0];
-
-			PX_ASSERT(vref1 < nbVerts);
-			PX_ASSERT(vref2 < nbVerts);
+			CPUMesh cvxMesh;
+			AddMeshForConvexMesh(cvxMesh, *geometry.convexMesh, Rgba(1.f, 0.f, 1.f, 0.3f));
 
-			PxVec3 fnormal = e0.cross(e1);
-			fnormal.normalize();
-			//fnormal *= -1.f;
-
-			VertexMaster vert;
-			vert.m_color = color;
-			if (numTotalTriangles * 3 < 1024)
-			{
-				Vec3 position = g_PxPhysXSystem->PxVectorToVec(verts[vref0]);
-				position = pose.TransformPosition3D(position);
-
-				vert.m_position = position;
-				vert.m_normal = g_PxPhysXSystem->PxVectorToVec(fnormal);
-				cvxMesh.AddVertex(vert);
-
-				position = g_PxPhysXSystem->PxVectorToVec(verts[vref2]);
-				position = pose.TransformPosition3D(position);
-				vert.m_position = position;
-				cvxMesh.AddVertex(vert);
-
-				position = g_PxPhysXSystem->PxVectorToVec(verts[vref1]);
-				position = pose.TransformPosition3D(position);
-				vert.m_position = position;
-				cvxMesh.AddVertex(vert);
-
-				numTotalTriangles++;
-			}
+			m_carColliderDebugMesh = new GPUMesh(g_renderContext);
+			m_carColliderDebugMesh->CreateFromCPUMesh<Vertex_Lit>(&cvxMesh, GPU_MEMORY_USAGE_STATIC);
+			return;
 		}
 	}
-
-	int vertCount = cvxMesh.GetVertexCount();
-	for (int indexIndex = 0; indexIndex < vertCount; indexIndex++)
-	{
-		cvxMesh.AddIndex(indexIndex);
-	}
-
-	/*
-	Matrix44 pose;
-	pose.SetIBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column0));
-	pose.SetJBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column1));
-	pose.SetKBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column2));
-	pose.SetTBasis(g_PxPhysXSystem->PxVectorToVec(pxTransform.column3));
-	
-
-	int numVerts = cvxMesh.GetVertexCount();
-	int limit = nbVerts;
-	Matrix44 rotationMatrix = Matrix44::MakeZRotationDegrees(90.f);
-
-	cvxMesh.TransformVerticesInRange(limit, numVerts, rotationMatrix);
-	cvxMesh.TransformVerticesInRange(limit, numVerts, pose);
-	*/
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::DebugRenderToScreen() const
 {
+	PROFILE_SCOPE("Game::DebugRenderToScreen");
+	ScopedAllocationCheck allocationCheck("Game::DebugRenderToScreen");
+
 	Camera& debugCamera = g_debugRenderer->Get2DCamera();
 	debugCamera.m_colorTargetView = g_renderContext->GetFrameColorTarget();
 	
@@ -1500,6 +1264,9 @@ void Game::DebugRenderToScreen() const
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::DebugRenderToCamera() const
 {
+	PROFILE_SCOPE("Game::DebugRenderToCamera");
+	ScopedAllocationCheck allocationCheck("Game::DebugRenderToCamera");
+
 	Camera& debugCamera3D = *m_mainCamera;
 	debugCamera3D.m_colorTargetView = g_renderContext->GetFrameColorTarget();
 
@@ -1516,6 +1283,9 @@ void Game::DebugRenderToCamera() const
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::PostRender()
 {
+	PROFILE_SCOPE("Game::PostRender");
+	ScopedAllocationCheck allocationCheck("Game::PostRender");
+
 	//Debug bools
 	m_consoleDebugOnce = true;
 
@@ -1537,12 +1307,20 @@ void Game::PostRender()
 	DebugRenderToScreen();
 
 	g_ImGUI->Render();
+
+	//The car pose from every finished step has now been drawn
+	m_inputLatency.OnPoseVisible();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::Update( float deltaTime )
 {
+	PROFILE_SCOPE("Game::Update");
+	ScopedAllocationCheck allocationCheck("Game::Update");
+
 	UpdateMouseInputs(deltaTime);
+	//Resets and input recording run in FixedUpdate, their reports land here a frame later
+	PrintQueuedConsoleReports();
 	
 	//g_ImGUI->BeginFrame();
 
@@ -1553,6 +1331,8 @@ void Game::Update( float deltaTime )
 	}
 
 	g_renderContext->m_frameCount++;
+	g_PxPoolAllocator.UpdateRates(deltaTime);
+	m_lastFrameSeconds = deltaTime;
 
 	m_animTime += deltaTime;
 	float currentTime = static_cast<float>(GetCurrentTimeSeconds());
@@ -1570,14 +1350,83 @@ void Game::Update( float deltaTime )
 	m_testDirection = m_testDirection.GetRotatedAboutYDegrees(currentTime * ui_testSlider);
 
 	UpdateImGUI();
-	UpdatePhysXCar(deltaTime);
 	UpdateCarCamera(deltaTime);
+
+	//Runs after the App has set this frame's interpolation alpha
+	BuildPhysXInstances();
+	UpdateCarColliderDebugMesh();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::FixedUpdate(float fixedDeltaTime)
+{
+	PROFILE_SCOPE("Game::FixedUpdate");
+	ScopedAllocationCheck allocationCheck("Game::FixedUpdate");
+
+	ProcessQueuedInputRecordingAction(fixedDeltaTime);
+	UpdateProjectiles(fixedDeltaTime);
+	UpdatePhysXCar(fixedDeltaTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::PostPhysicsStep()
+{
+	PROFILE_SCOPE("Game::PostPhysicsStep");
+	ScopedAllocationCheck allocationCheck("Game::PostPhysicsStep");
+
+	m_renderProxies.UpdateFromActiveActors(*g_PxPhysXSystem->GetPhysXScene());
+	RecordPhysXStats(m_lastFrameSeconds);
+	UpdateInputRecordingHash();
+
+	m_inputLatency.OnPhysicsStepDone();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SetPhysicsInterpolation(float alpha)
+{
+	m_renderProxies.SetInterpolationAlpha(alpha);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::UpdatePhysXCar(float deltaTime)
 {
-	m_carController->Update(deltaTime);
+	PROFILE_SCOPE("Game::UpdatePhysXCar");
+
+	//Read the controller before stepping so this step's smoothing consumes it instead of the next one. A replay that has
+	//run out hands the car back to the controller on the same step
+	bool isInputReplayed = IsReplayingInput() && ApplyReplayedInput() > 0.f;
+	if (!isInputReplayed)
+	{
+		m_carController->UpdateInputs();
+	}
+	RecordPlayerInput(deltaTime);
+
+	UpdateVehicles(deltaTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ProcessQueuedInputRecordingAction(float fixedDeltaTime)
+{
+	switch (m_queuedInputRecordingAction)
+	{
+	case INPUT_RECORDING_ACTION_START_RECORDING:
+		StartInputRecording();
+		break;
+	case INPUT_RECORDING_ACTION_STOP_RECORDING:
+		StopInputRecording(m_inputRecordingPath);
+		break;
+	case INPUT_RECORDING_ACTION_START_REPLAY:
+		//The App only steps at its fixed size, so the recording has to have been made at it
+		StartInputReplay(m_inputRecordingPath, fixedDeltaTime);
+		break;
+	case INPUT_RECORDING_ACTION_STOP_REPLAY:
+		StopInputReplay();
+		break;
+	default:
+		break;
+	}
+
+	m_queuedInputRecordingAction = INPUT_RECORDING_ACTION_NONE;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -1585,11 +1434,13 @@ void Game::UpdateCarCamera(float deltaTime)
 {
 	//Listen to forseth
 	//Try and make a smooth follow camera similar to how our RTS camera works but with smooth step
-	Vec3 carPos =  m_carController->GetVehiclePosition();
+	//Follow the interpolated pose so the camera agrees with what is drawn
+	PxMat44 carPose = PxMat44(m_renderProxies.GetRenderPose(*m_carController->GetVehicle()->getRigidDynamicActor()));
+	Vec3 carPos = g_PxPhysXSystem->PxVectorToVec(carPose.getPosition());
 	m_carCamera->SetFocalPoint(carPos);
 	//m_carCamera->SetZoomDelta(m_frameZoomDelta);
 
-	Vec3 carForward = m_carController->GetVehicleForwardBasis();
+	Vec3 carForward = g_PxPhysXSystem->PxVectorToVec(carPose.getBasis(2));
 
 	m_carCamera->Update(carForward, deltaTime);
 }
@@ -1597,6 +1448,8 @@ void Game::UpdateCarCamera(float deltaTime)
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::UpdateImGUI()
 {
+	PROFILE_SCOPE("Game::UpdateImGUI");
+
 	UpdateImGUIPhysXWidget();
 }
 
@@ -1655,6 +1508,115 @@ void Game::UpdateImGUIPhysXWidget()
 	ImGui::DragFloat("Camera Lerp Speed", &ui_camLerpSpeed);
 
 	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	ImGui::Text("Vehicles: %d sweep, %d raycast, %d cached (%d wheel queries)", m_vehicleManager->GetNumVehiclesAtQuality(VEHICLE_QUERY_SWEEP),
+		m_vehicleManager->GetNumVehiclesAtQuality(VEHICLE_QUERY_RAYCAST), m_vehicleManager->GetNumVehiclesAtQuality(VEHICLE_QUERY_CACHED), m_vehicleManager->GetNumWheelQueriesLastStep());
+	ImGui::Text("Vehicle LOD: %d full, %d reduced, %d kinematic (%d changes)", m_vehicleManager->GetNumVehiclesAtSimLOD(VEHICLE_LOD_FULL),
+		m_vehicleManager->GetNumVehiclesAtSimLOD(VEHICLE_LOD_REDUCED), m_vehicleManager->GetNumVehiclesAtSimLOD(VEHICLE_LOD_KINEMATIC), m_vehicleManager->GetNumSimLODChangesLastStep());
+
+	ImGui::Text("Input to pose ms p50 %.2f p90 %.2f p99 %.2f", m_inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_VISIBLE, 50.f),
+		m_inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_VISIBLE, 90.f), m_inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_VISIBLE, 99.f));
+	ImGui::Text("Input to apply ms p50 %.2f p99 %.2f, dropped samples %d", m_inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_APPLY, 50.f),
+		m_inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_APPLY, 99.f), m_inputLatency.GetNumDroppedSamples());
+	if (ImGui::Button("Export Input Latency"))
+	{
+		m_inputLatency.WriteCSV(m_inputLatencyExportPath);
+	}
+	ImGui::Text("Projectiles: %d of %d live, %d fired, %d recycled, %d despawned", m_projectilePool.GetNumActive(), m_projectilePool.GetCapacity(),
+		m_projectilePool.GetNumFired(), m_projectilePool.GetNumRecycled(), m_projectilePool.GetNumDespawned());
+	if (Profiler::IsCapturing())
+	{
+		ImGui::Text("Profile capture running...");
+	}
+	else if (ImGui::Button("Capture Profile"))
+	{
+		Profiler::BeginCapture(gDefaultProfileCaptureFrames, gDefaultProfileTracePath);
+	}
+	ImGui::Text("Frame arena: %.1f of %.1f KB high water, %d overflows", g_frameArena->GetHighWaterBytes() / 1024.0, g_frameArena->GetCapacityBytes() / 1024.0,
+		g_frameArena->GetNumOverflows());
+	ImGui::Text("Scene actors: %d", g_PxPhysXSystem->GetPhysXScene()->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC));
+
+	if (ImGui::CollapsingHeader("Input Recording"))
+	{
+		ImGui::Text("File: %s", m_inputRecordingPath.c_str());
+
+		switch (m_inputRecording.GetMode())
+		{
+		case VEHICLE_INPUT_RECORDING:
+		{
+			ImGui::Text("Recording, %d steps", m_inputRecording.GetNumSteps());
+			if (ImGui::Button("Stop and Save"))
+			{
+				m_queuedInputRecordingAction = INPUT_RECORDING_ACTION_STOP_RECORDING;
+			}
+		}
+		break;
+		case VEHICLE_INPUT_REPLAYING:
+		{
+			ImGui::Text("Replaying step %d of %d, %d steps differ", m_inputRecording.GetNumReplayedSteps(), m_inputRecording.GetNumSteps(),
+				m_inputRecording.GetNumHashMismatches());
+			if (ImGui::Button("Stop Replay"))
+			{
+				m_queuedInputRecordingAction = INPUT_RECORDING_ACTION_STOP_REPLAY;
+			}
+		}
+		break;
+		default:
+		{
+			if (ImGui::Button("Record Input"))
+			{
+				m_queuedInputRecordingAction = INPUT_RECORDING_ACTION_START_RECORDING;
+			}
+			ImGui::SameLine();
+			if (ImGui::Button("Replay Input"))
+			{
+				m_queuedInputRecordingAction = INPUT_RECORDING_ACTION_START_REPLAY;
+			}
+		}
+		break;
+		}
+	}
+
+	if (ImGui::CollapsingHeader("PhysX Simulation Stats"))
+	{
+		ImGui::Text("%d of %d steps held", m_physXStats.GetNumSamples(), m_physXStats.GetCapacity());
+
+		PhysXStatsPlotData plotData;
+		plotData.m_recorder = &m_physXStats;
+		plotData.m_counter = -1;
+		ImGui::PlotLines("frameMs", GetPhysXStatsPlotValue, &plotData, m_physXStats.GetNumSamples(), 0, nullptr, 0.f, FLT_MAX, ImVec2(0.f, 60.f));
+
+		for (int counterIndex = 0; counterIndex < NUM_PHYSX_STATS_COUNTERS; ++counterIndex)
+		{
+			plotData.m_counter = counterIndex;
+			ePhysXStatsCounter counter = (ePhysXStatsCounter)counterIndex;
+			ImGui::PlotLines(PhysXStatsRecorder::GetCounterName(counter), GetPhysXStatsPlotValue, &plotData, m_physXStats.GetNumSamples(), 0, nullptr,
+				0.f, (float)m_physXStats.GetPeakValue(counter), ImVec2(0.f, 40.f));
+		}
+
+		if (ImGui::Button("Export Stats CSV"))
+		{
+			m_physXStats.WriteCSV(m_physXStatsCSVPath);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Export Stats Binary"))
+		{
+			m_physXStats.WriteBinary(m_physXStatsBinaryPath);
+		}
+	}
+
+	if (ImGui::CollapsingHeader("PhysX Memory"))
+	{
+		ImGui::Text("Live %.1f KB, peak %.1f KB, pools %.1f KB reserved, %lld shared pool locks", g_PxPoolAllocator.GetLiveBytes() / 1024.0,
+			g_PxPoolAllocator.GetPeakBytes() / 1024.0, g_PxPoolAllocator.GetReservedPoolBytes() / 1024.0, (long long)g_PxPoolAllocator.GetNumSharedPoolLocks());
+
+		g_PxPoolAllocator.GetTagStats(m_physXMemoryStats);
+		for (int tagIndex = 0; tagIndex < (int)m_physXMemoryStats.size(); ++tagIndex)
+		{
+			const PhysXAllocationTagStats& tagStats = m_physXMemoryStats[tagIndex];
+			ImGui::Text("%-40s live %9.1f KB  peak %9.1f KB  %8.1f allocs/s", tagStats.m_name, tagStats.m_liveBytes / 1024.0, tagStats.m_peakBytes / 1024.0,
+				tagStats.m_allocationsPerSecond);
+		}
+	}
 
 	//Write CamPos
 	m_camPosition.x = ui_camPosition[0];
@@ -1684,13 +1646,6 @@ void Game::UpdateImGUIPhysXWidget()
 	ImGui::End();
 }
 
-//------------------------------------------------------------------------------------------------------------------------------
-bool Game::IsAlive()
-{
-	//Check if alive
-	return m_isGameAlive;
-}
-
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::LoadGameMaterials()
 {
@@ -1786,6 +1741,8 @@ void Game::CreateInitialLight()
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::CreateInitialMeshes()
 {
+	PROFILE_SCOPE("Game::CreateInitialMeshes");
+
 
 	//Meshes for A4
 	CPUMesh mesh;
@@ -1830,14 +1787,14 @@ void Game::CreateInitialMeshes()
 	m_capsuleModel = Matrix44::IDENTITY;
 	m_capsuleModel = Matrix44::MakeFromEuler(Vec3(-90.f, 0.f, 0.f));
 
-	m_pxCube = new GPUMesh(g_renderContext);
-	m_pxSphere = new GPUMesh(g_renderContext);
-	m_pxConvexMesh = new GPUMesh(g_renderContext);
-	m_pxCapMesh = new GPUMesh(g_renderContext);
 
 	m_carModel = g_renderContext->CreateOrGetMeshFromFile(m_carMeshPath);
 	m_wheelModel = g_renderContext->CreateOrGetMeshFromFile(m_wheelMeshPath);
 	m_wheelFlippedModel = g_renderContext->CreateOrGetMeshFromFile(m_wheelFlippedMeshPath);
+
+	//Resolved once so drawing the cars never goes through the material lookup by name
+	m_carMaterial = g_renderContext->CreateOrGetMaterialFromFile(m_carModel->GetDefaultMaterialName());
+	m_wheelMaterial = g_renderContext->CreateOrGetMaterialFromFile(m_wheelModel->GetDefaultMaterialName());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -1904,3 +1861,4 @@ void Game::UpdateMouseInputs(float deltaTime)
 	//m_camEuler.y -= static_cast<float>(mouseRelativePos.x);
 	//m_camEuler.x -= static_cast<float>(mouseRelativePos.y);
 }
+
@@ -1,18 +1,28 @@
 //------------------------------------------------------------------------------------------------------------------------------
 #pragma once
 //Engine Systems
-#include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Matrix44.hpp"
+#include "Engine/Math/Vec2.hpp"
 #include "Engine/Math/Vertex_PCU.hpp"
-#include "Engine/Renderer/Material.hpp"
-#include "Engine/Renderer/SpriteSheet.hpp"
-#include "Engine/Renderer/IsoSpriteDefenition.hpp"
 //Game Systems
-#include "Game/CarCamera.hpp"
 #include "Game/CarController.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/InputLatencyTracker.hpp"
+#include "Game/PhysXCookedConvexCache.hpp"
+#include "Game/PhysXInstanceBatch.hpp"
+#include "Game/PhysXPoolAllocator.hpp"
+#include "Game/PhysXPoseSnapshot.hpp"
+#include "Game/PhysXProfilerBridge.hpp"
+#include "Game/PhysXSceneSnapshot.hpp"
+#include "Game/PhysXStatsRecorder.hpp"
+#include "Game/ProjectilePool.hpp"
+#include "Game/PhysXRenderProxyCache.hpp"
+#include "Game/VehicleArchetype.hpp"
+#include "Game/VehicleDescriptor.hpp"
+#include "Game/VehicleInputRecording.hpp"
+#include "Game/VehicleManager.hpp"
 //Third Party
-#include "extensions/PxDefaultAllocator.h"
 #include "extensions/PxDefaultCpuDispatcher.h"
 #include "extensions/PxDefaultErrorCallback.h"
 #include "PxFoundation.h"
@@ -24,6 +34,7 @@
 using namespace physx; 
 
 //------------------------------------------------------------------------------------------------------------------------------
+//Render types stay forward declared, the headless build compiles GameSimulation.cpp without the renderer
 class Texture;
 class BitmapFont;
 class TextureView;
@@ -33,14 +44,49 @@ class SpriteAnimDefenition;
 class CPUMesh;
 class GPUMesh;
 class Model;
+class Material;
+class SpriteSheet;
+class IsoSpriteDefenition;
+class CarCamera;
+class PhysXBulkSpawner;
+class VehicleSpline;
+
+struct SceneBenchmarkCase;
 
 struct Camera;
 
+//------------------------------------------------------------------------------------------------------------------------------
+// Unit mesh drawn once per PhysX shape instance. Boxes and spheres share one mesh scaled per instance, capsules need one
+// per radius and half height since the hemispheres can't be scaled independently of the cylinder, and convex meshes need
+// one per PxConvexMesh
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXUnitMesh
+{
+	int									m_geometryType = 0;
+	bool								m_isSleeping = false;
+	float								m_radius = 0.f;
+	float								m_halfHeight = 0.f;
+	//Only set for convex meshes, which are triangulated once per PxConvexMesh in local space
+	const PxConvexMesh*					m_convexMesh = nullptr;
+	GPUMesh*							m_mesh = nullptr;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eVehicleInputRecordingAction
+{
+	INPUT_RECORDING_ACTION_NONE,
+	INPUT_RECORDING_ACTION_START_RECORDING,
+	INPUT_RECORDING_ACTION_STOP_RECORDING,
+	INPUT_RECORDING_ACTION_START_REPLAY,
+	INPUT_RECORDING_ACTION_STOP_REPLAY
+};
+
 //------------------------------------------------------------------------------------------------------------------------------
 class Game
 {
 public:
 	Game();
+	explicit Game(bool isHeadless);
 	~Game();
 	
 	static bool TestEvent(EventArgs& args);
@@ -49,8 +95,13 @@ public:
 	static bool ToggleLight3(EventArgs& args);
 	static bool ToggleLight4(EventArgs& args);
 	static bool ToggleAllPointLights(EventArgs& args);
+	static bool PrintPhysXMemory(EventArgs& args);
+	static bool StartProfileCapture(EventArgs& args);
 
 	void								StartUp();
+	void								StartUpHeadless();
+	//Headless scene with a single builder in place of the vehicle scene, see SceneBenchmark
+	void								StartUpBenchmark(const SceneBenchmarkCase& benchmarkCase);
 	
 	void								SetupMouseData();
 	void								SetupCameras();
@@ -62,14 +113,31 @@ public:
 	void								CreateInitialLight();
 	void								SetStartupDebugRenderObjects();
 	void								SetupPhysX();
-
-	void								CreatePhysXVehicleBoxWall();
-	void								CreateObstacleWall(const int numHorizontalBoxes, const int numVerticalBoxes, const float boxSize, const PxVec3& pos, const PxQuat& quat);
-	void								CreatePhysXVehicleRamp();
-	void								CreatePhysXVehicleObstacles();
+	void								BuildPhysXScene();
+	void								BuildBenchmarkScene(const SceneBenchmarkCase& benchmarkCase);
+	PxU32								GetSceneBuildKey() const;
+	//Printed straight away headless, queued for the dev console otherwise
+	void								PrintPhysXSetupReport(const char* report);
+	void								PrintQueuedConsoleReports();
+	void								ReportConvexCacheStats();
+	void								SetupVehicles();
+	//Steers every simulated vehicle with a LOD spline along it, kinematic ones already follow it
+	static void							SteerRouteVehicles(VehicleManager& vehicleManager, float throttle);
+	void								CaptureInitialPoses();
+	void								SetupProjectilePool();
+	void								UpdateProjectiles(float deltaTime);
+
+	void								CreatePhysXVehicleBoxWall(PhysXBulkSpawner& spawner);
+	void								CreateObstacleWall(PhysXBulkSpawner& spawner, const int numHorizontalBoxes, const int numVerticalBoxes, const float boxSize, const PxVec3& pos, const PxQuat& quat);
+	void								CreatePhysXVehicleRamp(PhysXBulkSpawner& spawner);
+	PxConvexMesh*						CreateWedgeConvexMesh(const PxVec3& halfExtents, PxPhysics& physX, PxCooking& pxCooking);
+	void								CreatePhysXVehicleObstacles(PhysXBulkSpawner& spawner);
+	void								CreateBulkObstacleField(PhysXBulkSpawner& spawner, int numObstacles);
+	static PxFilterData					GetObstacleSimFilterData();
+	static PxFilterData					GetDrivableQueryFilterData();
 	void								CreatePhysXArticulationChain();
 	void								CreatePhysXChains(const Vec3& position, int length, const PxGeometry& geometry, float separation);
-	void								CreatePhysXConvexHull();
+	void								CreatePhysXConvexHull(const Vec3& position = Vec3(0.f, 10.f, 0.f));
 	void								CreatePhysXStack(const Vec3& position, uint size, float halfExtent);
 
 	void								HandleKeyPressed(unsigned char keyCode);
@@ -79,19 +147,22 @@ public:
 	bool								HandleMouseScroll(float wheelDelta);
 
 	void								DebugEnabled();
+	//Windowed teardown, frees the render resources and then the simulation
 	void								Shutdown();
+	//Everything the headless build created, also run by the destructor
+	void								ShutdownSimulation();
 
 	void								Render() const;
 	void								RenderUsingMaterial() const;
 	
 	void								RenderPhysXScene() const;
-	void								RenderPhysXCar() const;
-	void								RenderPhysXActors(const std::vector<PxRigidActor*> actors, int numActors, Rgba& color) const;
+	void								RenderPhysXCar(const PxVehicleDrive4W& vehicle, bool isPlayerCar) const;
+	void								RenderPhysXActors() const;
 	Rgba								GetColorForGeometry(int type, bool isSleeping) const;
-	void								AddMeshForPxCube(CPUMesh& boxMesh, const PxRigidActor& actor, const PxShape& shape, const Rgba& color) const;
-	void								AddMeshForPxSphere(CPUMesh& sphereMesh, const PxRigidActor& actor, const PxShape& shape, const Rgba& color) const;
-	void								AddMeshForPxCapsule(CPUMesh& capMesh, const PxRigidActor& actor, const PxShape& shape, const Rgba& color) const;
-	void								AddMeshForConvexMesh(CPUMesh& cvxMesh, const PxRigidActor& actor, const PxShape& shape, const Rgba& color) const;
+	int									GetOrCreatePhysXUnitMesh(int type, float radius, float halfHeight, const PxConvexMesh* convexMesh = nullptr);
+	void								BuildPhysXInstances();
+	void								AddMeshForConvexMesh(CPUMesh& cvxMesh, const PxConvexMesh& convexMesh, const Rgba& color) const;
+	void								UpdateCarColliderDebugMesh();
 	
 	void								RenderIsoSprite() const;
 	void								DebugRenderToScreen() const;
@@ -100,7 +171,33 @@ public:
 	void								PostRender();
 	
 	void								Update( float deltaTime );
+	void								FixedUpdate( float fixedDeltaTime );
+	void								PostPhysicsStep();
+	//Samples the scene statistics for the step that was just fetched
+	void								RecordPhysXStats(float frameSeconds);
+	void								SetPhysicsInterpolation( float alpha );
 	void								UpdatePhysXCar( float deltaTime );
+	void								ProcessQueuedInputRecordingAction(float fixedDeltaTime);
+	void								UpdateVehicles( float deltaTime );
+	//Input recording and replay both reset the scene first, so no step may be in flight
+	void								StartInputRecording();
+	bool								StopInputRecording(const std::string& filePath);
+	//A fixed step size rejects recordings made at any other step, 0 leaves applying the recorded step sizes to the caller
+	bool								StartInputReplay(const std::string& filePath, float fixedStepSeconds);
+	void								StopInputReplay();
+	bool								IsReplayingInput() const { return m_inputRecording.GetMode() == VEHICLE_INPUT_REPLAYING; }
+	//Drives the player car from the replay. Returns the recorded step size, or 0 once the replay has run out
+	float								ApplyReplayedInput();
+	void								RecordPlayerInput(float stepSeconds);
+	//Call after every fetched step while recording or replaying
+	void								UpdateInputRecordingHash();
+	const VehicleInputRecording&		GetInputRecording() const { return m_inputRecording; }
+	//Puts every actor and vehicle back where CaptureInitialPoses found them. No step may be in flight
+	void								ResetScene();
+	//Queued and fired in FixedUpdate, when no step can be in flight
+	void								QueueProjectile(const PxTransform& pose, const PxVec3& velocity);
+	const ProjectilePool&				GetProjectilePool() const { return m_projectilePool; }
+	double								GetLastSceneResetSeconds() const { return m_lastSceneResetSeconds; }
 	void								UpdateCarCamera(float deltaTime);
 	void								UpdateImGUI();
 	void								UpdateImGUIPhysXWidget();
@@ -108,17 +205,53 @@ public:
 	void								UpdateLightPositions();
 	
 	bool								IsAlive();
+	bool								IsHeadless() const { return m_isHeadless; }
+	CarController*						GetCarController() const { return m_carController; }
+	VehicleManager*						GetVehicleManager() const { return m_vehicleManager; }
+	const VehicleArchetypeRegistry&		GetVehicleArchetypes() const { return m_vehicleArchetypes; }
+	const VehicleSpline*				GetAIVehicleRoute() const { return m_aiVehicleRoute; }
+	//Process private bytes each AI car added when SetupVehicles spawned them, 0 without AI cars
+	int64_t								GetBytesPerAIVehicle() const { return m_bytesPerAIVehicle; }
+	InputLatencyTracker&				GetInputLatencyTracker() { return m_inputLatency; }
+	const PhysXStatsRecorder&			GetPhysXStats() const { return m_physXStats; }
 private:
 	bool								m_isGameAlive = false;
+	bool								m_isHeadless = false;
 	bool								m_consoleDebugOnce = false;
 	bool								m_devConsoleSetup = false;
 	bool								m_isDebugSetup = false;
 	float								m_cameraSpeed = 0.3f; 
 
 	CarController*						m_carController = nullptr;
+	VehicleManager*						m_vehicleManager = nullptr;
+	//Outlives m_vehicleManager, released in Shutdown once the vehicles are gone
+	VehicleArchetypeRegistry			m_vehicleArchetypes;
+	int64_t								m_bytesPerAIVehicle = 0;
+	InputLatencyTracker					m_inputLatency;
+	//About a minute of steps at 60Hz
+	PhysXStatsRecorder					m_physXStats{ 3600 };
+	float								m_lastFrameSeconds = 0.f;
+
+	VehicleInputRecording				m_inputRecording;
+	//ImGui requests wait for the next FixedUpdate, the scene reset needs the step finished
+	eVehicleInputRecordingAction		m_queuedInputRecordingAction = INPUT_RECORDING_ACTION_NONE;
+	PhysXRenderProxyCache				m_renderProxies;
+	//Cooked ramp and hull streams under Run/Data/Cache, reused across starts
+	PhysXCookedConvexCache				m_cookedConvexCache{ "Data/Cache/" };
+	//Everything BuildPhysXScene adds, loaded from or saved to m_sceneSnapshotPath
+	PhysXSceneSnapshot					m_sceneSnapshot;
+	//Initial state for in-place resets
+	PhysXPoseSnapshot					m_poseSnapshot;
+	double								m_lastSceneResetSeconds = 0.0;
+
+	ProjectilePool						m_projectilePool;
+	std::vector<PxTransform>			m_queuedProjectilePoses;
+	std::vector<PxVec3>					m_queuedProjectileVelocities;
+	std::vector<std::string>			m_queuedConsoleReports;
 
 public:
-	SoundID								m_testAudioID = NULL;
+	//A SoundID, held as its underlying type so the header stays clear of the AudioSystem
+	size_t								m_testAudioID = 0;
 	
 	TextureView*						m_textureTest = nullptr;
 	TextureView*						m_boxTexture = nullptr;
@@ -199,6 +332,8 @@ public:
 	//Material
 	Material*							m_testMaterial = nullptr;
 	Material*							m_defaultMaterial = nullptr;
+	Material*							m_carMaterial = nullptr;
+	Material*							m_wheelMaterial = nullptr;
 	bool								m_useMaterial = true;
 
 	float								m_emissiveFactor = 0.f;
@@ -229,14 +364,23 @@ public:
 
 	float								m_anotherTestTempHackStackZ = 10.0f;
 	float								m_dynamicObjectDensity = 100.f;
+	int									m_projectilePoolSize = 64;
+	float								m_projectileLifetime = 10.f;
+	bool								m_useSceneSnapshot = true;
+	std::string							m_sceneSnapshotPath = "Data/Cache/VehicleScene.pxsnap";
+	unsigned int						m_convexHullSeed = 7;
 	PxRigidActor*						m_pxConvexActor = nullptr;
 	PxMaterial*							m_pxConvexMaterial = nullptr;
 
 	//PhysX Meshes
-	GPUMesh*							m_pxCube = nullptr;
-	GPUMesh*							m_pxSphere = nullptr;
-	GPUMesh*							m_pxConvexMesh = nullptr;
-	GPUMesh*							m_pxCapMesh = nullptr;
+	GPUMesh*							m_carColliderDebugMesh = nullptr;
+
+	//Unit meshes come in awake/sleeping pairs, the sleeping mesh is always at slot + 1
+	std::vector<PhysXUnitMesh>			m_pxUnitMeshes;
+	PhysXInstanceBatch					m_pxInstanceBatch;
+	//Per render shape awake slot, rebuilt when the proxy cache generation changes
+	std::vector<int>					m_pxShapeMeshSlots;
+	int									m_pxShapeSlotsGeneration = -1;
 
 	//For joints
 	float								m_defaultConeFreedomY = 45.f;
@@ -268,6 +412,41 @@ public:
 
 	bool								m_debugViewCarCollider = false;
 
+	//AI traffic, stepped in the same batch as the player car
+	int									m_numAIVehicles = 0;
+	//Sleeping cones added to the scene build through the bulk spawner
+	int									m_numBulkObstacles = 0;
+	float								m_aiVehicleSpacing = 8.f;
+	float								m_aiVehicleThrottle = 0.3f;
+	//Looped "x,z;x,z;..." route the AI cars drive round and follow while kinematic. Empty keeps them on a straight throttle
+	std::string							m_aiVehicleRoutePoints;
+	VehicleSpline*						m_aiVehicleRoute = nullptr;
+	int									m_vehicleUpdateThreads = 1;
+	int									m_vehiclesPerChunk = 16;
+	float								m_vehicleRaycastDistance = 60.f;
+	int									m_vehicleCachedQuerySteps = 4;
+	//Simulation LOD, 0 for either budget leaves it uncapped
+	float								m_vehicleKinematicDistance = 150.f;
+	float								m_vehicleLODHysteresis = 5.f;
+	//Reduced tier cars query every other step
+	int									m_vehicleReducedQuerySteps = 1;
+	int									m_vehicleMaxFullLOD = 0;
+	int									m_vehicleMaxReducedLOD = 0;
+
+	std::string							m_inputLatencyExportPath = "InputLatency.csv";
+	std::string							m_physXStatsCSVPath = "PhysXStats.csv";
+	std::string							m_physXStatsBinaryPath = "PhysXStats.pxstats";
+	std::string							m_inputRecordingPath = "InputRecording.pxinput";
+
+	//Handling for the player and AI cars
+	std::string							m_vehicleDescriptorPath = "Data/Gameplay/Vehicle.xml";
+	VehicleDescriptor					m_vehicleDescriptor;
+
+	PhysXProfilerBridge					m_physXProfilerBridge;
+
+	//Refilled each frame the PhysX memory panel is open
+	std::vector<PhysXAllocationTagStats>	m_physXMemoryStats;
+
 	//------------------------------------------------------------------------------------------------------------------------------
 	// Iso Sprite Test Variables
 	//------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,961 @@
+//------------------------------------------------------------------------------------------------------------------------------
+// Game members the headless host needs: scene building, vehicles, projectiles, resets and input recording. Nothing in this
+// file may reach the renderer, audio, input or dev console, the headless build compiles it without Game.cpp
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/Game.hpp"
+//Engine Systems
+#include "Engine/Math/Matrix44.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
+//Game Systems
+#include "Game/PhysXBulkSpawner.hpp"
+#include "Game/PlatformMemory.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/SceneBenchmark.hpp"
+#include "Game/VehicleSpline.hpp"
+//Standard
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Bump whenever BuildPhysXScene changes so stale scene snapshots are rebuilt instead of loaded
+const PxU32 gSceneBuildVersion = 2;
+
+//Route following AI cars steer for the point this far ahead of them, at full lock when it is this many radians off the nose
+const float gAIRouteLookAhead = 12.f;
+const float gAIRouteSteerGain = 1.5f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Engine time is built on the Win32 performance counter, which the headless build doesn't have
+//------------------------------------------------------------------------------------------------------------------------------
+static double GetSimulationTimeSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Game::Game()
+	: Game(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Game::Game(bool isHeadless)
+{
+	m_isGameAlive = true;
+	m_isHeadless = isHeadless;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Game::~Game()
+{
+	m_isGameAlive = false;
+	//The windowed build calls Shutdown first, which also frees the render resources
+	ShutdownSimulation();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StartUpHeadless()
+{
+	//Only the simulation side of StartUp. No cameras, shaders, textures, meshes or lights are created
+	m_physXProfilerBridge.Install();
+
+	m_carController = new CarController();
+	SetupPhysX();
+	SetupVehicles();
+	CaptureInitialPoses();
+	SetupProjectilePool();
+
+	//There is no render proxy cache to turn this on, the stats recorder still wants the active actor count
+	g_PxPhysXSystem->GetPhysXScene()->setFlag(PxSceneFlag::eENABLE_ACTIVE_ACTORS, true);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StartUpBenchmark(const SceneBenchmarkCase& benchmarkCase)
+{
+	//The player car always exists, the vehicle builder only adds AI traffic on top of it
+	m_numAIVehicles = benchmarkCase.m_builder == SCENE_BENCHMARK_VEHICLES ? benchmarkCase.m_size : 0;
+
+	m_physXProfilerBridge.Install();
+
+	m_carController = new CarController();
+	BuildBenchmarkScene(benchmarkCase);
+	SetupVehicles();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SetupPhysX()
+{
+	PROFILE_SCOPE("Game::SetupPhysX");
+
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxScene* pxScene = g_PxPhysXSystem->GetPhysXScene();
+	PxMaterial* pxMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	char report[256];
+	double setupStart = GetSimulationTimeSeconds();
+
+	if (m_useSceneSnapshot && m_sceneSnapshot.Load(m_sceneSnapshotPath, GetSceneBuildKey(), *pxScene, *physX, *pxMaterial))
+	{
+		snprintf(report, sizeof(report), "Scene snapshot: loaded %d actors (%d objects, %zu bytes) in %.2f ms", m_sceneSnapshot.GetNumActors(),
+			m_sceneSnapshot.GetNumObjects(), m_sceneSnapshot.GetSerializedSize(), (GetSimulationTimeSeconds() - setupStart) * 1000.0);
+		PrintPhysXSetupReport(report);
+		return;
+	}
+
+	m_sceneSnapshot.BeginCapture(*pxScene);
+	BuildPhysXScene();
+	m_sceneSnapshot.EndCapture(*pxScene, *physX, *pxMaterial);
+
+	double buildSeconds = GetSimulationTimeSeconds() - setupStart;
+
+	ReportConvexCacheStats();
+
+	if (m_useSceneSnapshot)
+	{
+		bool isSaved = m_sceneSnapshot.Save(m_sceneSnapshotPath, GetSceneBuildKey(), *physX, *pxMaterial);
+		snprintf(report, sizeof(report), "Scene snapshot: built %d actors in %.2f ms, %s %s", m_sceneSnapshot.GetNumActors(), buildSeconds * 1000.0,
+			isSaved ? "saved to" : "failed to save", m_sceneSnapshotPath.c_str());
+		PrintPhysXSetupReport(report);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::BuildPhysXScene()
+{
+	/*
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxScene* pxScene = g_PxPhysXSystem->GetPhysXScene();
+
+	PxMaterial* pxMat;
+	pxMat = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	//Add things to your scene
+	PxRigidStatic* groundPlane = PxCreatePlane(*physX, PxPlane(0, 1, 0, 0), *pxMat);
+	pxScene->addActor(*groundPlane);
+
+	for (int setIndex = 0; setIndex < 5; setIndex++)
+	{
+		CreatePhysXStack(Vec3(0, 0, m_anotherTestTempHackStackZ -= 10.f), 10, 2.f);
+	}
+
+	CreatePhysXConvexHull();
+	CreatePhysXChains(m_chainPosition, m_chainLength, PxBoxGeometry(2.0f, 0.5f, 0.5f), m_chainSeperation);
+	CreatePhysXArticulationChain();
+	*/
+
+	//Vehicle SDK only. Everything is queued on the spawner and inserted in one go
+	double spawnStart = GetSimulationTimeSeconds();
+	PhysXBulkSpawner spawner(*g_PxPhysXSystem->GetPhysXSDK());
+
+	CreatePhysXVehicleObstacles(spawner);
+	CreatePhysXVehicleRamp(spawner);
+	CreatePhysXVehicleBoxWall(spawner);
+	CreateBulkObstacleField(spawner, m_numBulkObstacles);
+
+	spawner.Flush(*g_PxPhysXSystem->GetPhysXScene());
+
+	char report[256];
+	snprintf(report, sizeof(report), "Bulk spawn: %d actors sharing %d shapes in %.2f ms", spawner.GetNumActorsFlushed(), spawner.GetNumSharedShapes(),
+		(GetSimulationTimeSeconds() - spawnStart) * 1000.0);
+	PrintPhysXSetupReport(report);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::BuildBenchmarkScene(const SceneBenchmarkCase& benchmarkCase)
+{
+	PROFILE_SCOPE("Game::BuildBenchmarkScene");
+
+	PhysXBulkSpawner spawner(*g_PxPhysXSystem->GetPhysXSDK());
+
+	switch (benchmarkCase.m_builder)
+	{
+	case SCENE_BENCHMARK_STACKS:
+	{
+		for (int stackIndex = 0; stackIndex < benchmarkCase.m_count; ++stackIndex)
+		{
+			CreatePhysXStack(Vec3(0.f, 0.f, stackIndex * -10.f), (uint)benchmarkCase.m_size, 2.f);
+		}
+	}
+	break;
+	case SCENE_BENCHMARK_WALL:
+	{
+		CreateObstacleWall(spawner, benchmarkCase.m_size, benchmarkCase.m_count, 1.f, PxVec3(-20.f, 0.f, 0.f), PxQuat(PxIdentity));
+	}
+	break;
+	case SCENE_BENCHMARK_CHAINS:
+	{
+		CreatePhysXChains(m_chainPosition, benchmarkCase.m_size, PxBoxGeometry(2.0f, 0.5f, 0.5f), m_chainSeperation);
+	}
+	break;
+	case SCENE_BENCHMARK_ARTICULATION:
+	{
+		m_numCapsules = benchmarkCase.m_size;
+		CreatePhysXArticulationChain();
+	}
+	break;
+	case SCENE_BENCHMARK_CONVEX_HULLS:
+	{
+		//Same cooked hull every time, laid out on a grid far enough apart that they only land on the ground
+		const int hullsPerRow = 8;
+		for (int hullIndex = 0; hullIndex < benchmarkCase.m_count; ++hullIndex)
+		{
+			CreatePhysXConvexHull(Vec3((hullIndex % hullsPerRow) * 15.f, 10.f, (hullIndex / hullsPerRow) * 15.f + 20.f));
+		}
+	}
+	break;
+	case SCENE_BENCHMARK_VEHICLES:
+	{
+		CreatePhysXVehicleObstacles(spawner);
+	}
+	break;
+	default:
+		break;
+	}
+
+	spawner.Flush(*g_PxPhysXSystem->GetPhysXScene());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxU32 Game::GetSceneBuildKey() const
+{
+	//Anything that changes what BuildPhysXScene creates has to change the key
+	return gSceneBuildVersion * 2654435761u ^ (PxU32)m_numBulkObstacles;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::PrintPhysXSetupReport(const char* report)
+{
+	if (m_isHeadless)
+	{
+		printf("\n >> %s", report);
+	}
+	else
+	{
+		//Game.cpp hands these to the dev console
+		m_queuedConsoleReports.push_back(report);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ReportConvexCacheStats()
+{
+	char report[256];
+	snprintf(report, sizeof(report), "Convex cache: %d hits, %d misses, %.2f ms cooking, %.2f ms loading, %.2f ms saved",
+		m_cookedConvexCache.GetNumHits(), m_cookedConvexCache.GetNumMisses(),
+		m_cookedConvexCache.GetSecondsCooking() * 1000.0, m_cookedConvexCache.GetSecondsLoading() * 1000.0,
+		m_cookedConvexCache.GetSecondsSaved() * 1000.0);
+
+	PrintPhysXSetupReport(report);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SetupVehicles()
+{
+	//A missing file keeps the compiled in defaults, which are the car the vehicle SDK start up builds
+	char report[256];
+	bool isLoaded = m_vehicleDescriptor.LoadFromXml(m_vehicleDescriptorPath);
+	snprintf(report, sizeof(report), "Vehicle descriptor: %s %s", isLoaded ? "loaded" : "using defaults, could not load", m_vehicleDescriptorPath.c_str());
+	PrintPhysXSetupReport(report);
+
+	m_vehicleManager = new VehicleManager(1 + m_numAIVehicles, *g_PxPhysXSystem->GetPhysXScene(), m_vehicleArchetypes);
+	m_vehicleManager->SetDefaultDescriptor(m_vehicleDescriptor);
+	m_carController->RegisterWithVehicleManager(*m_vehicleManager, m_vehicleDescriptor);
+	//The engine built the player's chassis and wheel shapes, everything else comes from the descriptor
+	m_vehicleManager->SetVehicleDescriptor(m_carController->GetVehicleManagerIndex(), m_vehicleDescriptor);
+	m_vehicleManager->SetNumWorkerThreads(m_vehicleUpdateThreads);
+	m_vehicleManager->SetVehiclesPerChunk(m_vehiclesPerChunk);
+	m_vehicleManager->SetQueryLODSettings(m_vehicleRaycastDistance, m_vehicleCachedQuerySteps);
+	m_vehicleManager->SetSimLODSettings(m_vehicleKinematicDistance, m_vehicleLODHysteresis, m_vehicleReducedQuerySteps, m_vehicleMaxFullLOD, m_vehicleMaxReducedLOD);
+
+	//Heights come from the ground under the route, only x and z are given
+	std::vector<PxVec3> routePoints;
+	size_t pointStart = 0;
+	while (pointStart < m_aiVehicleRoutePoints.size())
+	{
+		size_t pointEnd = m_aiVehicleRoutePoints.find(';', pointStart);
+		pointEnd = pointEnd == std::string::npos ? m_aiVehicleRoutePoints.size() : pointEnd;
+
+		float x = 0.f;
+		float z = 0.f;
+		if (sscanf(m_aiVehicleRoutePoints.substr(pointStart, pointEnd - pointStart).c_str(), "%f,%f", &x, &z) == 2)
+		{
+			routePoints.push_back(PxVec3(x, 0.f, z));
+		}
+		pointStart = pointEnd + 1;
+	}
+
+	if (routePoints.size() >= 2)
+	{
+		m_aiVehicleRoute = new VehicleSpline(routePoints, true);
+	}
+	else if (!m_aiVehicleRoutePoints.empty())
+	{
+		snprintf(report, sizeof(report), "AI vehicle route: needs at least two x,z points, got \"%s\"", m_aiVehicleRoutePoints.c_str());
+		PrintPhysXSetupReport(report);
+	}
+
+	//The player registration built the default descriptor's archetype, so the AI cars below only pay for their instances
+	const VehicleArchetype& archetype = m_vehicleManager->GetVehicleArchetype(m_carController->GetVehicleManagerIndex());
+	uint64_t privateBytesBeforeSpawn = PlatformMemory::GetProcessPrivateBytes();
+
+	//AI cars start in rows behind the player and just hold a steady throttle
+	const int carsPerRow = 10;
+	for (int aiIndex = 0; aiIndex < m_numAIVehicles; aiIndex++)
+	{
+		int row = aiIndex / carsPerRow;
+		int column = aiIndex % carsPerRow;
+
+		PxVec3 position((column - carsPerRow * 0.5f) * m_aiVehicleSpacing, 2.5f, -(row + 1) * m_aiVehicleSpacing);
+		int vehicleIndex = m_vehicleManager->SpawnVehicle(PxTransform(position));
+		m_vehicleManager->GetVehicleInputData(vehicleIndex)->setAnalogAccel(m_aiVehicleThrottle);
+		m_vehicleManager->SetLODSpline(vehicleIndex, m_aiVehicleRoute);
+	}
+
+	//Page granular, only a good figure with a few dozen cars or more
+	if (m_numAIVehicles > 0)
+	{
+		m_bytesPerAIVehicle = ((int64_t)PlatformMemory::GetProcessPrivateBytes() - (int64_t)privateBytesBeforeSpawn) / m_numAIVehicles;
+	}
+
+	snprintf(report, sizeof(report), "Vehicle archetypes: %d models, %d AI cars of the default model at %lld bytes each, model built in %.2f ms",
+		m_vehicleArchetypes.GetNumArchetypes(), m_numAIVehicles, (long long)m_bytesPerAIVehicle, archetype.GetBuildSeconds() * 1000.0);
+	PrintPhysXSetupReport(report);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void Game::SteerRouteVehicles(VehicleManager& vehicleManager, float throttle)
+{
+	PROFILE_SCOPE("Game::SteerRouteVehicles");
+
+	for (int vehicleIndex = 0; vehicleIndex < vehicleManager.GetNumVehicles(); ++vehicleIndex)
+	{
+		const VehicleSpline* route = vehicleManager.GetLODSpline(vehicleIndex);
+		if (route == nullptr || vehicleManager.GetSimLOD(vehicleIndex) == VEHICLE_LOD_KINEMATIC)
+		{
+			continue;
+		}
+
+		PxTransform pose = vehicleManager.GetVehicle(vehicleIndex)->getRigidDynamicActor()->getGlobalPose();
+		PxVec3 target = route->GetPosition(route->FindClosestDistance(pose.p) + gAIRouteLookAhead);
+
+		//Same steering as the sweep's test driver, easing off the throttle the harder the turn
+		PxVec3 localToTarget = pose.q.rotateInv(target - pose.p);
+		float steer = PxClamp(-atan2f(localToTarget.x, localToTarget.z) * gAIRouteSteerGain, -1.f, 1.f);
+
+		PxVehicleDrive4WRawInputData* inputData = vehicleManager.GetVehicleInputData(vehicleIndex);
+		inputData->setAnalogSteer(steer);
+		inputData->setAnalogAccel(throttle * (1.f - 0.5f * PxAbs(steer)));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CaptureInitialPoses()
+{
+	double captureStart = GetSimulationTimeSeconds();
+	m_poseSnapshot.Capture(*g_PxPhysXSystem->GetPhysXScene(), *m_vehicleManager);
+
+	char report[256];
+	snprintf(report, sizeof(report), "Pose snapshot: %d actors, %d vehicles captured in %.2f ms", m_poseSnapshot.GetNumActors(),
+		m_poseSnapshot.GetNumVehicles(), (GetSimulationTimeSeconds() - captureStart) * 1000.0);
+	PrintPhysXSetupReport(report);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SetupProjectilePool()
+{
+	//Created after the pose capture, parked projectiles are not part of the initial state
+	m_projectilePool.StartUp(*g_PxPhysXSystem->GetPhysXSDK(), *g_PxPhysXSystem->GetPhysXScene(), *g_PxPhysXSystem->GetDefaultPxMaterial(),
+		PxSphereGeometry(3.f), GetObstacleSimFilterData(), PxFilterData(), m_dynamicObjectDensity, m_projectilePoolSize);
+	m_projectilePool.SetLifetimeSeconds(m_projectileLifetime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::QueueProjectile(const PxTransform& pose, const PxVec3& velocity)
+{
+	m_queuedProjectilePoses.push_back(pose);
+	m_queuedProjectileVelocities.push_back(velocity);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateProjectiles(float deltaTime)
+{
+	m_projectilePool.Update(deltaTime);
+
+	for (int queuedIndex = 0; queuedIndex < (int)m_queuedProjectilePoses.size(); ++queuedIndex)
+	{
+		m_projectilePool.Fire(m_queuedProjectilePoses[queuedIndex], m_queuedProjectileVelocities[queuedIndex]);
+	}
+	m_queuedProjectilePoses.clear();
+	m_queuedProjectileVelocities.clear();
+
+	//Teleports don't show up in the active actor list, so the render proxies are told directly
+	const std::vector<PxRigidDynamic*>& movedActors = m_projectilePool.GetMovedActors();
+	for (int actorIndex = 0; actorIndex < (int)movedActors.size(); ++actorIndex)
+	{
+		m_renderProxies.RefreshActor(*movedActors[actorIndex]);
+	}
+	m_projectilePool.ClearMovedActors();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ResetScene()
+{
+	PROFILE_SCOPE("Game::ResetScene");
+
+	double resetStart = GetSimulationTimeSeconds();
+
+	//The snapshot restores velocities, which kinematic actors don't take
+	m_vehicleManager->ResetSimLOD();
+	m_poseSnapshot.Restore();
+	m_vehicleManager->ResetQueryState();
+	m_renderProxies.SnapToScenePoses();
+
+	m_projectilePool.ParkAll();
+	m_queuedProjectilePoses.clear();
+	m_queuedProjectileVelocities.clear();
+	UpdateProjectiles(0.f);
+
+	//Latency samples in flight belong to the episode that just ended
+	m_inputLatency.Reset();
+
+	m_lastSceneResetSeconds = GetSimulationTimeSeconds() - resetStart;
+
+	if (!m_isHeadless)
+	{
+		char report[256];
+		snprintf(report, sizeof(report), "Scene reset in %.3f ms", m_lastSceneResetSeconds * 1000.0);
+		PrintPhysXSetupReport(report);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreatePhysXVehicleBoxWall(PhysXBulkSpawner& spawner)
+{
+	//Add a wall made of dynamic objects with cuboid shapes for bricks.
+	PxTransform t(PxVec3(-20.f, 0.f, 0.f), PxQuat(-0.000002f, -0.837118f, -0.000004f, 0.547022f));
+	CreateObstacleWall(spawner, 12, 4, 1.0f, t.p, t.q);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreateObstacleWall(PhysXBulkSpawner& spawner, const int numHorizontalBoxes, const int numVerticalBoxes, const float boxSize, const PxVec3& pos, const PxQuat& quat)
+{
+	const PxF32 density = 50.0f;
+
+	const PxF32 sizeX = boxSize;
+	const PxF32 sizeY = boxSize;
+	const PxF32 sizeZ = boxSize;
+
+	const PxVec3 halfExtents(sizeX*0.5f, sizeY*0.5f, sizeZ*0.5f);
+	PxShape* brickShape = spawner.GetSharedShape(PxBoxGeometry(halfExtents), *g_PxPhysXSystem->GetDefaultPxMaterial(), GetObstacleSimFilterData(), GetDrivableQueryFilterData());
+
+	std::vector<PxTransform> brickPoses;
+	brickPoses.reserve(numHorizontalBoxes * numVerticalBoxes);
+
+	const PxF32 spacing = 0.0001f;
+	PxVec3 relPos(0.0f, sizeY / 2, 0.0f);
+	PxF32 offsetX = -(numHorizontalBoxes * (sizeX + spacing) * 0.5f);
+	PxF32 offsetZ = 0.0f;
+
+	for (PxU32 k = 0; k < (PxU32)numVerticalBoxes; k++)
+	{
+		for (PxU32 i = 0; i < (PxU32)numHorizontalBoxes; i++)
+		{
+			relPos.x = offsetX + (sizeX + spacing)*i;
+			relPos.z = offsetZ;
+			brickPoses.push_back(PxTransform(pos + quat.rotate(relPos), quat));
+		}
+
+		if (0 == (k % 2))
+		{
+			offsetX += sizeX / 2;
+		}
+		else
+		{
+			offsetX -= sizeX / 2;
+		}
+		relPos.y += (sizeY + spacing);
+	}
+
+	spawner.AddDynamics(*brickShape, &brickPoses[0], (int)brickPoses.size(), density);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreatePhysXVehicleRamp(PhysXBulkSpawner& spawner)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxCooking* pxCooking = g_PxPhysXSystem->GetPhysXCookingModule();
+	PxMaterial* pxMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	//Add a really big ramp to jump over the car stack.
+	{
+		PxVec3 halfExtentsRamp(5.0f, 1.9f, 7.0f);
+		PxConvexMeshGeometry geomRamp(CreateWedgeConvexMesh(halfExtentsRamp, *physX, *pxCooking));
+		PxShape* rampShape = spawner.GetSharedShape(geomRamp, *pxMaterial, GetObstacleSimFilterData(), GetDrivableQueryFilterData());
+
+		Matrix44 bigRampModel;
+		bigRampModel.MakeTranslation3D(Vec3(-10.f, 0.f, 0.f));
+		Matrix44 rotation = Matrix44::MakeYRotationDegrees(180.f);
+		bigRampModel = bigRampModel.AppendMatrix(rotation);
+
+		PxTransform tRamp(g_PxPhysXSystem->VecToPxVector(bigRampModel.GetTBasis()), g_PxPhysXSystem->MakeQuaternionFromMatrix(bigRampModel) );
+		spawner.AddStatics(*rampShape, &tRamp, 1);
+	}
+
+	//Add two ramps side by side with a gap in between
+	{
+		PxVec3 halfExtents(3.0f, 1.5f, 3.5f);
+		PxConvexMeshGeometry geometry(CreateWedgeConvexMesh(halfExtents, *physX, *pxCooking));
+		PxShape* rampShape = spawner.GetSharedShape(geometry, *pxMaterial, GetObstacleSimFilterData(), GetDrivableQueryFilterData());
+
+		PxTransform rampPoses[2] =
+		{
+			PxTransform(PxVec3(-60.f, 0.f, 0.f), PxQuat(0.000013f, -0.406322f, 0.000006f, 0.913730f)),
+			PxTransform(PxVec3(-80, 0.f, 0.f), PxQuat(0.000013f, -0.406322f, 0.000006f, 0.913730f))
+		};
+		spawner.AddStatics(*rampShape, rampPoses, 2);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxConvexMesh* Game::CreateWedgeConvexMesh(const PxVec3& halfExtents, PxPhysics& physX, PxCooking& pxCooking)
+{
+	//Same wedge PhysXSystem cooks, built here so the points can be hashed for the cooked mesh cache
+	PxVec3 wedgePoints[6] =
+	{
+		PxVec3(-halfExtents.x, -halfExtents.y, -halfExtents.z),
+		PxVec3(-halfExtents.x, -halfExtents.y, +halfExtents.z),
+		PxVec3(-halfExtents.x, +halfExtents.y, -halfExtents.z),
+		PxVec3(+halfExtents.x, -halfExtents.y, -halfExtents.z),
+		PxVec3(+halfExtents.x, -halfExtents.y, +halfExtents.z),
+		PxVec3(+halfExtents.x, +halfExtents.y, -halfExtents.z)
+	};
+
+	return m_cookedConvexCache.CreateConvexMesh(wedgePoints, 6, 255, physX, pxCooking);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreatePhysXVehicleObstacles(PhysXBulkSpawner& spawner)
+{
+	PxMaterial* pxMat;
+	pxMat = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	const float boxHalfHeight = 1.0f;
+	const float boxZ = 30.0f;
+	PxTransform t(PxVec3(0.f, boxHalfHeight, boxZ), PxQuat(PxIdentity));
+
+	//Only the wheels hit this box
+	PxFilterData simFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_WHEEL, PxPairFlag::eMODIFY_CONTACTS | PxPairFlag::eDETECT_CCD_CONTACT, 0);
+	PxShape* boxShape = spawner.GetSharedShape(PxBoxGeometry(PxVec3(3.0f, boxHalfHeight, 3.0f)), *pxMat, simFilterData, GetDrivableQueryFilterData());
+	spawner.AddStatics(*boxShape, &t, 1);
+
+	const int numPlanks = 64;
+	PxTransform plankPoses[numPlanks];
+	for (PxU32 i = 0; i < numPlanks; i++)
+	{
+		plankPoses[i] = PxTransform(PxVec3(20.f + i * 0.01f, 2.0f + i * 0.25f, 20.0f + i * 0.025f), PxQuat(PxPi*0.5f, PxVec3(0, 1, 0)));
+	}
+
+	PxShape* plankShape = spawner.GetSharedShape(PxBoxGeometry(PxVec3(0.08f, 0.25f, 1.0f)), *pxMat, GetObstacleSimFilterData(), GetDrivableQueryFilterData());
+	spawner.AddDynamics(*plankShape, plankPoses, numPlanks, 30.0f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreateBulkObstacleField(PhysXBulkSpawner& spawner, int numObstacles)
+{
+	if (numObstacles <= 0)
+	{
+		return;
+	}
+
+	//Cones in rows off to the side of the ramps, resting on the ground and asleep until something drives into them
+	const int conesPerRow = 100;
+	const float coneSpacing = 1.5f;
+	const PxVec3 coneHalfExtents(0.25f, 0.5f, 0.25f);
+	const PxVec3 fieldOrigin(40.f, coneHalfExtents.y, 40.f);
+
+	std::vector<PxTransform> conePoses;
+	conePoses.reserve(numObstacles);
+	for (int coneIndex = 0; coneIndex < numObstacles; ++coneIndex)
+	{
+		PxVec3 offset((coneIndex % conesPerRow) * coneSpacing, 0.f, (coneIndex / conesPerRow) * coneSpacing);
+		conePoses.push_back(PxTransform(fieldOrigin + offset));
+	}
+
+	PxShape* coneShape = spawner.GetSharedShape(PxBoxGeometry(coneHalfExtents), *g_PxPhysXSystem->GetDefaultPxMaterial(), GetObstacleSimFilterData(), GetDrivableQueryFilterData());
+	spawner.AddDynamics(*coneShape, &conePoses[0], numObstacles, 20.f, true);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxFilterData Game::GetObstacleSimFilterData()
+{
+	return PxFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_OBSTACLE_AGAINST, PxPairFlag::eMODIFY_CONTACTS | PxPairFlag::eDETECT_CCD_CONTACT, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxFilterData Game::GetDrivableQueryFilterData()
+{
+	PxFilterData qryFilterData;
+	setupDrivableSurface(qryFilterData);
+	return qryFilterData;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreatePhysXArticulationChain()
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxMaterial* material = g_PxPhysXSystem->GetDefaultPxMaterial();
+	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
+	PxArticulation* articulation = physX->createArticulation();
+
+	// Stabilization can create artifacts on jointed objects so we just disable it
+	articulation->setStabilizationThreshold(0.0f);
+
+	articulation->setMaxProjectionIterations(16);
+	articulation->setSeparationTolerance(0.001f);
+
+	const float radius = 0.5f * m_articulationScale;
+	const float halfHeight = 1.0f * m_articulationScale;
+
+	const PxVec3 initPos(50.0f, 24.0f, 0.0f);
+	PxVec3 pos = initPos;
+	PxShape* capsuleShape = physX->createShape(PxCapsuleGeometry(radius, halfHeight), *material);
+	PxArticulationLink* firstLink = nullptr;
+	PxArticulationLink* parent = nullptr;
+
+	const bool overlappingLinks = true;	// Change this for another kind of rope
+
+	articulation->setSolverIterationCounts(16);
+
+	// Create rope
+	for (int linkIndex = 0; linkIndex < m_numCapsules; linkIndex++)
+	{
+		PxArticulationLink* link = articulation->createLink(parent, PxTransform(pos));
+		if (!firstLink)
+			firstLink = link;
+
+		link->attachShape(*capsuleShape);
+		PxRigidBodyExt::setMassAndUpdateInertia(*link, m_capsuleMass);
+
+		link->setLinearDamping(m_linkLinearDamping);
+		link->setAngularDamping(m_linkAngularDamping);
+
+		link->setMaxAngularVelocity(m_linkMaxAngularVelocity);
+		link->setMaxLinearVelocity(m_linkMaxLinearVelocity);
+
+		PxArticulationJointBase* joint = link->getInboundJoint();
+
+		if (joint)	// Will be null for root link
+		{
+			if (overlappingLinks)
+			{
+				joint->setParentPose(PxTransform(PxVec3(halfHeight, 0.0f, 0.0f)));
+				joint->setChildPose(PxTransform(PxVec3(-halfHeight, 0.0f, 0.0f)));
+			}
+			else
+			{
+				joint->setParentPose(PxTransform(PxVec3(radius + halfHeight, 0.0f, 0.0f)));
+				joint->setChildPose(PxTransform(PxVec3(-radius - halfHeight, 0.0f, 0.0f)));
+			}
+		}
+
+		if (overlappingLinks)
+			pos.x += (radius + halfHeight * 2.0f);
+		else
+			pos.x += (radius + halfHeight) * 2.0f;
+		parent = link;
+	}
+
+	//Attach large & heavy box at the end of the rope
+	{
+		PxShape* boxShape = physX->createShape(PxBoxGeometry(m_weightSize, m_weightSize, m_weightSize), *material);
+
+		pos.x -= (radius + halfHeight) * 2.0f;
+		pos.x += (radius + halfHeight) + m_weightSize;
+
+		PxArticulationLink* link = articulation->createLink(parent, PxTransform(pos));
+
+		link->setLinearDamping(m_linkLinearDamping);
+		link->setAngularDamping(m_linkAngularDamping);
+		link->setMaxAngularVelocity(m_linkMaxAngularVelocity);
+		link->setMaxLinearVelocity(m_linkMaxLinearVelocity);
+
+		link->attachShape(*boxShape);
+		PxRigidBodyExt::setMassAndUpdateInertia(*link, m_weightMass);
+
+		PxArticulationJointBase* joint = link->getInboundJoint();
+
+		if (joint)	// Will be null for root link
+		{
+			joint->setParentPose(PxTransform(PxVec3(radius + halfHeight, 0.0f, 0.0f)));
+			joint->setChildPose(PxTransform(PxVec3(-m_weightSize, 0.0f, 0.0f)));
+		}
+	}
+	scene->addArticulation(*articulation);
+
+
+	// Attach articulation to static world
+	PxShape* anchorShape = physX->createShape(PxSphereGeometry(0.05f), *material);
+	PxRigidStatic* anchor = PxCreateStatic(*physX, PxTransform(initPos), *anchorShape);
+	scene->addActor(*anchor);
+	PxSphericalJoint* sphericalJoint = PxSphericalJointCreate(*physX, anchor, PxTransform(PxVec3(0.0f)), firstLink, PxTransform(PxVec3(0.0f)));
+	PX_UNUSED(sphericalJoint);
+
+	// Create obstacle
+	PxShape* boxShape = physX->createShape(PxBoxGeometry(1.0f, 0.1f, 2.0f), *material);
+	PxRigidStatic* obstacle = PxCreateStatic(*physX, PxTransform(initPos + PxVec3(10.0f, -3.0f, 0.0f)), *boxShape);
+	scene->addActor(*obstacle);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreatePhysXChains(const Vec3& position, int length, const PxGeometry& geometry, float separation)
+{
+	Vec3 offsetZ = Vec3(0.f, 0.f, 20.f);
+	Vec3 offsetY = Vec3(0.f, 20.f, 0.f);
+
+	g_PxPhysXSystem->CreateSimpleSphericalChain(position, length, geometry, separation);
+	g_PxPhysXSystem->CreateLimitedSphericalChain(position + offsetY, length, geometry, separation, m_defaultConeFreedomY, m_defaultConeFreedomZ, m_defaultContactDistance);
+
+	g_PxPhysXSystem->CreateSimpleFixedChain(position + offsetZ, length, geometry, separation);
+	g_PxPhysXSystem->CreateBreakableFixedChain(position + offsetZ + offsetY, length, geometry, separation, m_defaultBreakForce, m_defaultBreakTorque);
+
+	g_PxPhysXSystem->CreateDampedD6Chain(position + (offsetZ * 2.f), length, geometry, separation, m_defaultDriveStiffness, m_defaultDriveDamping, m_defaultDriveForceLimit, m_isDriveAccelerating);
+}
+
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreatePhysXConvexHull(const Vec3& position)
+{
+	std::vector<PxVec3> vertexArray;
+
+	const int numVerts = 64;
+
+	//Fixed seed so the same hull comes back from the cooked mesh cache every start
+	RandomNumberGenerator hullRNG(m_convexHullSeed);
+
+	// Prepare random verts
+	for (PxU32 i = 0; i < numVerts; i++)
+	{
+		vertexArray.push_back(PxVec3(hullRNG.GetRandomFloatInRange(-5.f, 5.f) , hullRNG.GetRandomFloatInRange(0.f, 5.f), hullRNG.GetRandomFloatInRange(-5.f, 5.f)));
+	}
+
+	PxConvexMesh* convexMesh = m_cookedConvexCache.CreateConvexMesh(&vertexArray[0], numVerts, 16, *g_PxPhysXSystem->GetPhysXSDK(), *g_PxPhysXSystem->GetPhysXCookingModule());
+
+	Matrix44 hullModel = Matrix44::SetTranslation3D(position, Matrix44::IDENTITY);
+	g_PxPhysXSystem->CreateDynamicObject(PxConvexMeshGeometry(convexMesh), Vec3::ZERO, hullModel, m_dynamicObjectDensity);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CreatePhysXStack(const Vec3& position, uint size, float halfExtent)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxScene* pxScene = g_PxPhysXSystem->GetPhysXScene();
+
+	PxTransform pxTransform = PxTransform(PxVec3(position.x, position.y, position.z));
+
+	//We are going to make a stack of boxes
+	PxBoxGeometry box = PxBoxGeometry((PxReal)halfExtent, (PxReal)halfExtent, (PxReal)halfExtent);
+	PxMaterial* pxMaterial = physX->createMaterial(0.5f, 0.5f, 0.6f);
+	PxShape* shape = physX->createShape(box, *pxMaterial);
+	
+	//Loop to stack everything in a pyramid shape
+	for (PxU32 layerIndex = 0; layerIndex < size; layerIndex++)
+	{
+		for (PxU32 indexInLayer = 0; indexInLayer < size - layerIndex; indexInLayer++)
+		{
+			PxTransform localTm(PxVec3(PxReal(indexInLayer * 2) - PxReal(size - layerIndex), PxReal(layerIndex * 2 + 1), 0) * halfExtent);
+			PxRigidDynamic* body = physX->createRigidDynamic(pxTransform.transform(localTm));
+			body->attachShape(*shape);
+			PxRigidBodyExt::updateMassAndInertia(*body, 10.0f);
+			pxScene->addActor(*body);
+		}
+	}
+
+	//release the shape now, we don't need it anymore since everything has been added to the PhysX scene
+	shape->release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RecordPhysXStats(float frameSeconds)
+{
+	m_physXStats.RecordStep(*g_PxPhysXSystem->GetPhysXScene(), m_vehicleManager->GetNumVehicles(), m_vehicleManager->GetNumWheelQueriesLastStep(), frameSeconds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StartInputRecording()
+{
+	//The replay starts from this same reset state
+	ResetScene();
+
+	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
+	PxSceneFlags sceneFlags = scene->getFlags();
+	m_inputRecording.BeginRecording((PxU32)sceneFlags, m_vehicleManager->GetNumVehicles(), m_carController->IsDigitalInputEnabled());
+
+	PrintPhysXSetupReport((sceneFlags & PxSceneFlag::eENABLE_ENHANCED_DETERMINISM) ? "Input recording started"
+		: "Input recording started. Enhanced determinism is off, replays only match on the same build with the same scene");
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::StopInputRecording(const std::string& filePath)
+{
+	int numSteps = m_inputRecording.GetNumSteps();
+	bool isSaved = m_inputRecording.EndRecording(filePath);
+
+	char report[256];
+	snprintf(report, sizeof(report), "Input recording: %d steps %s %s", numSteps, isSaved ? "saved to" : "could not be saved to", filePath.c_str());
+	PrintPhysXSetupReport(report);
+	return isSaved;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::StartInputReplay(const std::string& filePath, float fixedStepSeconds)
+{
+	char report[512];
+	if (!m_inputRecording.BeginReplay(filePath))
+	{
+		snprintf(report, sizeof(report), "Input replay: could not load %s", filePath.c_str());
+		PrintPhysXSetupReport(report);
+		return false;
+	}
+
+	int mismatchedStep = fixedStepSeconds > 0.f ? m_inputRecording.FindFirstStepNotSized(fixedStepSeconds) : -1;
+	if (mismatchedStep >= 0)
+	{
+		m_inputRecording.EndReplay();
+		snprintf(report, sizeof(report), "Input replay: rejected %s, step %d was recorded at %.6f s but physics steps at %.6f s. Set physicsStep to match or replay it headless",
+			filePath.c_str(), mismatchedStep, m_inputRecording.GetRecordedStepSeconds(mismatchedStep), fixedStepSeconds);
+		PrintPhysXSetupReport(report);
+		return false;
+	}
+
+	ResetScene();
+	m_carController->SetDigitalControlMode(m_inputRecording.WasRecordedWithDigitalInput());
+
+	PxU32 sceneFlags = (PxU32)g_PxPhysXSystem->GetPhysXScene()->getFlags();
+	snprintf(report, sizeof(report), "Input replay: %d steps from %s%s%s", m_inputRecording.GetNumSteps(), filePath.c_str(),
+		sceneFlags != m_inputRecording.GetRecordedSceneFlags() ? ", scene flags differ from the recording" : "",
+		m_vehicleManager->GetNumVehicles() != m_inputRecording.GetRecordedNumVehicles() ? ", vehicle count differs from the recording" : "");
+	PrintPhysXSetupReport(report);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StopInputReplay()
+{
+	if (!IsReplayingInput())
+	{
+		return;
+	}
+
+	m_inputRecording.EndReplay();
+
+	char report[256];
+	if (m_inputRecording.GetNumHashMismatches() == 0)
+	{
+		snprintf(report, sizeof(report), "Input replay: %d of %d steps replayed, state matched the recording on every step",
+			m_inputRecording.GetNumReplayedSteps(), m_inputRecording.GetNumSteps());
+	}
+	else
+	{
+		snprintf(report, sizeof(report), "Input replay: %d of %d steps replayed, DIVERGED at step %d (%d steps differ)", m_inputRecording.GetNumReplayedSteps(),
+			m_inputRecording.GetNumSteps(), m_inputRecording.GetFirstMismatchStep(), m_inputRecording.GetNumHashMismatches());
+	}
+	PrintPhysXSetupReport(report);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float Game::ApplyReplayedInput()
+{
+	int forcedGear = -1;
+	float stepSeconds = 0.f;
+	if (!m_inputRecording.ReplayInput(*m_carController->GetVehicleInputData(), forcedGear, stepSeconds))
+	{
+		StopInputReplay();
+		return 0.f;
+	}
+
+	m_carController->ForceGear(forcedGear);
+	return stepSeconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RecordPlayerInput(float stepSeconds)
+{
+	if (m_inputRecording.GetMode() == VEHICLE_INPUT_RECORDING)
+	{
+		m_inputRecording.RecordInput(*m_carController->GetVehicleInputData(), m_carController->GetForcedGearThisStep(), stepSeconds);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateInputRecordingHash()
+{
+	eVehicleInputRecordingMode mode = m_inputRecording.GetMode();
+	if (mode == VEHICLE_INPUT_IDLE)
+	{
+		return;
+	}
+
+	PxU64 stateHash = VehicleInputRecording::ComputeStateHash(*g_PxPhysXSystem->GetPhysXScene(), *m_carController->GetVehicle());
+	if (mode == VEHICLE_INPUT_RECORDING)
+	{
+		m_inputRecording.RecordStateHash(stateHash);
+	}
+	else
+	{
+		m_inputRecording.CheckStateHash(stateHash);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateVehicles(float deltaTime)
+{
+	//Simulation LOD and suspension query quality drop off with distance from the player's car, which the camera tracks. The
+	//LOD changes the simulation, so it comes from the simulated pose rather than the frame rate dependent camera, which
+	//keeps windowed, headless and replayed runs stepping the same
+	m_vehicleManager->SetLODFocus(m_carController->GetVehicle()->getRigidDynamicActor()->getGlobalPose().p);
+
+	if (m_aiVehicleRoute != nullptr)
+	{
+		SteerRouteVehicles(*m_vehicleManager, m_aiVehicleThrottle);
+	}
+
+	//Every vehicle, player included, goes through batched suspension queries and one PxVehicleUpdates call
+	//Raw inputs are smoothed into the vehicles at the top of the manager update
+	m_inputLatency.OnInputApplied();
+	m_vehicleManager->Update(deltaTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ShutdownSimulation()
+{
+	//m_carController->ReleaseVehicle();
+
+	m_physXProfilerBridge.Remove();
+
+	//Holds raw pointers into the vehicles and scene content released below
+	m_poseSnapshot.Clear();
+	m_renderProxies.ShutDown();
+	m_projectilePool.Shutdown();
+
+	delete m_vehicleManager;
+	m_vehicleManager = nullptr;
+	m_vehicleArchetypes.ReleaseArchetypes();
+
+	delete m_aiVehicleRoute;
+	m_aiVehicleRoute = nullptr;
+
+	//Scene content goes with the Game so an F8 restart doesn't stack a second copy on top of it
+	m_sceneSnapshot.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::IsAlive()
+{
+	//Check if alive
+	return m_isGameAlive;
+}
+
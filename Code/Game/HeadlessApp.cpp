@@ -0,0 +1,893 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/HeadlessApp.hpp"
+//Engine Systems
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/AllocationCounter.hpp"
+#include "Game/CarController.hpp"
+#include "Game/FrameArena.hpp"
+#include "Game/Game.hpp"
+#include "Game/InputLatencyTracker.hpp"
+#include "Game/PhysXInstanceBatch.hpp"
+#include "Game/PhysXPoolAllocator.hpp"
+#include "Game/Profiler.hpp"
+//Standard
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+HeadlessApp* g_theHeadlessApp = nullptr;
+
+const int gMaxPrintedAllocationFailures = 16;
+
+//Actors read from the scene per getActors call by the instance packing check
+const PxU32 gPackingCheckActorBatch = 64;
+//Packed corners may drift this far from PxTransform, relative to the corner's distance from the origin
+const float gPackingCheckTolerance = 1e-4f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Engine time is built on the Win32 performance counter so the headless host keeps its own portable clock
+//------------------------------------------------------------------------------------------------------------------------------
+static double GetHeadlessTimeSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+HeadlessApp::HeadlessApp()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+HeadlessApp::~HeadlessApp()
+{
+	ShutDown();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ParseCommandLine(int argc, char** argv)
+{
+	//Arguments are of the form -steps=7200 -dt=0.016 -aiVehicles=200 -vehicleThreads=4 -vehiclesPerChunk=16 -vehicleThreadBenchmark -latencyCSV=latency.csv -sceneSnapshot=0 -resetEverySteps=600 -bulkObstacles=50000 -fireEverySteps=5 -allocationTest=120 -frameArenaKB=256 -profileFrom=600 -profileSteps=60 -profileTrace=HeadlessProfile.json -statsCSV=PhysXStats.csv -statsBinary=PhysXStats.pxstats -recordInput=Drive.pxinput -replayInput=Drive.pxinput
+	//Scene benchmark arguments are -sceneBenchmark -benchWarmup=60 -benchBuilders=stacks,wall -benchJSON=SceneBenchmark.json -benchStackSize=10 -benchStacks=5 -benchWallWidth=12 -benchWallHeight=4 -benchChainLength=5 -benchCapsules=40 -benchHulls=16 -benchVehicles=64, -steps and -dt set the measured steps
+	//Batch episode arguments are -batchEpisodes=32 -batchThreads=8 -batchPxThreads=0, -steps and -dt set every episode's length. Left out, -batchThreads is every hardware thread -batchPxThreads leaves free
+	//Vehicle sweep arguments are -vehicleSweep=Engine.peakTorque=400,600;Suspension.springStrength=25000,35000 -sweepTrack=12,20;30,55;10,90 -sweepMaxLap=90 -sweepThreads=8 -sweepCSV=VehicleSweep.csv -sweepBest=BestVehicle.xml, -dt sets the step size
+	//-vehicleDescriptor=Data/Gameplay/Vehicle.xml picks the handling every run starts from
+	//-instancePackingCheck packs every shape in the scene the way the debug view does and checks all 12 floats against PxMat44(pose) times the scale
+	for (int argIndex = 1; argIndex < argc; ++argIndex)
+	{
+		const char* arg = argv[argIndex];
+
+		if (strncmp(arg, "-steps=", 7) == 0)
+		{
+			m_numStepsToRun = atoi(arg + 7);
+		}
+		else if (strncmp(arg, "-dt=", 4) == 0)
+		{
+			m_stepSeconds = static_cast<float>(atof(arg + 4));
+		}
+		else if (strncmp(arg, "-aiVehicles=", 12) == 0)
+		{
+			m_numAIVehicles = atoi(arg + 12);
+		}
+		else if (strncmp(arg, "-vehicleThreads=", 16) == 0)
+		{
+			m_vehicleUpdateThreads = atoi(arg + 16);
+		}
+		else if (strncmp(arg, "-vehiclesPerChunk=", 18) == 0)
+		{
+			m_vehiclesPerChunk = atoi(arg + 18);
+		}
+		else if (strcmp(arg, "-vehicleThreadBenchmark") == 0)
+		{
+			m_runVehicleThreadBenchmark = true;
+		}
+		else if (strncmp(arg, "-latencyCSV=", 12) == 0)
+		{
+			m_latencyCSVPath = arg + 12;
+		}
+		else if (strncmp(arg, "-statsCSV=", 10) == 0)
+		{
+			m_physXStatsCSVPath = arg + 10;
+		}
+		else if (strncmp(arg, "-statsBinary=", 13) == 0)
+		{
+			m_physXStatsBinaryPath = arg + 13;
+		}
+		else if (strncmp(arg, "-recordInput=", 13) == 0)
+		{
+			m_recordInputPath = arg + 13;
+		}
+		else if (strncmp(arg, "-replayInput=", 13) == 0)
+		{
+			m_replayInputPath = arg + 13;
+		}
+		else if (strncmp(arg, "-sceneSnapshot=", 15) == 0)
+		{
+			m_useSceneSnapshot = atoi(arg + 15) != 0;
+		}
+		else if (strncmp(arg, "-bulkObstacles=", 15) == 0)
+		{
+			m_numBulkObstacles = atoi(arg + 15);
+		}
+		else if (strncmp(arg, "-fireEverySteps=", 16) == 0)
+		{
+			m_fireEverySteps = atoi(arg + 16);
+		}
+		else if (strncmp(arg, "-resetEverySteps=", 17) == 0)
+		{
+			m_resetEverySteps = atoi(arg + 17);
+		}
+		else if (strcmp(arg, "-allocationTest") == 0)
+		{
+			m_allocationTestWarmupSteps = 120;
+		}
+		else if (strncmp(arg, "-allocationTest=", 16) == 0)
+		{
+			m_allocationTestWarmupSteps = atoi(arg + 16);
+		}
+		else if (strncmp(arg, "-frameArenaKB=", 14) == 0)
+		{
+			m_frameArenaKB = atoi(arg + 14);
+		}
+		else if (strncmp(arg, "-profileFrom=", 13) == 0)
+		{
+			m_profileFromStep = atoi(arg + 13);
+		}
+		else if (strncmp(arg, "-profileSteps=", 14) == 0)
+		{
+			m_numProfileSteps = atoi(arg + 14);
+		}
+		else if (strncmp(arg, "-profileTrace=", 14) == 0)
+		{
+			m_profileTracePath = arg + 14;
+		}
+		else if (strcmp(arg, "-instancePackingCheck") == 0)
+		{
+			m_runInstancePackingCheck = true;
+		}
+		else if (strcmp(arg, "-sceneBenchmark") == 0)
+		{
+			m_runSceneBenchmark = true;
+		}
+		else if (strncmp(arg, "-benchWarmup=", 13) == 0)
+		{
+			m_sceneBenchmarkSettings.m_numWarmupSteps = atoi(arg + 13);
+		}
+		else if (strncmp(arg, "-benchBuilders=", 15) == 0)
+		{
+			m_sceneBenchmarkSettings.m_buildersToRun = arg + 15;
+		}
+		else if (strncmp(arg, "-benchJSON=", 11) == 0)
+		{
+			m_sceneBenchmarkSettings.m_jsonPath = arg + 11;
+		}
+		else if (strncmp(arg, "-benchStackSize=", 16) == 0)
+		{
+			m_sceneBenchmarkSettings.m_stackSize = atoi(arg + 16);
+		}
+		else if (strncmp(arg, "-benchStacks=", 13) == 0)
+		{
+			m_sceneBenchmarkSettings.m_numStacks = atoi(arg + 13);
+		}
+		else if (strncmp(arg, "-benchWallWidth=", 16) == 0)
+		{
+			m_sceneBenchmarkSettings.m_wallWidth = atoi(arg + 16);
+		}
+		else if (strncmp(arg, "-benchWallHeight=", 17) == 0)
+		{
+			m_sceneBenchmarkSettings.m_wallHeight = atoi(arg + 17);
+		}
+		else if (strncmp(arg, "-benchChainLength=", 18) == 0)
+		{
+			m_sceneBenchmarkSettings.m_chainLength = atoi(arg + 18);
+		}
+		else if (strncmp(arg, "-benchCapsules=", 15) == 0)
+		{
+			m_sceneBenchmarkSettings.m_numCapsules = atoi(arg + 15);
+		}
+		else if (strncmp(arg, "-benchHulls=", 12) == 0)
+		{
+			m_sceneBenchmarkSettings.m_numConvexHulls = atoi(arg + 12);
+		}
+		else if (strncmp(arg, "-batchEpisodes=", 15) == 0)
+		{
+			m_batchEpisodeSettings.m_numEpisodes = atoi(arg + 15);
+		}
+		else if (strncmp(arg, "-batchThreads=", 14) == 0)
+		{
+			m_batchEpisodeSettings.m_numThreads = atoi(arg + 14);
+		}
+		else if (strncmp(arg, "-batchPxThreads=", 16) == 0)
+		{
+			m_batchEpisodeSettings.m_numDispatcherThreads = atoi(arg + 16);
+		}
+		else if (strncmp(arg, "-benchVehicles=", 15) == 0)
+		{
+			m_sceneBenchmarkSettings.m_numVehicles = atoi(arg + 15);
+		}
+		else if (strncmp(arg, "-vehicleDescriptor=", 19) == 0)
+		{
+			m_vehicleDescriptorPath = arg + 19;
+		}
+		else if (strncmp(arg, "-vehicleSweep=", 14) == 0)
+		{
+			m_runVehicleSweep = true;
+			m_vehicleSweepSettings.m_parameters = arg + 14;
+		}
+		else if (strncmp(arg, "-sweepTrack=", 12) == 0)
+		{
+			m_vehicleSweepSettings.m_track = arg + 12;
+		}
+		else if (strncmp(arg, "-sweepMaxLap=", 13) == 0)
+		{
+			m_vehicleSweepSettings.m_maxLapSeconds = (float)atof(arg + 13);
+		}
+		else if (strncmp(arg, "-sweepThreads=", 14) == 0)
+		{
+			m_vehicleSweepSettings.m_numThreads = atoi(arg + 14);
+		}
+		else if (strncmp(arg, "-sweepCSV=", 10) == 0)
+		{
+			m_vehicleSweepSettings.m_csvPath = arg + 10;
+		}
+		else if (strncmp(arg, "-sweepBest=", 11) == 0)
+		{
+			m_vehicleSweepSettings.m_bestDescriptorPath = arg + 11;
+		}
+		else
+		{
+			printf("\n >> Ignoring unknown argument %s", arg);
+		}
+	}
+
+	if (m_numStepsToRun <= 0 || m_stepSeconds <= 0.f)
+	{
+		ERROR_AND_DIE(">> Headless run needs a positive step count and step size");
+	}
+
+	m_sceneBenchmarkSettings.m_numSteps = m_numStepsToRun;
+	m_sceneBenchmarkSettings.m_stepSeconds = m_stepSeconds;
+	m_batchEpisodeSettings.m_numStepsPerEpisode = m_numStepsToRun;
+	m_batchEpisodeSettings.m_stepSeconds = m_stepSeconds;
+	m_vehicleSweepSettings.m_stepSeconds = m_stepSeconds;
+
+	if (m_runVehicleSweep && m_vehicleSweepSettings.m_maxLapSeconds <= 0.f)
+	{
+		ERROR_AND_DIE(">> Vehicle sweep needs a positive lap time limit");
+	}
+
+	//Scaling is meaningless with one car, give the benchmark a crowd unless one was asked for
+	if (m_runVehicleThreadBenchmark && m_numAIVehicles == 0)
+	{
+		m_numAIVehicles = 256;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::StartUp()
+{
+	//g_renderContext, g_audio and g_inputSystem are intentionally left as nullptr. Nothing on the headless path touches them
+	Profiler::SetThreadName("Main");
+
+	g_RNG = new RandomNumberGenerator(0);
+
+	g_frameArena = new FrameArena((size_t)m_frameArenaKB * 1024);
+
+	if (m_runSceneBenchmark)
+	{
+		//The benchmark brings up its own PhysXSystem and Game for every builder
+		return;
+	}
+
+	g_PxPhysXSystem = new PhysXSystem();
+
+	m_game = new Game(true);
+	m_game->m_numAIVehicles = m_numAIVehicles;
+	m_game->m_vehicleUpdateThreads = m_vehicleUpdateThreads;
+	m_game->m_vehiclesPerChunk = m_vehiclesPerChunk;
+	m_game->m_useSceneSnapshot = m_useSceneSnapshot;
+	m_game->m_numBulkObstacles = m_numBulkObstacles;
+	if (!m_vehicleDescriptorPath.empty())
+	{
+		m_game->m_vehicleDescriptorPath = m_vehicleDescriptorPath;
+	}
+	m_game->StartUpHeadless();
+
+	SetupDefaultInputScript();
+
+	if (m_batchEpisodeSettings.m_numEpisodes > 0 || m_runVehicleSweep || m_runInstancePackingCheck)
+	{
+		//The Game is only the template the episodes are cloned from, it is never stepped
+		return;
+	}
+
+	if (!m_replayInputPath.empty())
+	{
+		//Every step takes the recorded size, see StepSimulation
+		if (!m_game->StartInputReplay(m_replayInputPath, 0.f))
+		{
+			ERROR_AND_DIE(">> Could not load the input replay");
+		}
+
+		//Only player input is recorded, episode resets and projectiles would make the replay diverge
+		m_numStepsToRun = m_game->GetInputRecording().GetNumSteps();
+		m_resetEverySteps = 0;
+		m_fireEverySteps = 0;
+	}
+	else if (!m_recordInputPath.empty())
+	{
+		m_game->StartInputRecording();
+	}
+
+	m_wallTimeAtStart = GetHeadlessTimeSeconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ShutDown()
+{
+	delete m_game;
+	m_game = nullptr;
+
+	delete g_PxPhysXSystem;
+	g_PxPhysXSystem = nullptr;
+
+	delete g_RNG;
+	g_RNG = nullptr;
+
+	delete g_frameArena;
+	g_frameArena = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::RunStep()
+{
+	if (m_runSceneBenchmark)
+	{
+		RunSceneBenchmark();
+		return;
+	}
+
+	if (m_runVehicleSweep)
+	{
+		RunVehicleSweep();
+		return;
+	}
+
+	if (m_runInstancePackingCheck)
+	{
+		RunInstancePackingCheck();
+		return;
+	}
+
+	if (m_batchEpisodeSettings.m_numEpisodes > 0)
+	{
+		RunBatchEpisodes();
+		return;
+	}
+
+	if (m_allocationTestWarmupSteps >= 0 && m_numStepsTaken == m_allocationTestWarmupSteps)
+	{
+		AllocationCounter::SetEnabled(true);
+	}
+
+	if (m_profileFromStep >= 0 && m_numStepsTaken == m_profileFromStep)
+	{
+		Profiler::BeginCapture(m_numProfileSteps, m_profileTracePath);
+	}
+
+	{
+		ScopedAllocationCheck allocationCheck("HeadlessApp::RunStep");
+		PROFILE_SCOPE("HeadlessApp::Step");
+		StepSimulation();
+	}
+
+	if (Profiler::EndFrame())
+	{
+		printf("\n >> Profile capture : %i events (%i dropped) %s %s", Profiler::GetLastNumEvents(), Profiler::GetLastNumDroppedEvents(),
+			Profiler::WasLastTraceWritten() ? "written to" : "could not be written to", Profiler::GetLastTracePath().c_str());
+	}
+
+	g_frameArena->Reset();
+	CheckSteadyStateAllocations();
+
+	m_simulatedTime += m_stepSeconds;
+	m_numStepsTaken++;
+	m_stepsSinceReset++;
+
+	if (m_numStepsTaken >= m_numStepsToRun)
+	{
+		//Reporting allocates freely, it is not part of a step
+		AllocationCounter::SetEnabled(false);
+
+		if (m_game->IsReplayingInput())
+		{
+			m_exitCode = m_game->GetInputRecording().GetNumHashMismatches() == 0 ? m_exitCode : 1;
+			m_game->StopInputReplay();
+		}
+		else if (!m_recordInputPath.empty() && !m_game->StopInputRecording(m_recordInputPath))
+		{
+			m_exitCode = 1;
+		}
+
+		m_wallTimeAtEnd = GetHeadlessTimeSeconds();
+		ReportResults();
+		m_isQuitting = true;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::StepSimulation()
+{
+	double stepStart = GetHeadlessTimeSeconds();
+
+	if (m_runVehicleThreadBenchmark)
+	{
+		//Every thread count starts from the same scene and input script so the passes time the same workload
+		int passIndex = (m_numStepsTaken * NUM_VEHICLE_BENCHMARK_PASSES) / m_numStepsToRun;
+		if (passIndex != m_benchmarkPassIndex)
+		{
+			m_benchmarkPassIndex = passIndex;
+			m_game->GetVehicleManager()->SetNumWorkerThreads(m_benchmarkThreadCounts[passIndex]);
+			m_game->ResetScene();
+
+			m_stepsSinceReset = 0;
+			m_episodeStartTime = m_simulatedTime;
+		}
+	}
+
+	if (m_resetEverySteps > 0 && m_stepsSinceReset >= m_resetEverySteps)
+	{
+		m_game->ResetScene();
+
+		double resetSeconds = m_game->GetLastSceneResetSeconds();
+		m_totalSceneResetSeconds += resetSeconds;
+		m_maxSceneResetSeconds = resetSeconds > m_maxSceneResetSeconds ? resetSeconds : m_maxSceneResetSeconds;
+		m_numSceneResets++;
+
+		//Every episode replays the input script from the start
+		m_stepsSinceReset = 0;
+		m_episodeStartTime = m_simulatedTime;
+	}
+
+	g_PxPhysXSystem->BeginFrame();
+
+	//Script and replay input are produced right here, this is the headless poll
+	m_game->GetInputLatencyTracker().OnInputSampled(InputLatencyTracker::GetTimeSeconds());
+
+	if (m_game->IsReplayingInput())
+	{
+		//Recorded step sizes win over -dt so every step matches the recording
+		m_game->GetCarController()->ReleaseAllControls();
+		float replayedStepSeconds = m_game->ApplyReplayedInput();
+		m_stepSeconds = replayedStepSeconds > 0.f ? replayedStepSeconds : m_stepSeconds;
+	}
+	else
+	{
+		ApplyScriptedInputs(m_simulatedTime - m_episodeStartTime);
+		m_game->RecordPlayerInput(m_stepSeconds);
+	}
+
+	if (m_fireEverySteps > 0 && (m_numStepsTaken % m_fireEverySteps) == 0)
+	{
+		//Lob one over the car, same path as the SPACE key
+		Vec3 carPosition = m_game->GetCarController()->GetVehiclePosition();
+		Vec3 carForward = m_game->GetCarController()->GetVehicleForwardBasis();
+		PxTransform pose(PxVec3(carPosition.x, carPosition.y + 10.f, carPosition.z));
+		PxVec3 velocity(carForward.x * 30.f, 5.f, carForward.z * 30.f);
+		m_game->QueueProjectile(pose, velocity);
+	}
+
+	m_game->UpdateProjectiles(m_stepSeconds);
+
+	m_game->UpdateVehicles(m_stepSeconds);
+
+	if (m_runVehicleThreadBenchmark)
+	{
+		//Only the vehicle SDK update scales with threads, queries and LOD picking stay serial
+		m_benchmarkUpdateSeconds[m_benchmarkPassIndex] += m_game->GetVehicleManager()->GetLastVehicleUpdateSeconds();
+		m_benchmarkStepsPerPass[m_benchmarkPassIndex]++;
+	}
+
+	{
+		PROFILE_SCOPE("PhysXSystem::Update");
+		g_PxPhysXSystem->Update(m_stepSeconds);
+	}
+	m_game->RecordPhysXStats((float)(GetHeadlessTimeSeconds() - stepStart));
+	m_game->UpdateInputRecordingHash();
+
+	//Nothing is drawn here, so the pose counts as visible as soon as the step has been fetched
+	InputLatencyTracker& inputLatency = m_game->GetInputLatencyTracker();
+	inputLatency.OnPhysicsStepDone();
+	inputLatency.OnPoseVisible();
+
+	g_PxPhysXSystem->EndFrame();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::RunSceneBenchmark()
+{
+	SceneBenchmark sceneBenchmark(m_sceneBenchmarkSettings);
+	m_exitCode = sceneBenchmark.Run() ? 0 : 1;
+	m_isQuitting = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::RunBatchEpisodes()
+{
+	BatchEpisodeRunner batchRunner(m_batchEpisodeSettings);
+	batchRunner.SetInputScript(m_inputScript, m_scriptLoopSeconds);
+	batchRunner.StartUp(*m_game);
+	batchRunner.Run();
+	batchRunner.PrintReport();
+
+	//Before the template Game and the engine scene go away in ShutDown
+	batchRunner.ShutDown();
+	m_isQuitting = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::RunVehicleSweep()
+{
+	VehicleSweep vehicleSweep(m_vehicleSweepSettings);
+	m_exitCode = vehicleSweep.Run(*m_game) ? 0 : 1;
+	m_isQuitting = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::RunInstancePackingCheck()
+{
+	const PxScene& scene = *g_PxPhysXSystem->GetPhysXScene();
+	PxActorTypeFlags actorTypes = PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC;
+	PxU32 numActors = scene.getNbActors(actorTypes);
+
+	PhysXInstanceBatch instanceBatch;
+	PxActor* actors[gPackingCheckActorBatch];
+	int numShapesChecked = 0;
+	int numBadShapes = 0;
+	float maxError = 0.f;
+
+	for (PxU32 startIndex = 0; startIndex < numActors; startIndex += gPackingCheckActorBatch)
+	{
+		PxU32 numInBatch = scene.getActors(actorTypes, actors, gPackingCheckActorBatch, startIndex);
+		for (PxU32 batchIndex = 0; batchIndex < numInBatch; ++batchIndex)
+		{
+			const PxRigidActor* actor = actors[batchIndex]->is<PxRigidActor>();
+			PxTransform actorPose = actor->getGlobalPose();
+
+			PxShape* shape = nullptr;
+			for (PxU32 shapeIndex = 0; shapeIndex < actor->getNbShapes(); ++shapeIndex)
+			{
+				actor->getShapes(&shape, 1, shapeIndex);
+				PxGeometryHolder geometry = shape->getGeometry();
+
+				PxTransform pose = actorPose * shape->getLocalPose();
+				PxVec3 scale = PhysXInstanceBatch::GetUnitMeshScale(geometry);
+
+				//Bucketed by geometry type, the slot only has to be stable for the check
+				int meshSlot = (int)geometry.getType();
+				int instanceIndex = instanceBatch.GetNumInstances(meshSlot);
+				instanceBatch.AddInstance(meshSlot, pose, scale);
+				const PhysXShapeInstance& instance = instanceBatch.GetInstances(meshSlot)[instanceIndex];
+
+				//Built without the packing code: PhysX's own pose matrix times a scale matrix. Its first three columns are the
+				//scaled basis and the last one the translation, which is the order the 12 packed floats have to be in
+				PxMat44 scaleMatrix(PxVec4(scale.x, scale.y, scale.z, 1.f));
+				PxMat44 expected = PxMat44(pose) * scaleMatrix;
+
+				bool isShapeBad = false;
+				for (int floatIndex = 0; floatIndex < 12; ++floatIndex)
+				{
+					float expectedFloat = expected[floatIndex / 3][floatIndex % 3];
+					float error = PxAbs(instance.m_basis[floatIndex] - expectedFloat) / (1.f + PxAbs(expectedFloat));
+					maxError = PxMax(maxError, error);
+					isShapeBad = isShapeBad || error > gPackingCheckTolerance;
+				}
+
+				numBadShapes += isShapeBad ? 1 : 0;
+				numShapesChecked++;
+			}
+		}
+	}
+
+	bool isCountRight = instanceBatch.GetTotalInstanceCount() == numShapesChecked &&
+		instanceBatch.GetPackedSizeBytes() == numShapesChecked * (int)sizeof(PhysXShapeInstance);
+
+	printf("\n >> Instance packing check : %i shapes on %u actors, %i off by more than %g (max %g), instance count %s",
+		numShapesChecked, numActors, numBadShapes, gPackingCheckTolerance, maxError, isCountRight ? "matches" : "DOES NOT MATCH");
+	printf("\n");
+
+	m_exitCode = (numBadShapes == 0 && isCountRight) ? 0 : 1;
+	m_isQuitting = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::CheckSteadyStateAllocations()
+{
+	int numFailures = AllocationCounter::GetNumScopeFailures();
+	if (numFailures == 0)
+	{
+		return;
+	}
+
+	//Only the first few are printed, a leaking path would otherwise fail every single step
+	for (int failureIndex = 0; failureIndex < numFailures; ++failureIndex)
+	{
+		if (m_numAllocatingSteps < gMaxPrintedAllocationFailures)
+		{
+			const AllocationScopeFailure& failure = AllocationCounter::GetScopeFailure(failureIndex);
+			printf("\n >> Step %i : %s made %llu heap allocations (%llu bytes)", m_numStepsTaken, failure.m_scopeName,
+				(unsigned long long)failure.m_numAllocations, (unsigned long long)failure.m_numBytes);
+		}
+	}
+
+	m_numAllocatingSteps++;
+	m_exitCode = 1;
+	AllocationCounter::ClearScopeFailures();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::SetupDefaultInputScript()
+{
+	//A short loop that accelerates, turns into the ramps, brakes and backs up so the suspension and drive train get exercised
+	m_inputScript.clear();
+
+	ScriptedVehicleInput input;
+
+	input.m_startTime = 0.f;
+	input.m_accelerate = 1.f;
+	m_inputScript.push_back(input);
+
+	input.m_startTime = 4.f;
+	input.m_steer = 0.6f;
+	m_inputScript.push_back(input);
+
+	input.m_startTime = 7.f;
+	input.m_accelerate = 0.f;
+	input.m_steer = 0.f;
+	input.m_brake = true;
+	m_inputScript.push_back(input);
+
+	input.m_startTime = 9.f;
+	input.m_accelerate = -0.7f;
+	input.m_brake = false;
+	input.m_steer = -0.4f;
+	m_inputScript.push_back(input);
+
+	input.m_startTime = 12.f;
+	input.m_accelerate = 0.f;
+	input.m_steer = 0.f;
+	input.m_handbrake = true;
+	m_inputScript.push_back(input);
+
+	m_scriptLoopSeconds = 14.f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ApplyScriptedInputs(float simulatedTime)
+{
+	ApplyInputScript(*m_game->GetCarController(), m_inputScript, m_scriptLoopSeconds, simulatedTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void HeadlessApp::ApplyInputScript(CarController& carController, const std::vector<ScriptedVehicleInput>& inputScript, float loopSeconds,
+	float simulatedTime)
+{
+	carController.ReleaseAllControls();
+
+	if (inputScript.empty())
+	{
+		return;
+	}
+
+	float scriptTime = fmodf(simulatedTime, loopSeconds);
+
+	//Use the last key that has started
+	const ScriptedVehicleInput* activeInput = &inputScript[0];
+	for (int inputIndex = 0; inputIndex < (int)inputScript.size(); ++inputIndex)
+	{
+		if (inputScript[inputIndex].m_startTime <= scriptTime)
+		{
+			activeInput = &inputScript[inputIndex];
+		}
+	}
+
+	if (activeInput->m_accelerate > 0.f)
+	{
+		carController.AccelerateForward(activeInput->m_accelerate);
+	}
+	else if (activeInput->m_accelerate < 0.f)
+	{
+		carController.AccelerateReverse(-activeInput->m_accelerate);
+	}
+
+	if (activeInput->m_steer != 0.f)
+	{
+		carController.Steer(activeInput->m_steer);
+	}
+
+	if (activeInput->m_brake)
+	{
+		carController.Brake();
+	}
+
+	if (activeInput->m_handbrake)
+	{
+		carController.Handbrake();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ReportResults() const
+{
+	double wallSeconds = m_wallTimeAtEnd - m_wallTimeAtStart;
+	double stepsPerSecond = wallSeconds > 0.0 ? (double)m_numStepsTaken / wallSeconds : 0.0;
+	double realtimeFactor = wallSeconds > 0.0 ? (double)m_simulatedTime / wallSeconds : 0.0;
+
+	Vec3 carPosition = m_game->GetCarController()->GetVehiclePosition();
+
+	printf("\n >> Headless run complete");
+	printf("\n >> Steps : %i of %f s", m_numStepsTaken, m_stepSeconds);
+	VehicleManager* vehicleManager = m_game->GetVehicleManager();
+	printf("\n >> Vehicles : %i (%i sweep, %i raycast, %i cached on the last step)", vehicleManager->GetNumVehicles(), vehicleManager->GetNumVehiclesAtQuality(VEHICLE_QUERY_SWEEP),
+		vehicleManager->GetNumVehiclesAtQuality(VEHICLE_QUERY_RAYCAST), vehicleManager->GetNumVehiclesAtQuality(VEHICLE_QUERY_CACHED));
+	printf("\n >> Vehicle LOD : %i full, %i reduced, %i kinematic on the last step", vehicleManager->GetNumVehiclesAtSimLOD(VEHICLE_LOD_FULL),
+		vehicleManager->GetNumVehiclesAtSimLOD(VEHICLE_LOD_REDUCED), vehicleManager->GetNumVehiclesAtSimLOD(VEHICLE_LOD_KINEMATIC));
+	printf("\n >> Simulated time : %f s", m_simulatedTime);
+	printf("\n >> Wall time : %f s", wallSeconds);
+	printf("\n >> Steps/sec : %f", stepsPerSecond);
+	printf("\n >> Realtime factor : %fx", realtimeFactor);
+	printf("\n >> Final car position : %f %f %f\n", carPosition.x, carPosition.y, carPosition.z);
+
+	ReportInputLatency();
+	ReportPhysXMemory();
+	ReportPhysXStats();
+
+	if (m_allocationTestWarmupSteps >= 0)
+	{
+		ReportAllocationTest();
+	}
+
+	if (m_numSceneResets > 0)
+	{
+		ReportSceneResets();
+	}
+
+	if (m_fireEverySteps > 0)
+	{
+		ReportProjectiles();
+	}
+
+	if (m_runVehicleThreadBenchmark)
+	{
+		ReportVehicleThreadBenchmark();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ReportInputLatency() const
+{
+	InputLatencyTracker& inputLatency = m_game->GetInputLatencyTracker();
+
+	printf("\n >> Input latency over the last %i samples (%i dropped)", inputLatency.GetNumSamples(), inputLatency.GetNumDroppedSamples());
+	printf("\n >> Sample to apply ms : p50 %f p90 %f p99 %f", inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_APPLY, 50.f),
+		inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_APPLY, 90.f), inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_APPLY, 99.f));
+	printf("\n >> Sample to visible ms : p50 %f p90 %f p99 %f\n", inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_VISIBLE, 50.f),
+		inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_VISIBLE, 90.f), inputLatency.GetPercentileMs(INPUT_LATENCY_SAMPLE_TO_VISIBLE, 99.f));
+
+	if (!m_latencyCSVPath.empty() && !inputLatency.WriteCSV(m_latencyCSVPath))
+	{
+		printf("\n >> Could not write input latency to %s\n", m_latencyCSVPath.c_str());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ReportSceneResets() const
+{
+	double averageMs = (m_totalSceneResetSeconds * 1000.0) / (double)m_numSceneResets;
+	printf("\n >> Scene resets : %i every %i steps, avg %f ms, max %f ms\n", m_numSceneResets, m_resetEverySteps, averageMs, m_maxSceneResetSeconds * 1000.0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ReportProjectiles() const
+{
+	const ProjectilePool& projectilePool = m_game->GetProjectilePool();
+	int numSceneActors = g_PxPhysXSystem->GetPhysXScene()->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC);
+
+	printf("\n >> Projectiles : %i fired, %i recycled, %i despawned, %i of %i live at the end", projectilePool.GetNumFired(), projectilePool.GetNumRecycled(),
+		projectilePool.GetNumDespawned(), projectilePool.GetNumActive(), projectilePool.GetCapacity());
+	printf("\n >> Scene actors at the end : %i\n", numSceneActors);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ReportAllocationTest() const
+{
+	int numCheckedSteps = m_numStepsTaken - m_allocationTestWarmupSteps;
+	numCheckedSteps = numCheckedSteps > 0 ? numCheckedSteps : 0;
+
+	printf("\n >> Allocation test : %s, %i of %i steps after a %i step warm-up allocated from the heap", m_numAllocatingSteps == 0 ? "passed" : "FAILED",
+		m_numAllocatingSteps, numCheckedSteps, m_allocationTestWarmupSteps);
+	printf("\n >> Allocation test counts %s", AllocationCounter::GetCoverageDescription());
+	printf("\n >> Frame arena : %llu of %llu bytes high water, %i overflows\n", (unsigned long long)g_frameArena->GetHighWaterBytes(),
+		(unsigned long long)g_frameArena->GetCapacityBytes(), g_frameArena->GetNumOverflows());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ReportPhysXMemory() const
+{
+	printf("\n >> PhysX memory : live %lld bytes, peak %lld bytes, %lld bytes of pools reserved, %lld shared pool locks", (long long)g_PxPoolAllocator.GetLiveBytes(),
+		(long long)g_PxPoolAllocator.GetPeakBytes(), (long long)g_PxPoolAllocator.GetReservedPoolBytes(), (long long)g_PxPoolAllocator.GetNumSharedPoolLocks());
+
+	if (m_numAIVehicles > 0)
+	{
+		const VehicleArchetypeRegistry& archetypes = m_game->GetVehicleArchetypes();
+		printf("\n >> Vehicle memory : %lld process private bytes per AI car, %i vehicle archetypes", (long long)m_game->GetBytesPerAIVehicle(),
+			archetypes.GetNumArchetypes());
+	}
+
+	std::vector<PhysXAllocationTagStats> tagStats;
+	g_PxPoolAllocator.GetTagStats(tagStats);
+	for (int tagIndex = 0; tagIndex < (int)tagStats.size(); ++tagIndex)
+	{
+		//Rate over the whole run in simulated time, the windowed rate is only sampled by the windowed app
+		double allocationsPerSecond = m_simulatedTime > 0.f ? (double)tagStats[tagIndex].m_numAllocations / m_simulatedTime : 0.0;
+		printf("\n >>   %s : live %lld, peak %lld, %lld allocs, %f allocs/s", tagStats[tagIndex].m_name, (long long)tagStats[tagIndex].m_liveBytes,
+			(long long)tagStats[tagIndex].m_peakBytes, (long long)tagStats[tagIndex].m_numAllocations, allocationsPerSecond);
+	}
+	printf("\n");
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ReportPhysXStats() const
+{
+	const PhysXStatsRecorder& physXStats = m_game->GetPhysXStats();
+	printf("\n >> PhysX stats peaks over the last %i steps :", physXStats.GetNumSamples());
+	for (int counterIndex = 0; counterIndex < NUM_PHYSX_STATS_COUNTERS; ++counterIndex)
+	{
+		ePhysXStatsCounter counter = (ePhysXStatsCounter)counterIndex;
+		printf(" %s %u", PhysXStatsRecorder::GetCounterName(counter), physXStats.GetPeakValue(counter));
+	}
+	printf("\n");
+
+	if (!m_physXStatsCSVPath.empty() && !physXStats.WriteCSV(m_physXStatsCSVPath))
+	{
+		printf("\n >> Could not write PhysX stats to %s\n", m_physXStatsCSVPath.c_str());
+	}
+
+	if (!m_physXStatsBinaryPath.empty() && !physXStats.WriteBinary(m_physXStatsBinaryPath))
+	{
+		printf("\n >> Could not write PhysX stats to %s\n", m_physXStatsBinaryPath.c_str());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HeadlessApp::ReportVehicleThreadBenchmark() const
+{
+	double baseStepMs = 0.0;
+
+	printf("\n >> Vehicle update thread scaling (%i vehicles)", m_game->GetVehicleManager()->GetNumVehicles());
+	printf("\n >> Threads    Steps    ms/step    Speedup");
+
+	for (int passIndex = 0; passIndex < NUM_VEHICLE_BENCHMARK_PASSES; ++passIndex)
+	{
+		int numSteps = m_benchmarkStepsPerPass[passIndex];
+		if (numSteps == 0)
+		{
+			continue;
+		}
+
+		double stepMs = (m_benchmarkUpdateSeconds[passIndex] * 1000.0) / (double)numSteps;
+		if (passIndex == 0)
+		{
+			baseStepMs = stepMs;
+		}
+
+		double speedup = stepMs > 0.0 ? baseStepMs / stepMs : 0.0;
+		printf("\n >> %7i %8i %10.4f %9.2fx", m_benchmarkThreadCounts[passIndex], numSteps, stepMs, speedup);
+	}
+
+	printf("\n");
+}
@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Game/BatchEpisodeRunner.hpp"
+#include "Game/SceneBenchmark.hpp"
+#include "Game/VehicleSweep.hpp"
+#include <string>
+#include <vector>
+
+class CarController;
+class Game;
+
+//Thread counts the vehicle update benchmark steps through, each for an equal share of the run
+constexpr int NUM_VEHICLE_BENCHMARK_PASSES = 5;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One key of the scripted input track used to drive the car when there is no controller attached
+//------------------------------------------------------------------------------------------------------------------------------
+struct ScriptedVehicleInput
+{
+	float								m_startTime = 0.f;
+	float								m_accelerate = 0.f;		//Positive drives forward, negative drives in reverse
+	float								m_steer = 0.f;
+	bool								m_brake = false;
+	bool								m_handbrake = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Runs the PhysX scene without a window, renderer, audio or input system. Render, audio and input globals stay null
+//------------------------------------------------------------------------------------------------------------------------------
+class HeadlessApp
+{
+public:
+	HeadlessApp();
+	~HeadlessApp();
+
+	void								ParseCommandLine(int argc, char** argv);
+	void								StartUp();
+	void								ShutDown();
+	void								RunStep();
+
+	bool								IsQuitting() const { return m_isQuitting; }
+	int									GetExitCode() const { return m_exitCode; }
+
+	//Drives the car from whichever script key is active at simulatedTime, looping every loopSeconds
+	static void							ApplyInputScript(CarController& carController, const std::vector<ScriptedVehicleInput>& inputScript,
+											float loopSeconds, float simulatedTime);
+
+private:
+	void								StepSimulation();
+	void								RunSceneBenchmark();
+	void								RunBatchEpisodes();
+	void								RunVehicleSweep();
+	void								RunInstancePackingCheck();
+	void								CheckSteadyStateAllocations();
+	void								SetupDefaultInputScript();
+	void								ApplyScriptedInputs(float simulatedTime);
+	void								ReportResults() const;
+	void								ReportVehicleThreadBenchmark() const;
+	void								ReportInputLatency() const;
+	void								ReportSceneResets() const;
+	void								ReportProjectiles() const;
+	void								ReportPhysXMemory() const;
+	void								ReportPhysXStats() const;
+	void								ReportAllocationTest() const;
+
+private:
+	bool								m_isQuitting = false;
+	int									m_exitCode = 0;
+
+	Game*								m_game = nullptr;
+
+	int									m_numStepsToRun = 3600;
+	int									m_numStepsTaken = 0;
+	float								m_stepSeconds = 1.f / 60.f;
+	float								m_simulatedTime = 0.f;
+	float								m_scriptLoopSeconds = 0.f;
+	int									m_numAIVehicles = 0;
+	int									m_vehicleUpdateThreads = 1;
+	int									m_vehiclesPerChunk = 16;
+	bool								m_useSceneSnapshot = true;
+	int									m_numBulkObstacles = 0;
+	//Soak test for the projectile pool, 0 never fires
+	int									m_fireEverySteps = 0;
+
+	//Episode resets every m_resetEverySteps steps, 0 runs one long episode
+	int									m_resetEverySteps = 0;
+	int									m_stepsSinceReset = 0;
+	float								m_episodeStartTime = 0.f;
+	int									m_numSceneResets = 0;
+	double								m_totalSceneResetSeconds = 0.0;
+	double								m_maxSceneResetSeconds = 0.0;
+
+	std::string							m_latencyCSVPath;
+	std::string							m_physXStatsCSVPath;
+	std::string							m_physXStatsBinaryPath;
+
+	//Player input recorded from the scripted run, or replayed in place of it
+	std::string							m_recordInputPath;
+	std::string							m_replayInputPath;
+
+	int									m_frameArenaKB = 256;
+	//Steps before every step must run without touching the heap, -1 leaves the allocation test off
+	int									m_allocationTestWarmupSteps = -1;
+	int									m_numAllocatingSteps = 0;
+
+	//Chrome trace of m_numProfileSteps steps starting at m_profileFromStep, -1 never captures
+	int									m_profileFromStep = -1;
+	int									m_numProfileSteps = 60;
+	std::string							m_profileTracePath = "HeadlessProfile.json";
+
+	//Vehicle update thread scaling benchmark
+	bool								m_runVehicleThreadBenchmark = false;
+	int									m_benchmarkPassIndex = -1;
+	int									m_benchmarkThreadCounts[NUM_VEHICLE_BENCHMARK_PASSES] = { 1, 2, 4, 8, 16 };
+	int									m_benchmarkStepsPerPass[NUM_VEHICLE_BENCHMARK_PASSES] = {};
+	double								m_benchmarkUpdateSeconds[NUM_VEHICLE_BENCHMARK_PASSES] = {};
+
+	//Replaces the normal run with one pass over every scene builder
+	bool								m_runSceneBenchmark = false;
+	SceneBenchmarkSettings				m_sceneBenchmarkSettings;
+
+	//Replaces the normal run with many independent copies of the scene stepped across every core
+	BatchEpisodeSettings				m_batchEpisodeSettings;
+
+	//Replaces the normal run with a grid of handling setups driven around a test track
+	bool								m_runVehicleSweep = false;
+	VehicleSweepSettings				m_vehicleSweepSettings;
+	//Empty keeps the Game's own descriptor path
+	std::string							m_vehicleDescriptorPath;
+
+	//Replaces the normal run with one pass of the debug view instance packing over the freshly built scene
+	bool								m_runInstancePackingCheck = false;
+
+	double								m_wallTimeAtStart = 0.0;
+	double								m_wallTimeAtEnd = 0.0;
+
+	std::vector<ScriptedVehicleInput>	m_inputScript;
+};
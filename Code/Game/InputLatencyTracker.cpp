@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/InputLatencyTracker.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/FrameArena.hpp"
+//Standard
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+const int gMaxCompletedLatencySamples = 512;
+
+//------------------------------------------------------------------------------------------------------------------------------
+InputLatencyTracker::InputLatencyTracker()
+{
+	m_completedSamples.reserve(gMaxCompletedLatencySamples);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+InputLatencyTracker::~InputLatencyTracker()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC double InputLatencyTracker::GetTimeSeconds()
+{
+	//Same clock for the windowed game and the headless host
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputLatencyTracker::OnInputSampled(double sampleTime)
+{
+	if (m_hasPendingSample)
+	{
+		m_numDroppedSamples++;
+	}
+
+	m_pendingSample = InputLatencySample();
+	m_pendingSample.m_sampleTime = sampleTime;
+	m_hasPendingSample = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputLatencyTracker::OnInputApplied()
+{
+	if (!m_hasPendingSample)
+	{
+		return;
+	}
+
+	m_pendingSample.m_applyTime = GetTimeSeconds();
+	m_appliedSamples.push_back(m_pendingSample);
+	m_hasPendingSample = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputLatencyTracker::OnPhysicsStepDone()
+{
+	double now = GetTimeSeconds();
+
+	for (int sampleIndex = 0; sampleIndex < (int)m_appliedSamples.size(); ++sampleIndex)
+	{
+		m_appliedSamples[sampleIndex].m_stepDoneTime = now;
+		m_steppedSamples.push_back(m_appliedSamples[sampleIndex]);
+	}
+
+	m_appliedSamples.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputLatencyTracker::OnPoseVisible()
+{
+	double now = GetTimeSeconds();
+
+	for (int sampleIndex = 0; sampleIndex < (int)m_steppedSamples.size(); ++sampleIndex)
+	{
+		InputLatencySample& sample = m_steppedSamples[sampleIndex];
+		sample.m_visibleTime = now;
+		AddCompletedSample(sample);
+	}
+
+	m_steppedSamples.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputLatencyTracker::Reset()
+{
+	m_hasPendingSample = false;
+	m_appliedSamples.clear();
+	m_steppedSamples.clear();
+	m_completedSamples.clear();
+	m_nextCompletedIndex = 0;
+	m_numDroppedSamples = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double InputLatencyTracker::GetPercentileMs(eInputLatencyStage stage, float percentile) const
+{
+	int numSamples = (int)m_completedSamples.size();
+	if (numSamples == 0)
+	{
+		return 0.0;
+	}
+
+	//Queried several times a frame by the ImGui panel, so the scratch copy comes from the frame arena
+	double* stageSeconds = g_frameArena->AllocateArray<double>(numSamples);
+	for (int sampleIndex = 0; sampleIndex < numSamples; ++sampleIndex)
+	{
+		stageSeconds[sampleIndex] = GetStageSeconds(m_completedSamples[sampleIndex], stage);
+	}
+
+	//Nearest rank
+	int rank = (int)(percentile * 0.01f * (float)(numSamples - 1) + 0.5f);
+	if (rank < 0)
+	{
+		rank = 0;
+	}
+	else if (rank > numSamples - 1)
+	{
+		rank = numSamples - 1;
+	}
+	std::nth_element(stageSeconds, stageSeconds + rank, stageSeconds + numSamples);
+
+	return stageSeconds[rank] * 1000.0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool InputLatencyTracker::WriteCSV(const std::string& filePath) const
+{
+	std::ofstream file(filePath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "sampleTime,sampleToApplyMs,applyToVisibleMs,sampleToVisibleMs\n";
+
+	//Oldest first once the ring buffer has wrapped
+	int numSamples = (int)m_completedSamples.size();
+	int firstIndex = numSamples < gMaxCompletedLatencySamples ? 0 : m_nextCompletedIndex;
+	for (int offset = 0; offset < numSamples; ++offset)
+	{
+		const InputLatencySample& sample = m_completedSamples[(firstIndex + offset) % numSamples];
+		file << sample.m_sampleTime << ","
+			<< GetStageSeconds(sample, INPUT_LATENCY_SAMPLE_TO_APPLY) * 1000.0 << ","
+			<< GetStageSeconds(sample, INPUT_LATENCY_APPLY_TO_VISIBLE) * 1000.0 << ","
+			<< GetStageSeconds(sample, INPUT_LATENCY_SAMPLE_TO_VISIBLE) * 1000.0 << "\n";
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC double InputLatencyTracker::GetStageSeconds(const InputLatencySample& sample, eInputLatencyStage stage)
+{
+	switch (stage)
+	{
+	case INPUT_LATENCY_SAMPLE_TO_APPLY:
+		return sample.m_applyTime - sample.m_sampleTime;
+	case INPUT_LATENCY_APPLY_TO_VISIBLE:
+		return sample.m_visibleTime - sample.m_applyTime;
+	case INPUT_LATENCY_SAMPLE_TO_VISIBLE:
+		return sample.m_visibleTime - sample.m_sampleTime;
+	default:
+		return 0.0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InputLatencyTracker::AddCompletedSample(const InputLatencySample& sample)
+{
+	if ((int)m_completedSamples.size() < gMaxCompletedLatencySamples)
+	{
+		m_completedSamples.push_back(sample);
+	}
+	else
+	{
+		m_completedSamples[m_nextCompletedIndex] = sample;
+	}
+
+	m_nextCompletedIndex = (m_nextCompletedIndex + 1) % gMaxCompletedLatencySamples;
+}
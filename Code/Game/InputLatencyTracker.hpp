@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Standard
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One controller sample followed through the pipeline. Times are seconds on the tracker's own clock
+//------------------------------------------------------------------------------------------------------------------------------
+struct InputLatencySample
+{
+	double								m_sampleTime = 0.0;		//Controller state polled
+	double								m_applyTime = 0.0;		//Raw input smoothed into the vehicle
+	double								m_stepDoneTime = 0.0;	//Physics step that used it has been fetched
+	double								m_visibleTime = 0.0;	//First frame drawn with the resulting pose
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eInputLatencyStage
+{
+	INPUT_LATENCY_SAMPLE_TO_APPLY,
+	INPUT_LATENCY_APPLY_TO_VISIBLE,
+	INPUT_LATENCY_SAMPLE_TO_VISIBLE,
+
+	NUM_INPUT_LATENCY_STAGES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Timestamps input sample -> physics apply -> pose visible for the player car and keeps the last few hundred results
+// for percentiles. Samples that are overwritten before any physics step consumes them count as dropped
+//------------------------------------------------------------------------------------------------------------------------------
+class InputLatencyTracker
+{
+public:
+	InputLatencyTracker();
+	~InputLatencyTracker();
+
+	static double						GetTimeSeconds();
+
+	//sampleTime is when the OS or script input was read, on GetTimeSeconds. It rides with the sample until a step applies it
+	void								OnInputSampled(double sampleTime);
+	void								OnInputApplied();
+	void								OnPhysicsStepDone();
+	void								OnPoseVisible();
+
+	void								Reset();
+
+	int									GetNumSamples() const { return (int)m_completedSamples.size(); }
+	int									GetNumDroppedSamples() const { return m_numDroppedSamples; }
+	double								GetPercentileMs(eInputLatencyStage stage, float percentile) const;
+
+	bool								WriteCSV(const std::string& filePath) const;
+
+private:
+	static double						GetStageSeconds(const InputLatencySample& sample, eInputLatencyStage stage);
+	void								AddCompletedSample(const InputLatencySample& sample);
+
+private:
+	//Latest controller read not yet consumed by a physics step
+	InputLatencySample					m_pendingSample;
+	bool								m_hasPendingSample = false;
+
+	//Applied, waiting on the step to finish and then on a frame to show it
+	std::vector<InputLatencySample>		m_appliedSamples;
+	std::vector<InputLatencySample>		m_steppedSamples;
+
+	//Ring buffer of finished samples
+	std::vector<InputLatencySample>		m_completedSamples;
+	int									m_nextCompletedIndex = 0;
+	int									m_numDroppedSamples = 0;
+};
@@ -0,0 +1,35 @@
+//------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the headless simulation host. No Win32 window, D3D11 device, audio or input is created here
+//------------------------------------------------------------------------------------------------------------------------------
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/GameCommon.hpp"
+#include "Game/HeadlessApp.hpp"
+
+class WindowContext;
+
+extern HeadlessApp* g_theHeadlessApp;
+
+//Defined by Main_Windows.cpp in the windowed build. Stays null here since nothing on the headless path uses a window
+WindowContext* g_windowContext = nullptr;
+
+//------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	g_theHeadlessApp = new HeadlessApp();
+	g_theHeadlessApp->ParseCommandLine(argc, argv);
+	g_theHeadlessApp->StartUp();
+
+	while (!g_theHeadlessApp->IsQuitting())
+	{
+		g_theHeadlessApp->RunStep();
+	}
+
+	int exitCode = g_theHeadlessApp->GetExitCode();
+
+	delete g_theHeadlessApp;
+	g_theHeadlessApp = nullptr;
+
+	return exitCode;
+}
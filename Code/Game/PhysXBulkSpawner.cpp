@@ -0,0 +1,169 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXBulkSpawner.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXBulkSpawner::PhysXBulkSpawner(PxPhysics& physX)
+	: m_physX(physX)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXBulkSpawner::~PhysXBulkSpawner()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxShape* PhysXBulkSpawner::GetSharedShape(const PxGeometry& geometry, PxMaterial& material, const PxFilterData& simFilterData, const PxFilterData& queryFilterData)
+{
+	//Only a handful of distinct shapes per scene, a linear search beats hashing geometry unions
+	for (int shapeIndex = 0; shapeIndex < (int)m_sharedShapes.size(); ++shapeIndex)
+	{
+		const PhysXSharedShape& sharedShape = m_sharedShapes[shapeIndex];
+		if (sharedShape.m_material == &material && IsSameGeometry(sharedShape.m_geometry, geometry)
+			&& IsSameFilterData(sharedShape.m_simFilterData, simFilterData) && IsSameFilterData(sharedShape.m_queryFilterData, queryFilterData))
+		{
+			return sharedShape.m_shape;
+		}
+	}
+
+	PhysXSharedShape sharedShape;
+	sharedShape.m_shape = m_physX.createShape(geometry, material, false);
+	sharedShape.m_shape->setSimulationFilterData(simFilterData);
+	sharedShape.m_shape->setQueryFilterData(queryFilterData);
+	sharedShape.m_geometry.storeAny(geometry);
+	sharedShape.m_material = &material;
+	sharedShape.m_simFilterData = simFilterData;
+	sharedShape.m_queryFilterData = queryFilterData;
+
+	m_sharedShapes.push_back(sharedShape);
+	return sharedShape.m_shape;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXBulkSpawner::AddStatics(PxShape& shape, const PxTransform* poses, int numPoses)
+{
+	m_pendingStatics.reserve(m_pendingStatics.size() + numPoses);
+
+	for (int poseIndex = 0; poseIndex < numPoses; ++poseIndex)
+	{
+		PxRigidStatic* rigidStatic = m_physX.createRigidStatic(poses[poseIndex]);
+		rigidStatic->attachShape(shape);
+		m_pendingStatics.push_back(rigidStatic);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXBulkSpawner::AddDynamics(PxShape& shape, const PxTransform* poses, int numPoses, float density, bool startAsleep)
+{
+	if (numPoses == 0)
+	{
+		return;
+	}
+
+	m_pendingDynamics.reserve(m_pendingDynamics.size() + numPoses);
+
+	//Same shape means same mass properties, so integrate them once and copy
+	PxRigidDynamic* firstDynamic = m_physX.createRigidDynamic(poses[0]);
+	firstDynamic->attachShape(shape);
+	PxRigidBodyExt::updateMassAndInertia(*firstDynamic, density);
+
+	PxReal mass = firstDynamic->getMass();
+	PxVec3 inertia = firstDynamic->getMassSpaceInertiaTensor();
+	PxTransform centerOfMass = firstDynamic->getCMassLocalPose();
+
+	m_pendingDynamics.push_back(firstDynamic);
+	if (startAsleep)
+	{
+		m_pendingSleepers.push_back(firstDynamic);
+	}
+
+	for (int poseIndex = 1; poseIndex < numPoses; ++poseIndex)
+	{
+		PxRigidDynamic* rigidDynamic = m_physX.createRigidDynamic(poses[poseIndex]);
+		rigidDynamic->attachShape(shape);
+		rigidDynamic->setMass(mass);
+		rigidDynamic->setMassSpaceInertiaTensor(inertia);
+		rigidDynamic->setCMassLocalPose(centerOfMass);
+
+		m_pendingDynamics.push_back(rigidDynamic);
+		if (startAsleep)
+		{
+			m_pendingSleepers.push_back(rigidDynamic);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXBulkSpawner::Flush(PxScene& pxScene)
+{
+	if (!m_pendingStatics.empty())
+	{
+		//The scene adopts the prebuilt AABB tree instead of inserting statics one by one
+		PxPruningStructure* pruningStructure = m_physX.createPruningStructure(&m_pendingStatics[0], (PxU32)m_pendingStatics.size());
+		if (pruningStructure != nullptr)
+		{
+			pxScene.addActors(*pruningStructure);
+			pruningStructure->release();
+		}
+		else
+		{
+			pxScene.addActors(reinterpret_cast<PxActor* const*>(&m_pendingStatics[0]), (PxU32)m_pendingStatics.size());
+		}
+	}
+
+	if (!m_pendingDynamics.empty())
+	{
+		pxScene.addActors(&m_pendingDynamics[0], (PxU32)m_pendingDynamics.size());
+	}
+
+	//Sleeping needs a scene, so it waits until the actors are in one
+	for (int sleeperIndex = 0; sleeperIndex < (int)m_pendingSleepers.size(); ++sleeperIndex)
+	{
+		m_pendingSleepers[sleeperIndex]->putToSleep();
+	}
+
+	m_numActorsFlushed += (int)(m_pendingStatics.size() + m_pendingDynamics.size());
+
+	m_pendingStatics.clear();
+	m_pendingDynamics.clear();
+	m_pendingSleepers.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool PhysXBulkSpawner::IsSameGeometry(const PxGeometryHolder& lhs, const PxGeometry& rhs)
+{
+	if (lhs.getType() != rhs.getType())
+	{
+		return false;
+	}
+
+	switch (rhs.getType())
+	{
+	case PxGeometryType::eSPHERE:
+		return lhs.sphere().radius == static_cast<const PxSphereGeometry&>(rhs).radius;
+	case PxGeometryType::eCAPSULE:
+	{
+		const PxCapsuleGeometry& capsule = static_cast<const PxCapsuleGeometry&>(rhs);
+		return lhs.capsule().radius == capsule.radius && lhs.capsule().halfHeight == capsule.halfHeight;
+	}
+	case PxGeometryType::eBOX:
+		return lhs.box().halfExtents == static_cast<const PxBoxGeometry&>(rhs).halfExtents;
+	case PxGeometryType::eCONVEXMESH:
+	{
+		const PxConvexMeshGeometry& convex = static_cast<const PxConvexMeshGeometry&>(rhs);
+		return lhs.convexMesh().convexMesh == convex.convexMesh && lhs.convexMesh().scale.scale == convex.scale.scale
+			&& lhs.convexMesh().scale.rotation == convex.scale.rotation;
+	}
+	default:
+		//Meshes, heightfields and planes are rare enough that they just get their own shape
+		return false;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool PhysXBulkSpawner::IsSameFilterData(const PxFilterData& lhs, const PxFilterData& rhs)
+{
+	return lhs.word0 == rhs.word0 && lhs.word1 == rhs.word1 && lhs.word2 == rhs.word2 && lhs.word3 == rhs.word3;
+}
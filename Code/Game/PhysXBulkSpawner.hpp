@@ -0,0 +1,54 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <vector>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXSharedShape
+{
+	PxShape*							m_shape = nullptr;
+	PxGeometryHolder					m_geometry;
+	PxMaterial*							m_material = nullptr;
+	PxFilterData						m_simFilterData;
+	PxFilterData						m_queryFilterData;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Creates actors in bulk. Every actor with the same geometry, material and filter data attaches one shared PxShape,
+// bodies that share a shape share one mass computation, and nothing touches the scene until Flush inserts all statics
+// through a single prebuilt PxPruningStructure and all dynamics through a single addActors call.
+// Shared shapes keep their creation reference, which goes to whoever releases the spawned scene content
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXBulkSpawner
+{
+public:
+	explicit PhysXBulkSpawner(PxPhysics& physX);
+	~PhysXBulkSpawner();
+
+	PxShape*							GetSharedShape(const PxGeometry& geometry, PxMaterial& material, const PxFilterData& simFilterData, const PxFilterData& queryFilterData);
+
+	void								AddStatics(PxShape& shape, const PxTransform* poses, int numPoses);
+	void								AddDynamics(PxShape& shape, const PxTransform* poses, int numPoses, float density, bool startAsleep = false);
+
+	void								Flush(PxScene& pxScene);
+
+	int									GetNumSharedShapes() const { return (int)m_sharedShapes.size(); }
+	int									GetNumActorsFlushed() const { return m_numActorsFlushed; }
+
+private:
+	static bool							IsSameGeometry(const PxGeometryHolder& lhs, const PxGeometry& rhs);
+	static bool							IsSameFilterData(const PxFilterData& lhs, const PxFilterData& rhs);
+
+private:
+	PxPhysics&							m_physX;
+	std::vector<PhysXSharedShape>		m_sharedShapes;
+
+	std::vector<PxRigidActor*>			m_pendingStatics;
+	std::vector<PxActor*>				m_pendingDynamics;
+	std::vector<PxRigidDynamic*>		m_pendingSleepers;
+	int									m_numActorsFlushed = 0;
+};
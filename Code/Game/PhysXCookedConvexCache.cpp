@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXCookedConvexCache.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/PhysXPoolAllocator.hpp"
+//Standard
+#include <chrono>
+#include <fstream>
+#include <stdio.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Bump the version whenever the file layout or the cooking flags below change so stale files are never read
+const PxU32 gCookedConvexMagic = 0x43435850;	//"PXCC"
+const PxU32 gCookedConvexVersion = 1;
+
+PhysXTaggedAllocator gCookedStreamAllocator(g_PxPoolAllocator, "PxCookedConvexStream");
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct CookedConvexHeader
+{
+	PxU32								m_magic = gCookedConvexMagic;
+	PxU32								m_version = gCookedConvexVersion;
+	PxU32								m_physXVersion = PX_PHYSICS_VERSION;
+	float								m_cookSeconds = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static double GetCacheTimeSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// 64 bit FNV-1a, stable across runs and platforms which std::hash is not
+//------------------------------------------------------------------------------------------------------------------------------
+static void HashBytes(PxU64& hash, const void* data, size_t numBytes)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t byteIndex = 0; byteIndex < numBytes; ++byteIndex)
+	{
+		hash ^= bytes[byteIndex];
+		hash *= 1099511628211ULL;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXCookedConvexCache::PhysXCookedConvexCache(const std::string& cacheFolder)
+	: m_cacheFolder(cacheFolder)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXCookedConvexCache::~PhysXCookedConvexCache()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxConvexMesh* PhysXCookedConvexCache::CreateConvexMesh(const PxVec3* points, int numPoints, PxU16 vertexLimit, PxPhysics& physX, PxCooking& pxCooking)
+{
+	PxU64 key = ComputeKey(points, numPoints, vertexLimit, pxCooking.getParams());
+	std::string cachePath = GetCachePath(key);
+
+	PxConvexMesh* convexMesh = LoadConvexMesh(cachePath, physX);
+	if (convexMesh != nullptr)
+	{
+		m_numHits++;
+		return convexMesh;
+	}
+
+	m_numMisses++;
+
+	double cookStart = GetCacheTimeSeconds();
+
+	PxConvexMeshDesc convexDesc;
+	convexDesc.points.count = numPoints;
+	convexDesc.points.stride = sizeof(PxVec3);
+	convexDesc.points.data = points;
+	convexDesc.flags = PxConvexFlag::eCOMPUTE_CONVEX;
+	convexDesc.vertexLimit = vertexLimit;
+
+	PxDefaultMemoryOutputStream cookedStream(gCookedStreamAllocator);
+	if (!pxCooking.cookConvexMesh(convexDesc, cookedStream))
+	{
+		ERROR_AND_DIE("Failed to cook convex mesh");
+	}
+
+	PxDefaultMemoryInputData cookedInput(cookedStream.getData(), cookedStream.getSize());
+	convexMesh = physX.createConvexMesh(cookedInput);
+
+	double cookSeconds = GetCacheTimeSeconds() - cookStart;
+	m_secondsCooking += cookSeconds;
+
+	SaveConvexMesh(cachePath, cookedStream, (float)cookSeconds);
+
+	return convexMesh;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxU64 PhysXCookedConvexCache::ComputeKey(const PxVec3* points, int numPoints, PxU16 vertexLimit, const PxCookingParams& cookingParams) const
+{
+	PxU64 hash = 14695981039346656037ULL;
+
+	HashBytes(hash, &gCookedConvexVersion, sizeof(gCookedConvexVersion));
+	HashBytes(hash, &vertexLimit, sizeof(vertexLimit));
+
+	//Only the cooking settings that change convex output
+	HashBytes(hash, &cookingParams.areaTestEpsilon, sizeof(cookingParams.areaTestEpsilon));
+	HashBytes(hash, &cookingParams.planeTolerance, sizeof(cookingParams.planeTolerance));
+	HashBytes(hash, &cookingParams.convexMeshCookingType, sizeof(cookingParams.convexMeshCookingType));
+	HashBytes(hash, &cookingParams.gaussMapLimit, sizeof(cookingParams.gaussMapLimit));
+	HashBytes(hash, &cookingParams.buildGPUData, sizeof(cookingParams.buildGPUData));
+	HashBytes(hash, &cookingParams.scale.length, sizeof(cookingParams.scale.length));
+	HashBytes(hash, &cookingParams.scale.speed, sizeof(cookingParams.scale.speed));
+
+	HashBytes(hash, &numPoints, sizeof(numPoints));
+	HashBytes(hash, points, sizeof(PxVec3) * numPoints);
+
+	return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+std::string PhysXCookedConvexCache::GetCachePath(PxU64 key) const
+{
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.pxcc", (unsigned long long)key);
+	return m_cacheFolder + fileName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxConvexMesh* PhysXCookedConvexCache::LoadConvexMesh(const std::string& cachePath, PxPhysics& physX)
+{
+	double loadStart = GetCacheTimeSeconds();
+
+	std::ifstream file(cachePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return nullptr;
+	}
+
+	std::streamoff fileSize = file.tellg();
+	if (fileSize <= (std::streamoff)sizeof(CookedConvexHeader))
+	{
+		return nullptr;
+	}
+
+	std::vector<unsigned char> fileData((size_t)fileSize);
+	file.seekg(0, std::ios::beg);
+	file.read(reinterpret_cast<char*>(&fileData[0]), fileSize);
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	CookedConvexHeader header;
+	memcpy(&header, &fileData[0], sizeof(header));
+
+	//Anything written by another version is treated as a miss and overwritten
+	if (header.m_magic != gCookedConvexMagic || header.m_version != gCookedConvexVersion || header.m_physXVersion != PX_PHYSICS_VERSION)
+	{
+		return nullptr;
+	}
+
+	PxDefaultMemoryInputData cookedInput(&fileData[sizeof(header)], (PxU32)(fileSize - sizeof(header)));
+	PxConvexMesh* convexMesh = physX.createConvexMesh(cookedInput);
+	if (convexMesh == nullptr)
+	{
+		return nullptr;
+	}
+
+	double loadSeconds = GetCacheTimeSeconds() - loadStart;
+	m_secondsLoading += loadSeconds;
+	m_secondsSaved += (double)header.m_cookSeconds - loadSeconds;
+
+	return convexMesh;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXCookedConvexCache::SaveConvexMesh(const std::string& cachePath, const PxDefaultMemoryOutputStream& cookedStream, float cookSeconds) const
+{
+	PxDefaultFileOutputStream file(cachePath.c_str());
+	if (!file.isValid())
+	{
+		//A read-only data folder just means every start is a cold start
+		return;
+	}
+
+	CookedConvexHeader header;
+	header.m_cookSeconds = cookSeconds;
+
+	file.write(&header, sizeof(header));
+	file.write(cookedStream.getData(), cookedStream.getSize());
+}
@@ -0,0 +1,44 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <string>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Cooked convex meshes keyed by a hash of their input points and cooking settings. A hit loads the stream from disk and
+// skips PxCooking entirely, a miss cooks and writes the stream out for the next start
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXCookedConvexCache
+{
+public:
+	explicit PhysXCookedConvexCache(const std::string& cacheFolder);
+	~PhysXCookedConvexCache();
+
+	PxConvexMesh*						CreateConvexMesh(const PxVec3* points, int numPoints, PxU16 vertexLimit, PxPhysics& physX, PxCooking& pxCooking);
+
+	int									GetNumHits() const { return m_numHits; }
+	int									GetNumMisses() const { return m_numMisses; }
+	double								GetSecondsCooking() const { return m_secondsCooking; }
+	double								GetSecondsLoading() const { return m_secondsLoading; }
+	//Cook time recorded with each hit minus what loading it took
+	double								GetSecondsSaved() const { return m_secondsSaved; }
+
+private:
+	PxU64								ComputeKey(const PxVec3* points, int numPoints, PxU16 vertexLimit, const PxCookingParams& cookingParams) const;
+	std::string							GetCachePath(PxU64 key) const;
+
+	PxConvexMesh*						LoadConvexMesh(const std::string& cachePath, PxPhysics& physX);
+	void								SaveConvexMesh(const std::string& cachePath, const PxDefaultMemoryOutputStream& cookedStream, float cookSeconds) const;
+
+private:
+	std::string							m_cacheFolder;
+
+	int									m_numHits = 0;
+	int									m_numMisses = 0;
+	double								m_secondsCooking = 0.0;
+	double								m_secondsLoading = 0.0;
+	double								m_secondsSaved = 0.0;
+};
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXInstanceBatch.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXInstanceBatch::PhysXInstanceBatch()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXInstanceBatch::~PhysXInstanceBatch()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxVec3 PhysXInstanceBatch::GetUnitMeshScale(const PxGeometryHolder& geometry)
+{
+	switch (geometry.getType())
+	{
+	case PxGeometryType::eBOX:
+		return geometry.box().halfExtents;
+	case PxGeometryType::eSPHERE:
+	{
+		float radius = geometry.sphere().radius;
+		return PxVec3(radius, radius, radius);
+	}
+	case PxGeometryType::eCONVEXMESH:
+		//Mesh scale rotation isn't supported, none of our convex shapes use one
+		return geometry.convexMesh().scale.scale;
+	default:
+		return PxVec3(1.f, 1.f, 1.f);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void PhysXInstanceBatch::PackInstance(PhysXShapeInstance& instance, const PxTransform& pose, const PxVec3& scale)
+{
+	PxMat33 rotation(pose.q);
+	PxVec3 iBasis = rotation.column0 * scale.x;
+	PxVec3 jBasis = rotation.column1 * scale.y;
+	PxVec3 kBasis = rotation.column2 * scale.z;
+
+	instance.m_basis[0] = iBasis.x;
+	instance.m_basis[1] = iBasis.y;
+	instance.m_basis[2] = iBasis.z;
+
+	instance.m_basis[3] = jBasis.x;
+	instance.m_basis[4] = jBasis.y;
+	instance.m_basis[5] = jBasis.z;
+
+	instance.m_basis[6] = kBasis.x;
+	instance.m_basis[7] = kBasis.y;
+	instance.m_basis[8] = kBasis.z;
+
+	instance.m_basis[9] = pose.p.x;
+	instance.m_basis[10] = pose.p.y;
+	instance.m_basis[11] = pose.p.z;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXInstanceBatch::Clear()
+{
+	for (int slotIndex = 0; slotIndex < (int)m_instancesPerSlot.size(); ++slotIndex)
+	{
+		m_instancesPerSlot[slotIndex].clear();
+	}
+
+	m_totalInstanceCount = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXInstanceBatch::AddInstance(int meshSlot, const PxTransform& pose, const PxVec3& scale)
+{
+	if (meshSlot >= (int)m_instancesPerSlot.size())
+	{
+		m_instancesPerSlot.resize(meshSlot + 1);
+	}
+
+	std::vector<PhysXShapeInstance>& instances = m_instancesPerSlot[meshSlot];
+	instances.emplace_back();
+	PackInstance(instances.back(), pose, scale);
+
+	m_totalInstanceCount++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int PhysXInstanceBatch::GetNumInstances(int meshSlot) const
+{
+	if (meshSlot < 0 || meshSlot >= (int)m_instancesPerSlot.size())
+	{
+		return 0;
+	}
+
+	return (int)m_instancesPerSlot[meshSlot].size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const PhysXShapeInstance* PhysXInstanceBatch::GetInstances(int meshSlot) const
+{
+	if (GetNumInstances(meshSlot) == 0)
+	{
+		return nullptr;
+	}
+
+	return &m_instancesPerSlot[meshSlot][0];
+}
@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <vector>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One drawn shape, the scaled I, J, K basis followed by the translation. Colour lives in the unit mesh vertices, awake and
+// sleeping shapes go to different mesh slots
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXShapeInstance
+{
+	float								m_basis[12];
+};
+
+static_assert(sizeof(PhysXShapeInstance) == 48, "PhysXShapeInstance is expected to be 4 x float3");
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Per-frame instance data for the PhysX debug view, bucketed by unit mesh slot. This is not GPU instancing: the Engine's
+// RenderContext has no instanced draw or instance buffer, so the renderer expands every instance to a model matrix and one
+// draw. What it saves is the per-shape mesh rebuild. Boxes, spheres and capsules share unit meshes and single shape convex
+// actors reuse one mesh per convex, while multi shape convex actors (the cars) stay on RenderPhysXCar's per-frame rebake.
+// Has no renderer dependency so it can be filled and checked without a window
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXInstanceBatch
+{
+public:
+	PhysXInstanceBatch();
+	~PhysXInstanceBatch();
+
+	//Boxes and spheres share one unit mesh scaled per instance, capsules and convex meshes are built at size
+	static PxVec3						GetUnitMeshScale(const PxGeometryHolder& geometry);
+	static void							PackInstance(PhysXShapeInstance& instance, const PxTransform& pose, const PxVec3& scale);
+
+	void								Clear();
+	void								AddInstance(int meshSlot, const PxTransform& pose, const PxVec3& scale);
+
+	int									GetNumSlots() const { return (int)m_instancesPerSlot.size(); }
+	int									GetNumInstances(int meshSlot) const;
+	const PhysXShapeInstance*			GetInstances(int meshSlot) const;
+
+	int									GetTotalInstanceCount() const { return m_totalInstanceCount; }
+	//What an instance buffer for this frame would hold, nothing is uploaded today
+	int									GetPackedSizeBytes() const { return m_totalInstanceCount * (int)sizeof(PhysXShapeInstance); }
+
+private:
+	//Buckets are cleared, not freed, so a steady scene stops allocating after the first few frames
+	std::vector<std::vector<PhysXShapeInstance>>	m_instancesPerSlot;
+	int									m_totalInstanceCount = 0;
+};
@@ -0,0 +1,437 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXPoolAllocator.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/PlatformMemory.hpp"
+//Standard
+#include <algorithm>
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXPoolAllocator g_PxPoolAllocator;
+
+//PhysX requires 16 byte alignment for everything it allocates
+const size_t gPhysXAllocationAlignment = 16;
+const size_t gPoolSlabBytes = 64 * 1024;
+const size_t gSmallestSizeClassBytes = 32;
+
+//Blocks moved between a thread cache and the shared pools at a time, and how many a thread holds before giving some back
+const int gThreadCacheBatchSize = 32;
+const int gThreadCacheMaxBlocks = 64;
+
+const uint32_t gLargeAllocationClass = 0xFFFFFFFF;
+const float gRateSampleSeconds = 1.f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXFreeBlock
+{
+	PhysXFreeBlock*						m_next = nullptr;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Sits in front of every block handed out, padded so the payload after it keeps the 16 byte alignment
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXAllocationHeader
+{
+	uint32_t							m_sizeClass = 0;
+	uint32_t							m_tagIndex = 0;
+	uint64_t							m_size = 0;
+};
+static_assert(sizeof(PhysXAllocationHeader) == gPhysXAllocationAlignment, "Allocation header must keep the payload 16 byte aligned");
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXThreadCache
+{
+	PhysXFreeBlock*						m_freeLists[PhysXPoolAllocator::NUM_SIZE_CLASSES] = {};
+	int									m_numFree[PhysXPoolAllocator::NUM_SIZE_CLASSES] = {};
+
+	~PhysXThreadCache()
+	{
+		//Worker threads exit before the allocator does, so whatever they cached goes back to the shared pools
+		for (int sizeClass = 0; sizeClass < PhysXPoolAllocator::NUM_SIZE_CLASSES; ++sizeClass)
+		{
+			PhysXFreeBlock* head = m_freeLists[sizeClass];
+			if (head == nullptr)
+			{
+				continue;
+			}
+
+			PhysXFreeBlock* tail = head;
+			while (tail->m_next != nullptr)
+			{
+				tail = tail->m_next;
+			}
+
+			g_PxPoolAllocator.ReturnSharedBlocks(sizeClass, head, tail, m_numFree[sizeClass]);
+			m_freeLists[sizeClass] = nullptr;
+			m_numFree[sizeClass] = 0;
+		}
+	}
+};
+
+thread_local PhysXThreadCache tl_physXThreadCache;
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXPoolAllocator::PhysXPoolAllocator()
+{
+	for (int sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+	{
+		m_sharedFreeLists[sizeClass] = nullptr;
+	}
+
+	for (int slotIndex = 0; slotIndex < NUM_TAG_LOOKUP_SLOTS; ++slotIndex)
+	{
+		m_tagLookupKeys[slotIndex].store(nullptr, std::memory_order_relaxed);
+		m_tagLookupIndices[slotIndex].store(0, std::memory_order_relaxed);
+	}
+
+	//Tag 0 catches callers that pass no typeName
+	m_tags[0].m_name = "Untagged";
+	m_numTags = 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXPoolAllocator::~PhysXPoolAllocator()
+{
+	for (int slabIndex = 0; slabIndex < (int)m_slabs.size(); ++slabIndex)
+	{
+		PlatformMemory::AlignedFree(m_slabs[slabIndex]);
+	}
+	m_slabs.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* PhysXPoolAllocator::allocate(size_t size, const char* typeName, const char* filename, int line)
+{
+	UNUSED(filename);
+	UNUSED(line);
+
+	size_t blockSize = size + sizeof(PhysXAllocationHeader);
+	int sizeClass = GetSizeClass(blockSize);
+
+	PhysXAllocationHeader* header = nullptr;
+	if (sizeClass < 0)
+	{
+		header = reinterpret_cast<PhysXAllocationHeader*>(PlatformMemory::AlignedAllocate(blockSize, gPhysXAllocationAlignment));
+		if (header == nullptr)
+		{
+			return nullptr;
+		}
+		header->m_sizeClass = gLargeAllocationClass;
+	}
+	else
+	{
+		PhysXThreadCache& threadCache = tl_physXThreadCache;
+		if (threadCache.m_freeLists[sizeClass] == nullptr)
+		{
+			int numTaken = 0;
+			threadCache.m_freeLists[sizeClass] = TakeSharedBlocks(sizeClass, gThreadCacheBatchSize, numTaken);
+			threadCache.m_numFree[sizeClass] = numTaken;
+		}
+
+		PhysXFreeBlock* block = threadCache.m_freeLists[sizeClass];
+		threadCache.m_freeLists[sizeClass] = block->m_next;
+		threadCache.m_numFree[sizeClass]--;
+
+		header = reinterpret_cast<PhysXAllocationHeader*>(block);
+		header->m_sizeClass = (uint32_t)sizeClass;
+	}
+
+	header->m_tagIndex = FindOrAddTag(typeName);
+	header->m_size = size;
+	RecordAllocation(header->m_tagIndex, (int64_t)size);
+
+	return header + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoolAllocator::deallocate(void* ptr)
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	PhysXAllocationHeader* header = reinterpret_cast<PhysXAllocationHeader*>(ptr) - 1;
+	RecordFree(header->m_tagIndex, (int64_t)header->m_size);
+
+	if (header->m_sizeClass == gLargeAllocationClass)
+	{
+		PlatformMemory::AlignedFree(header);
+		return;
+	}
+
+	int sizeClass = (int)header->m_sizeClass;
+	PhysXThreadCache& threadCache = tl_physXThreadCache;
+
+	PhysXFreeBlock* block = reinterpret_cast<PhysXFreeBlock*>(header);
+	block->m_next = threadCache.m_freeLists[sizeClass];
+	threadCache.m_freeLists[sizeClass] = block;
+	threadCache.m_numFree[sizeClass]++;
+
+	if (threadCache.m_numFree[sizeClass] > gThreadCacheMaxBlocks)
+	{
+		//Hand a batch back so a thread that only frees (the main thread releasing worker allocations) doesn't hoard blocks
+		PhysXFreeBlock* head = threadCache.m_freeLists[sizeClass];
+		PhysXFreeBlock* tail = head;
+		for (int blockIndex = 1; blockIndex < gThreadCacheBatchSize; ++blockIndex)
+		{
+			tail = tail->m_next;
+		}
+
+		threadCache.m_freeLists[sizeClass] = tail->m_next;
+		threadCache.m_numFree[sizeClass] -= gThreadCacheBatchSize;
+		tail->m_next = nullptr;
+
+		ReturnSharedBlocks(sizeClass, head, tail, gThreadCacheBatchSize);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoolAllocator::UpdateRates(float deltaSeconds)
+{
+	m_secondsSinceRateSample += deltaSeconds;
+	if (m_secondsSinceRateSample < gRateSampleSeconds)
+	{
+		return;
+	}
+
+	int numTags = m_numTags.load(std::memory_order_acquire);
+	for (int tagIndex = 0; tagIndex < numTags; ++tagIndex)
+	{
+		AllocationTag& tag = m_tags[tagIndex];
+		int64_t numAllocations = tag.m_numAllocations.load(std::memory_order_relaxed);
+
+		tag.m_allocationsPerSecond = (float)(numAllocations - tag.m_numAllocationsAtLastSample) / m_secondsSinceRateSample;
+		tag.m_numAllocationsAtLastSample = numAllocations;
+	}
+
+	m_secondsSinceRateSample = 0.f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoolAllocator::GetTagStats(std::vector<PhysXAllocationTagStats>& tagStats) const
+{
+	tagStats.clear();
+
+	int numTags = m_numTags.load(std::memory_order_acquire);
+	for (int tagIndex = 0; tagIndex < numTags; ++tagIndex)
+	{
+		const AllocationTag& tag = m_tags[tagIndex];
+		if (tag.m_numAllocations.load(std::memory_order_relaxed) == 0)
+		{
+			continue;
+		}
+
+		PhysXAllocationTagStats stats;
+		stats.m_name = tag.m_name.load(std::memory_order_relaxed);
+		stats.m_liveBytes = tag.m_liveBytes.load(std::memory_order_relaxed);
+		stats.m_peakBytes = tag.m_peakBytes.load(std::memory_order_relaxed);
+		stats.m_numAllocations = tag.m_numAllocations.load(std::memory_order_relaxed);
+		stats.m_numFrees = tag.m_numFrees.load(std::memory_order_relaxed);
+		stats.m_allocationsPerSecond = tag.m_allocationsPerSecond;
+		tagStats.push_back(stats);
+	}
+
+	std::sort(tagStats.begin(), tagStats.end(), [](const PhysXAllocationTagStats& lhs, const PhysXAllocationTagStats& rhs)
+	{
+		return lhs.m_liveBytes > rhs.m_liveBytes;
+	});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int64_t PhysXPoolAllocator::GetReservedPoolBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_poolMutex);
+	return (int64_t)(m_slabs.size() * gPoolSlabBytes);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint32_t PhysXPoolAllocator::FindOrAddTag(const char* typeName)
+{
+	if (typeName == nullptr)
+	{
+		return 0;
+	}
+
+	//PhysX passes string literals, so the same pointer comes back and a hit costs one or two probes with no string compare
+	int slotIndex = FindTagLookupSlot(typeName);
+	if (m_tagLookupKeys[slotIndex].load(std::memory_order_acquire) == typeName)
+	{
+		return m_tagLookupIndices[slotIndex].load(std::memory_order_relaxed);
+	}
+
+	std::lock_guard<std::mutex> lock(m_tagMutex);
+
+	//Another thread may have added it while we waited
+	slotIndex = FindTagLookupSlot(typeName);
+	if (m_tagLookupKeys[slotIndex].load(std::memory_order_relaxed) == typeName)
+	{
+		return m_tagLookupIndices[slotIndex].load(std::memory_order_relaxed);
+	}
+
+	//A new pointer can still be a name we already have, literals are not merged across modules
+	int numTags = m_numTags.load(std::memory_order_relaxed);
+	uint32_t tagIndex = 0;
+	bool foundTag = false;
+	for (int existingIndex = 1; existingIndex < numTags; ++existingIndex)
+	{
+		if (strcmp(m_tags[existingIndex].m_name.load(std::memory_order_relaxed), typeName) == 0)
+		{
+			tagIndex = (uint32_t)existingIndex;
+			foundTag = true;
+			break;
+		}
+	}
+
+	if (!foundTag && numTags < MAX_TAGS)
+	{
+		m_tags[numTags].m_name.store(typeName, std::memory_order_relaxed);
+		m_numTags.store(numTags + 1, std::memory_order_release);
+		tagIndex = (uint32_t)numTags;
+	}
+	//Out of tags, the overflow lands in the untagged bucket
+
+	if (m_numTagLookups < NUM_TAG_LOOKUP_SLOTS / 2)
+	{
+		m_tagLookupIndices[slotIndex].store(tagIndex, std::memory_order_relaxed);
+		m_tagLookupKeys[slotIndex].store(typeName, std::memory_order_release);
+		m_numTagLookups++;
+	}
+
+	return tagIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int PhysXPoolAllocator::FindTagLookupSlot(const char* typeName) const
+{
+	//Returns the slot holding typeName, or the empty slot it would go in. The table never fills past half, so this ends
+	uint64_t hash = ((uint64_t)(uintptr_t)typeName >> 3) * 0x9E3779B97F4A7C15ull;
+	int slotIndex = (int)(hash >> 55) & (NUM_TAG_LOOKUP_SLOTS - 1);
+
+	while (true)
+	{
+		const char* key = m_tagLookupKeys[slotIndex].load(std::memory_order_acquire);
+		if (key == typeName || key == nullptr)
+		{
+			return slotIndex;
+		}
+
+		slotIndex = (slotIndex + 1) & (NUM_TAG_LOOKUP_SLOTS - 1);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoolAllocator::RecordAllocation(uint32_t tagIndex, int64_t size)
+{
+	AllocationTag& tag = m_tags[tagIndex];
+	tag.m_numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	int64_t tagLiveBytes = tag.m_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	int64_t tagPeakBytes = tag.m_peakBytes.load(std::memory_order_relaxed);
+	while (tagLiveBytes > tagPeakBytes && !tag.m_peakBytes.compare_exchange_weak(tagPeakBytes, tagLiveBytes, std::memory_order_relaxed))
+	{
+	}
+
+	int64_t liveBytes = m_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	int64_t peakBytes = m_peakBytes.load(std::memory_order_relaxed);
+	while (liveBytes > peakBytes && !m_peakBytes.compare_exchange_weak(peakBytes, liveBytes, std::memory_order_relaxed))
+	{
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoolAllocator::RecordFree(uint32_t tagIndex, int64_t size)
+{
+	AllocationTag& tag = m_tags[tagIndex];
+	tag.m_numFrees.fetch_add(1, std::memory_order_relaxed);
+	tag.m_liveBytes.fetch_sub(size, std::memory_order_relaxed);
+
+	m_liveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXFreeBlock* PhysXPoolAllocator::TakeSharedBlocks(int sizeClass, int numBlocks, int& numTaken)
+{
+	std::lock_guard<std::mutex> lock(m_poolMutex);
+	m_numSharedPoolLocks.fetch_add(1, std::memory_order_relaxed);
+
+	PhysXFreeBlock* head = m_sharedFreeLists[sizeClass];
+	if (head == nullptr)
+	{
+		AddSlab(sizeClass);
+		head = m_sharedFreeLists[sizeClass];
+	}
+
+	PhysXFreeBlock* tail = head;
+	numTaken = 1;
+	while (numTaken < numBlocks && tail->m_next != nullptr)
+	{
+		tail = tail->m_next;
+		numTaken++;
+	}
+
+	m_sharedFreeLists[sizeClass] = tail->m_next;
+	tail->m_next = nullptr;
+	return head;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoolAllocator::ReturnSharedBlocks(int sizeClass, PhysXFreeBlock* head, PhysXFreeBlock* tail, int numBlocks)
+{
+	UNUSED(numBlocks);
+
+	std::lock_guard<std::mutex> lock(m_poolMutex);
+	m_numSharedPoolLocks.fetch_add(1, std::memory_order_relaxed);
+
+	tail->m_next = m_sharedFreeLists[sizeClass];
+	m_sharedFreeLists[sizeClass] = head;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoolAllocator::AddSlab(int sizeClass)
+{
+	//Caller holds the pool lock
+	char* slab = reinterpret_cast<char*>(PlatformMemory::AlignedAllocate(gPoolSlabBytes, gPhysXAllocationAlignment));
+	if (slab == nullptr)
+	{
+		ERROR_AND_DIE("PhysX pool allocator is out of memory");
+	}
+	m_slabs.push_back(slab);
+
+	size_t blockBytes = GetSizeClassBytes(sizeClass);
+	int numBlocks = (int)(gPoolSlabBytes / blockBytes);
+
+	PhysXFreeBlock* head = m_sharedFreeLists[sizeClass];
+	for (int blockIndex = numBlocks - 1; blockIndex >= 0; --blockIndex)
+	{
+		PhysXFreeBlock* block = reinterpret_cast<PhysXFreeBlock*>(slab + blockIndex * blockBytes);
+		block->m_next = head;
+		head = block;
+	}
+	m_sharedFreeLists[sizeClass] = head;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC int PhysXPoolAllocator::GetSizeClass(size_t blockSize)
+{
+	for (int sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+	{
+		if (blockSize <= GetSizeClassBytes(sizeClass))
+		{
+			return sizeClass;
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC size_t PhysXPoolAllocator::GetSizeClassBytes(int sizeClass)
+{
+	//32 bytes up to 4KB in powers of two
+	return gSmallestSizeClassBytes << sizeClass;
+}
@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+using namespace physx;
+
+struct PhysXFreeBlock;
+struct PhysXThreadCache;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXAllocationTagStats
+{
+	const char*							m_name = nullptr;
+	int64_t								m_liveBytes = 0;
+	int64_t								m_peakBytes = 0;
+	int64_t								m_numAllocations = 0;
+	int64_t								m_numFrees = 0;
+	float								m_allocationsPerSecond = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// PxAllocatorCallback that serves small blocks from size-class pools carved out of 64KB slabs. Each thread keeps a short
+// free list per size class so most allocate/deallocate pairs never touch the shared lock, and only refills or overflows
+// move blocks in batches to and from the shared pools. Anything above the largest size class goes to the aligned heap.
+// Every allocation is tagged with its typeName so live bytes, peak bytes and allocation rate can be read per tag.
+// There is one instance per process since the thread caches are not tied to an instance. The foundation keeps the
+// Engine's own allocator, this one serves the buffers the game hands to PhysX
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXPoolAllocator : public PxAllocatorCallback
+{
+	friend struct PhysXThreadCache;
+
+public:
+	static const int NUM_SIZE_CLASSES = 8;
+	static const int MAX_TAGS = 128;
+	//Open addressed typeName pointer to tag lookup, kept at most half full so probes stay short
+	static const int NUM_TAG_LOOKUP_SLOTS = 512;
+
+public:
+	PhysXPoolAllocator();
+	virtual ~PhysXPoolAllocator();
+
+	virtual void*						allocate(size_t size, const char* typeName, const char* filename, int line) override;
+	virtual void						deallocate(void* ptr) override;
+
+	//Call once a frame from the main thread, rates are averaged over about a second
+	void								UpdateRates(float deltaSeconds);
+
+	//Sorted by live bytes, largest first
+	void								GetTagStats(std::vector<PhysXAllocationTagStats>& tagStats) const;
+
+	int64_t								GetLiveBytes() const { return m_liveBytes.load(std::memory_order_relaxed); }
+	int64_t								GetPeakBytes() const { return m_peakBytes.load(std::memory_order_relaxed); }
+	int64_t								GetReservedPoolBytes() const;
+	int64_t								GetNumSharedPoolLocks() const { return m_numSharedPoolLocks.load(std::memory_order_relaxed); }
+
+private:
+	struct AllocationTag
+	{
+		std::atomic<const char*>		m_name{ nullptr };
+		std::atomic<int64_t>			m_liveBytes{ 0 };
+		std::atomic<int64_t>			m_peakBytes{ 0 };
+		std::atomic<int64_t>			m_numAllocations{ 0 };
+		std::atomic<int64_t>			m_numFrees{ 0 };
+
+		//Main thread only
+		int64_t							m_numAllocationsAtLastSample = 0;
+		float							m_allocationsPerSecond = 0.f;
+	};
+
+	uint32_t							FindOrAddTag(const char* typeName);
+	int									FindTagLookupSlot(const char* typeName) const;
+	void								RecordAllocation(uint32_t tagIndex, int64_t size);
+	void								RecordFree(uint32_t tagIndex, int64_t size);
+
+	PhysXFreeBlock*						TakeSharedBlocks(int sizeClass, int numBlocks, int& numTaken);
+	void								ReturnSharedBlocks(int sizeClass, PhysXFreeBlock* head, PhysXFreeBlock* tail, int numBlocks);
+	void								AddSlab(int sizeClass);
+
+	static int							GetSizeClass(size_t blockSize);
+	static size_t						GetSizeClassBytes(int sizeClass);
+
+private:
+	mutable std::mutex					m_poolMutex;
+	PhysXFreeBlock*						m_sharedFreeLists[NUM_SIZE_CLASSES];
+	std::vector<void*>					m_slabs;
+	std::atomic<int64_t>				m_numSharedPoolLocks{ 0 };
+
+	std::mutex							m_tagMutex;
+	AllocationTag						m_tags[MAX_TAGS];
+	std::atomic<int>					m_numTags{ 0 };
+
+	//A slot's index is written before its key, so a reader that sees the key also sees the index
+	std::atomic<const char*>			m_tagLookupKeys[NUM_TAG_LOOKUP_SLOTS];
+	std::atomic<uint32_t>				m_tagLookupIndices[NUM_TAG_LOOKUP_SLOTS];
+	int									m_numTagLookups = 0;
+
+	std::atomic<int64_t>				m_liveBytes{ 0 };
+	std::atomic<int64_t>				m_peakBytes{ 0 };
+	float								m_secondsSinceRateSample = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Forwards to another allocator under a fixed tag, for callers like PxDefaultMemoryOutputStream or the vehicle query
+// buffers that allocate without a typeName of their own
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXTaggedAllocator : public PxAllocatorCallback
+{
+public:
+	PhysXTaggedAllocator(PxAllocatorCallback& allocator, const char* tag) : m_allocator(allocator), m_tag(tag) {}
+
+	virtual void*						allocate(size_t size, const char*, const char* filename, int line) override { return m_allocator.allocate(size, m_tag, filename, line); }
+	virtual void						deallocate(void* ptr) override { m_allocator.deallocate(ptr); }
+
+private:
+	PxAllocatorCallback&				m_allocator;
+	const char*							m_tag = nullptr;
+};
+
+extern PhysXPoolAllocator g_PxPoolAllocator;
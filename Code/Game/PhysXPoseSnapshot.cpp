@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXPoseSnapshot.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/VehicleManager.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXPoseSnapshot::PhysXPoseSnapshot()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXPoseSnapshot::~PhysXPoseSnapshot()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoseSnapshot::Capture(PxScene& pxScene, const VehicleManager& vehicleManager)
+{
+	Clear();
+
+	int numDynamics = pxScene.getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC);
+	std::vector<PxActor*> actors(numDynamics);
+	if (numDynamics > 0)
+	{
+		pxScene.getActors(PxActorTypeFlag::eRIGID_DYNAMIC, &actors[0], numDynamics);
+	}
+
+	m_actorPoses.reserve(numDynamics);
+	for (int actorIndex = 0; actorIndex < numDynamics; ++actorIndex)
+	{
+		PxRigidDynamic* rigidDynamic = static_cast<PxRigidDynamic*>(actors[actorIndex]);
+
+		RigidDynamicPose actorPose;
+		actorPose.m_actor = rigidDynamic;
+		actorPose.m_pose = rigidDynamic->getGlobalPose();
+		actorPose.m_isKinematic = rigidDynamic->getRigidBodyFlags().isSet(PxRigidBodyFlag::eKINEMATIC);
+
+		if (!actorPose.m_isKinematic)
+		{
+			actorPose.m_linearVelocity = rigidDynamic->getLinearVelocity();
+			actorPose.m_angularVelocity = rigidDynamic->getAngularVelocity();
+			actorPose.m_wakeCounter = rigidDynamic->getWakeCounter();
+			actorPose.m_isSleeping = rigidDynamic->isSleeping();
+		}
+
+		m_actorPoses.push_back(actorPose);
+	}
+
+	int numVehicles = vehicleManager.GetNumVehicles();
+	m_vehicleStates.reserve(numVehicles);
+	for (int vehicleIndex = 0; vehicleIndex < numVehicles; ++vehicleIndex)
+	{
+		PxVehicleDrive4W* vehicle = vehicleManager.GetVehicle(vehicleIndex);
+
+		VehicleDriveState driveState;
+		driveState.m_vehicle = vehicle;
+		driveState.m_inputData = vehicleManager.GetVehicleInputData(vehicleIndex);
+		driveState.m_rawInputs = *driveState.m_inputData;
+
+		driveState.m_currentGear = vehicle->mDriveDynData.getCurrentGear();
+		driveState.m_targetGear = vehicle->mDriveDynData.getTargetGear();
+		driveState.m_useAutoGears = vehicle->mDriveDynData.getUseAutoGears();
+		driveState.m_engineRotationSpeed = vehicle->mDriveDynData.getEngineRotationSpeed();
+
+		driveState.m_numWheels = vehicle->mWheelsSimData.getNbWheels();
+		for (PxU32 wheelIndex = 0; wheelIndex < driveState.m_numWheels; ++wheelIndex)
+		{
+			driveState.m_wheelRotationSpeeds[wheelIndex] = vehicle->mWheelsDynData.getWheelRotationSpeed(wheelIndex);
+			driveState.m_wheelRotationAngles[wheelIndex] = vehicle->mWheelsDynData.getWheelRotationAngle(wheelIndex);
+		}
+
+		m_vehicleStates.push_back(driveState);
+	}
+
+	m_isCaptured = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoseSnapshot::Restore() const
+{
+	//Vehicles first, setToRestState also zeroes the chassis velocity which the actor pass below writes back
+	for (int vehicleIndex = 0; vehicleIndex < (int)m_vehicleStates.size(); ++vehicleIndex)
+	{
+		const VehicleDriveState& driveState = m_vehicleStates[vehicleIndex];
+		PxVehicleDrive4W* vehicle = driveState.m_vehicle;
+
+		vehicle->setToRestState();
+
+		vehicle->mDriveDynData.setUseAutoGears(driveState.m_useAutoGears);
+		vehicle->mDriveDynData.setCurrentGear(driveState.m_currentGear);
+		vehicle->mDriveDynData.setTargetGear(driveState.m_targetGear);
+		vehicle->mDriveDynData.setEngineRotationSpeed(driveState.m_engineRotationSpeed);
+
+		for (PxU32 wheelIndex = 0; wheelIndex < driveState.m_numWheels; ++wheelIndex)
+		{
+			vehicle->mWheelsDynData.setWheelRotationSpeed(wheelIndex, driveState.m_wheelRotationSpeeds[wheelIndex]);
+			vehicle->mWheelsDynData.setWheelRotationAngle(wheelIndex, driveState.m_wheelRotationAngles[wheelIndex]);
+		}
+
+		*driveState.m_inputData = driveState.m_rawInputs;
+	}
+
+	for (int actorIndex = 0; actorIndex < (int)m_actorPoses.size(); ++actorIndex)
+	{
+		const RigidDynamicPose& actorPose = m_actorPoses[actorIndex];
+		PxRigidDynamic* rigidDynamic = actorPose.m_actor;
+
+		rigidDynamic->setGlobalPose(actorPose.m_pose, false);
+
+		if (actorPose.m_isKinematic)
+		{
+			continue;
+		}
+
+		rigidDynamic->clearForce();
+		rigidDynamic->clearTorque();
+		rigidDynamic->setLinearVelocity(actorPose.m_linearVelocity, false);
+		rigidDynamic->setAngularVelocity(actorPose.m_angularVelocity, false);
+
+		if (actorPose.m_isSleeping)
+		{
+			rigidDynamic->putToSleep();
+		}
+		else
+		{
+			rigidDynamic->setWakeCounter(actorPose.m_wakeCounter);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXPoseSnapshot::Clear()
+{
+	m_actorPoses.clear();
+	m_vehicleStates.clear();
+	m_isCaptured = false;
+}
@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Standard
+#include <vector>
+
+class VehicleManager;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct RigidDynamicPose
+{
+	PxRigidDynamic*						m_actor = nullptr;
+	PxTransform							m_pose = PxTransform(PxIdentity);
+	PxVec3								m_linearVelocity = PxVec3(0.f, 0.f, 0.f);
+	PxVec3								m_angularVelocity = PxVec3(0.f, 0.f, 0.f);
+	PxReal								m_wakeCounter = 0.f;
+	bool								m_isSleeping = false;
+	bool								m_isKinematic = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleDriveState
+{
+	PxVehicleDrive4W*					m_vehicle = nullptr;
+	PxVehicleDrive4WRawInputData*		m_inputData = nullptr;
+	PxVehicleDrive4WRawInputData		m_rawInputs;
+
+	PxU32								m_currentGear = PxVehicleGearsData::eNEUTRAL;
+	PxU32								m_targetGear = PxVehicleGearsData::eNEUTRAL;
+	bool								m_useAutoGears = true;
+	PxReal								m_engineRotationSpeed = 0.f;
+
+	PxU32								m_numWheels = 0;
+	PxReal								m_wheelRotationSpeeds[PX_MAX_NB_WHEELS] = {};
+	PxReal								m_wheelRotationAngles[PX_MAX_NB_WHEELS] = {};
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Pose, velocity and sleep state of every rigid dynamic in the scene plus the drive state of every managed vehicle.
+// Restoring writes it all back in place, so a reset costs a pass over the actors instead of rebuilding the Game.
+// Actors added after the capture are left alone, actors released since would dangle so they must not be
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXPoseSnapshot
+{
+public:
+	PhysXPoseSnapshot();
+	~PhysXPoseSnapshot();
+
+	void								Capture(PxScene& pxScene, const VehicleManager& vehicleManager);
+	void								Restore() const;
+	void								Clear();
+
+	bool								IsCaptured() const { return m_isCaptured; }
+	int									GetNumActors() const { return (int)m_actorPoses.size(); }
+	int									GetNumVehicles() const { return (int)m_vehicleStates.size(); }
+
+private:
+	std::vector<RigidDynamicPose>		m_actorPoses;
+	std::vector<VehicleDriveState>		m_vehicleStates;
+	bool								m_isCaptured = false;
+};
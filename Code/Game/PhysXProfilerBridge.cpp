@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXProfilerBridge.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/Profiler.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Deeper PhysX zone nesting than this on one thread is not recorded
+const int gMaxPhysXZoneDepth = 64;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXZoneStack
+{
+	uint64_t							m_startNs[gMaxPhysXZoneDepth];
+	int									m_depth = 0;
+};
+
+thread_local PhysXZoneStack tl_physXZoneStack;
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXProfilerBridge::PhysXProfilerBridge()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXProfilerBridge::~PhysXProfilerBridge()
+{
+	Remove();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXProfilerBridge::Install()
+{
+	//Replaces whatever profiler PhysX had, including a PVD profile connection
+	PxSetProfilerCallback(this);
+	m_isInstalled = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXProfilerBridge::Remove()
+{
+	if (m_isInstalled)
+	{
+		//Leave a profiler someone installed after us alone
+		if (PxGetProfilerCallback() == this)
+		{
+			PxSetProfilerCallback(nullptr);
+		}
+		m_isInstalled = false;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* PhysXProfilerBridge::zoneStart(const char* eventName, bool detached, uint64_t contextId)
+{
+	UNUSED(eventName);
+	UNUSED(contextId);
+
+	PhysXZoneStack& zoneStack = tl_physXZoneStack;
+	if (detached || !Profiler::IsCapturing() || zoneStack.m_depth == gMaxPhysXZoneDepth)
+	{
+		//Null tells zoneEnd there is nothing to pop, which keeps the stack balanced when a capture starts mid zone
+		return nullptr;
+	}
+
+	uint64_t* startNs = &zoneStack.m_startNs[zoneStack.m_depth++];
+	*startNs = Profiler::GetTimeNs();
+	return startNs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXProfilerBridge::zoneEnd(void* profilerData, const char* eventName, bool detached, uint64_t contextId)
+{
+	UNUSED(detached);
+	UNUSED(contextId);
+
+	if (profilerData == nullptr)
+	{
+		return;
+	}
+
+	tl_physXZoneStack.m_depth--;
+	Profiler::RecordZone(eventName, *static_cast<uint64_t*>(profilerData), Profiler::GetTimeNs());
+}
@@ -0,0 +1,27 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Forwards PhysX's own profile zones (simulate, solver islands, broadphase, vehicle updates) into the game Profiler so
+// they land in the same Chrome trace on the PhysX worker threads. PhysX only emits zones from its checked and profile
+// libraries, with the release libraries this stays silent. Detached zones that begin and end on different threads are skipped
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXProfilerBridge : public PxProfilerCallback
+{
+public:
+	PhysXProfilerBridge();
+	virtual ~PhysXProfilerBridge();
+
+	void								Install();
+	void								Remove();
+
+	virtual void*						zoneStart(const char* eventName, bool detached, uint64_t contextId) override;
+	virtual void						zoneEnd(void* profilerData, const char* eventName, bool detached, uint64_t contextId) override;
+
+private:
+	bool								m_isInstalled = false;
+};
@@ -0,0 +1,345 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXRenderProxyCache.hpp"
+//Engine Systems
+#include "Engine/Math/MathUtils.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXRenderProxyCache::PhysXRenderProxyCache()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXRenderProxyCache::~PhysXRenderProxyCache()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::StartUp(PxScene& scene)
+{
+	//Without this flag getActiveActors returns nothing
+	scene.setFlag(PxSceneFlag::eENABLE_ACTIVE_ACTORS, true);
+
+	if (m_listenedPhysics == nullptr)
+	{
+		m_listenedPhysics = &scene.getPhysics();
+		m_listenedPhysics->registerDeletionListener(*this, PxDeletionEventFlag::eUSER_RELEASE);
+	}
+
+	RebuildAll(scene);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::ShutDown()
+{
+	if (m_listenedPhysics != nullptr)
+	{
+		m_listenedPhysics->unregisterDeletionListener(*this);
+		m_listenedPhysics = nullptr;
+	}
+
+	Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::onRelease(const PxBase* observed, void* userData, PxDeletionEventFlag::Enum deletionEvent)
+{
+	PX_UNUSED(userData);
+	PX_UNUSED(deletionEvent);
+
+	//Articulation links are rigid actors too, so releasing an articulation is caught here as well
+	const PxRigidActor* actor = observed->is<PxRigidActor>();
+	if (actor != nullptr && m_actorIndexLookup.find(actor) != m_actorIndexLookup.end())
+	{
+		m_isCachedActorReleased = true;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::Clear()
+{
+	m_actors.clear();
+	m_shapes.clear();
+	m_actorIndexLookup.clear();
+
+	m_movingActorIndices.clear();
+	m_nextMovingActorIndices.clear();
+	m_articulationLinkIndices.clear();
+
+	m_knownSceneActorCount = 0;
+	m_knownArticulationCount = 0;
+	m_isCachedActorReleased = false;
+	m_interpolationAlpha = 1.f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::UpdateFromActiveActors(PxScene& scene)
+{
+	SyncActors(scene);
+
+	m_stepCount++;
+	m_nextMovingActorIndices.clear();
+
+	PxU32 numActiveActors = 0;
+	PxActor** activeActors = scene.getActiveActors(numActiveActors);
+
+	for (PxU32 activeIndex = 0; activeIndex < numActiveActors; ++activeIndex)
+	{
+		std::unordered_map<const PxRigidActor*, int>::const_iterator lookupItr = m_actorIndexLookup.find(static_cast<PxRigidActor*>(activeActors[activeIndex]));
+		if (lookupItr != m_actorIndexLookup.end())
+		{
+			MarkActive(lookupItr->second);
+		}
+	}
+
+	for (int linkIndex = 0; linkIndex < (int)m_articulationLinkIndices.size(); ++linkIndex)
+	{
+		int actorIndex = m_articulationLinkIndices[linkIndex];
+		if (m_actors[actorIndex].m_lastActiveStep != m_stepCount)
+		{
+			MarkActive(actorIndex);
+		}
+	}
+
+	//Anything that moved last step but not this one has come to rest, stop interpolating it
+	for (int movingIndex = 0; movingIndex < (int)m_movingActorIndices.size(); ++movingIndex)
+	{
+		PhysXRenderActor& renderActor = m_actors[m_movingActorIndices[movingIndex]];
+		if (renderActor.m_lastActiveStep == m_stepCount)
+		{
+			continue;
+		}
+
+		renderActor.m_previousPose = renderActor.m_currentPose;
+
+		PxRigidDynamic* rigidDynamic = renderActor.m_actor->is<PxRigidDynamic>();
+		renderActor.m_isSleeping = rigidDynamic != nullptr ? rigidDynamic->isSleeping() : false;
+	}
+
+	m_movingActorIndices.swap(m_nextMovingActorIndices);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::SnapToScenePoses()
+{
+	for (int actorIndex = 0; actorIndex < (int)m_actors.size(); ++actorIndex)
+	{
+		PhysXRenderActor& renderActor = m_actors[actorIndex];
+		if (!renderActor.m_isDynamic)
+		{
+			continue;
+		}
+
+		renderActor.m_currentPose = renderActor.m_actor->getGlobalPose();
+		renderActor.m_previousPose = renderActor.m_currentPose;
+		renderActor.m_lastActiveStep = -1;
+
+		PxRigidDynamic* rigidDynamic = renderActor.m_actor->is<PxRigidDynamic>();
+		renderActor.m_isSleeping = rigidDynamic != nullptr ? rigidDynamic->isSleeping() : false;
+	}
+
+	m_movingActorIndices.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::RefreshActor(const PxRigidActor& actor)
+{
+	std::unordered_map<const PxRigidActor*, int>::const_iterator lookupItr = m_actorIndexLookup.find(&actor);
+	if (lookupItr == m_actorIndexLookup.end())
+	{
+		//Not picked up yet, AddActor reads the same state when it is
+		return;
+	}
+
+	PhysXRenderActor& renderActor = m_actors[lookupItr->second];
+	renderActor.m_currentPose = actor.getGlobalPose();
+	renderActor.m_previousPose = renderActor.m_currentPose;
+	renderActor.m_lastActiveStep = -1;
+	renderActor.m_isHidden = actor.getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::MarkActive(int actorIndex)
+{
+	PhysXRenderActor& renderActor = m_actors[actorIndex];
+	renderActor.m_previousPose = renderActor.m_currentPose;
+	renderActor.m_currentPose = renderActor.m_actor->getGlobalPose();
+	renderActor.m_isSleeping = false;
+	renderActor.m_lastActiveStep = m_stepCount;
+
+	m_nextMovingActorIndices.push_back(actorIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::SyncActors(PxScene& scene)
+{
+	//A release and an add between two syncs leave the count where it was, so releases are tracked by the deletion listener
+	if (m_isCachedActorReleased)
+	{
+		RebuildAll(scene);
+		return;
+	}
+
+	//Counting is O(1) in PhysX, so we only walk the actor list when something was actually added or removed
+	int numSceneActors = scene.getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC);
+	int numArticulations = scene.getNbArticulations();
+
+	if (numSceneActors == m_knownSceneActorCount && numArticulations == m_knownArticulationCount)
+	{
+		return;
+	}
+
+	if (numSceneActors < m_knownSceneActorCount || numArticulations != m_knownArticulationCount)
+	{
+		RebuildAll(scene);
+		return;
+	}
+
+	AddMissingSceneActors(scene);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::RebuildAll(PxScene& scene)
+{
+	Clear();
+	m_generation++;
+
+	AddMissingSceneActors(scene);
+
+	int numArticulations = scene.getNbArticulations();
+	for (int articulationIndex = 0; articulationIndex < numArticulations; ++articulationIndex)
+	{
+		PxArticulationBase* articulation = nullptr;
+		scene.getArticulations(&articulation, 1, articulationIndex);
+
+		int numLinks = articulation->getNbLinks();
+		if (numLinks == 0)
+		{
+			continue;
+		}
+
+		m_scratchLinks.resize(numLinks);
+		articulation->getLinks(&m_scratchLinks[0], numLinks);
+
+		for (int linkIndex = 0; linkIndex < numLinks; ++linkIndex)
+		{
+			AddActor(*m_scratchLinks[linkIndex], true);
+		}
+	}
+
+	m_knownArticulationCount = numArticulations;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::AddMissingSceneActors(PxScene& scene)
+{
+	int numSceneActors = scene.getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC);
+	if (numSceneActors > 0)
+	{
+		m_scratchActors.resize(numSceneActors);
+		scene.getActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC, &m_scratchActors[0], numSceneActors);
+
+		for (int actorIndex = 0; actorIndex < numSceneActors; ++actorIndex)
+		{
+			PxRigidActor* actor = static_cast<PxRigidActor*>(m_scratchActors[actorIndex]);
+			if (m_actorIndexLookup.find(actor) == m_actorIndexLookup.end())
+			{
+				AddActor(*actor, false);
+			}
+		}
+	}
+
+	m_knownSceneActorCount = numSceneActors;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::AddActor(PxRigidActor& actor, bool isArticulationLink)
+{
+	int actorIndex = (int)m_actors.size();
+
+	PhysXRenderActor renderActor;
+	renderActor.m_actor = &actor;
+	renderActor.m_currentPose = actor.getGlobalPose();
+	renderActor.m_previousPose = renderActor.m_currentPose;
+	renderActor.m_isDynamic = actor.is<PxRigidBody>() != nullptr;
+	renderActor.m_isArticulationLink = isArticulationLink;
+	renderActor.m_isHidden = actor.getActorFlags().isSet(PxActorFlag::eDISABLE_SIMULATION);
+
+	PxRigidDynamic* rigidDynamic = actor.is<PxRigidDynamic>();
+	renderActor.m_isSleeping = rigidDynamic != nullptr ? rigidDynamic->isSleeping() : false;
+
+	int numShapes = actor.getNbShapes();
+	renderActor.m_firstShapeIndex = (int)m_shapes.size();
+	renderActor.m_numShapes = numShapes;
+
+	if (numShapes > 0)
+	{
+		m_scratchShapes.resize(numShapes);
+		actor.getShapes(&m_scratchShapes[0], numShapes);
+
+		for (int shapeIndex = 0; shapeIndex < numShapes; ++shapeIndex)
+		{
+			PhysXRenderShape renderShape;
+			renderShape.m_actorIndex = actorIndex;
+			renderShape.m_geometry = m_scratchShapes[shapeIndex]->getGeometry();
+			renderShape.m_localPose = m_scratchShapes[shapeIndex]->getLocalPose();
+			m_shapes.push_back(renderShape);
+		}
+	}
+
+	m_actors.push_back(renderActor);
+	m_actorIndexLookup[&actor] = actorIndex;
+
+	if (isArticulationLink)
+	{
+		m_articulationLinkIndices.push_back(actorIndex);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXRenderProxyCache::SetInterpolationAlpha(float alpha)
+{
+	m_interpolationAlpha = Clamp(alpha, 0.f, 1.f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxTransform PhysXRenderProxyCache::GetRenderPose(const PxRigidActor& actor) const
+{
+	std::unordered_map<const PxRigidActor*, int>::const_iterator lookupItr = m_actorIndexLookup.find(&actor);
+	if (lookupItr == m_actorIndexLookup.end())
+	{
+		//Not picked up yet (spawned since the last step), draw it where PhysX has it
+		return actor.getGlobalPose();
+	}
+
+	return GetRenderPose(lookupItr->second);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxTransform PhysXRenderProxyCache::GetRenderPose(int actorIndex) const
+{
+	const PhysXRenderActor& renderActor = m_actors[actorIndex];
+
+	//Only actors that moved in the last step have two different poses to blend
+	if (renderActor.m_lastActiveStep != m_stepCount)
+	{
+		return renderActor.m_currentPose;
+	}
+
+	const PxTransform& previous = renderActor.m_previousPose;
+	const PxTransform& current = renderActor.m_currentPose;
+	const float alpha = m_interpolationAlpha;
+
+	PxVec3 position = previous.p + (current.p - previous.p) * alpha;
+
+	//Normalized lerp along the shortest arc. Good enough for the small rotations between two fixed steps
+	PxQuat target = current.q;
+	if (previous.q.dot(target) < 0.f)
+	{
+		target = -target;
+	}
+
+	PxQuat rotation = previous.q * (1.f - alpha) + target * alpha;
+	rotation.normalize();
+
+	return PxTransform(position, rotation);
+}
@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <unordered_map>
+#include <vector>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Render side copy of a PhysX actor. Poses are only refreshed when PhysX reports the actor as active
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXRenderActor
+{
+	PxRigidActor*						m_actor = nullptr;
+	PxTransform							m_previousPose = PxTransform(PxIdentity);
+	PxTransform							m_currentPose = PxTransform(PxIdentity);
+
+	bool								m_isDynamic = false;
+	bool								m_isSleeping = false;
+	bool								m_isArticulationLink = false;
+	//Simulation disabled, e.g. a parked pooled projectile. Kept in the cache but not drawn
+	bool								m_isHidden = false;
+
+	int									m_firstShapeIndex = 0;
+	int									m_numShapes = 0;
+	int									m_lastActiveStep = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXRenderShape
+{
+	int									m_actorIndex = 0;
+	PxGeometryHolder					m_geometry;
+	PxTransform							m_localPose = PxTransform(PxIdentity);
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Builds a render proxy once per actor and updates it from PxScene::getActiveActors after every step, so static and
+// sleeping actors cost nothing per frame. A higher scene actor count only adds the new actors. Releasing any cached actor
+// is reported through a PxDeletionListener and rebuilds the cache from scratch on the next step, whatever the count does.
+// Actors have to be released rather than only removed from the scene, nothing reports a bare removeActor
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXRenderProxyCache : public PxDeletionListener
+{
+public:
+	PhysXRenderProxyCache();
+	~PhysXRenderProxyCache();
+
+	void								StartUp(PxScene& scene);
+	//Stops listening for releases, call while the PhysX SDK is still up
+	void								ShutDown();
+	void								Clear();
+
+	//PxDeletionListener, only flags the rebuild. Releases are expected on the thread that updates the cache
+	virtual void						onRelease(const PxBase* observed, void* userData, PxDeletionEventFlag::Enum deletionEvent) override;
+
+	void								UpdateFromActiveActors(PxScene& scene);
+	//Re-reads every pose after actors were teleported, since teleported sleepers never show up as active
+	void								SnapToScenePoses();
+	//Re-reads one actor's pose and simulation flag after it was teleported, parked or unparked outside a step
+	void								RefreshActor(const PxRigidActor& actor);
+
+	void								SetInterpolationAlpha(float alpha);
+	float								GetInterpolationAlpha() const { return m_interpolationAlpha; }
+
+	PxTransform							GetRenderPose(const PxRigidActor& actor) const;
+	PxTransform							GetRenderPose(int actorIndex) const;
+
+	const std::vector<PhysXRenderActor>&	GetActors() const { return m_actors; }
+	const std::vector<PhysXRenderShape>&	GetShapes() const { return m_shapes; }
+	//Bumped whenever shape indices are invalidated by a rebuild
+	int									GetGeneration() const { return m_generation; }
+
+private:
+	void								SyncActors(PxScene& scene);
+	void								RebuildAll(PxScene& scene);
+	void								AddMissingSceneActors(PxScene& scene);
+	void								AddActor(PxRigidActor& actor, bool isArticulationLink);
+	void								MarkActive(int actorIndex);
+
+private:
+	std::vector<PhysXRenderActor>		m_actors;
+	std::vector<PhysXRenderShape>		m_shapes;
+	std::unordered_map<const PxRigidActor*, int>	m_actorIndexLookup;
+
+	//Actors that moved last step and the set being built for this step
+	std::vector<int>					m_movingActorIndices;
+	std::vector<int>					m_nextMovingActorIndices;
+	//Articulation links are polled every step rather than trusted to the active actor list
+	std::vector<int>					m_articulationLinkIndices;
+
+	int									m_knownSceneActorCount = 0;
+	int									m_knownArticulationCount = 0;
+	//A cached actor was released since the last sync, its proxy points at freed memory
+	bool								m_isCachedActorReleased = false;
+	PxPhysics*							m_listenedPhysics = nullptr;
+	int									m_stepCount = 0;
+	int									m_generation = 0;
+	float								m_interpolationAlpha = 1.f;
+
+	std::vector<PxActor*>				m_scratchActors;
+	std::vector<PxArticulationLink*>	m_scratchLinks;
+	std::vector<PxShape*>				m_scratchShapes;
+};
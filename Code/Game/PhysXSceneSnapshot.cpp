@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXSceneSnapshot.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/PhysXPoolAllocator.hpp"
+//Standard
+#include <fstream>
+#include <stdint.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+const PxU32 gSceneSnapshotMagic = 0x4E535850;	//"PXSN"
+const PxU32 gSceneSnapshotVersion = 1;
+
+//Objects the engine owns that the scene build references. They are resolved by id instead of being serialized
+const PxSerialObjectId gSharedMaterialId = 1;
+
+PhysXTaggedAllocator gSnapshotAllocator(g_PxPoolAllocator, "PxSceneSnapshot");
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SceneSnapshotHeader
+{
+	PxU32								m_magic = gSceneSnapshotMagic;
+	PxU32								m_version = gSceneSnapshotVersion;
+	PxU32								m_physXVersion = PX_PHYSICS_VERSION;
+	PxU32								m_buildVersion = 0;
+	PxU64								m_dataSize = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXSceneSnapshot::PhysXSceneSnapshot()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXSceneSnapshot::~PhysXSceneSnapshot()
+{
+	Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysXSceneSnapshot::Load(const std::string& filePath, PxU32 buildVersion, PxScene& pxScene, PxPhysics& physX, PxMaterial& sharedMaterial)
+{
+	Release();
+
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	SceneSnapshotHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.m_magic != gSceneSnapshotMagic || header.m_version != gSceneSnapshotVersion
+		|| header.m_physXVersion != PX_PHYSICS_VERSION || header.m_buildVersion != buildVersion || header.m_dataSize == 0)
+	{
+		return false;
+	}
+
+	//Binary deserialization works in place and needs PX_SERIAL_FILE_ALIGN alignment
+	m_serializedSize = (size_t)header.m_dataSize;
+	m_serializedBlock = gSnapshotAllocator.allocate(m_serializedSize + PX_SERIAL_FILE_ALIGN, nullptr, __FILE__, __LINE__);
+	void* alignedBlock = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(m_serializedBlock) + PX_SERIAL_FILE_ALIGN - 1) & ~(uintptr_t)(PX_SERIAL_FILE_ALIGN - 1));
+
+	file.read(reinterpret_cast<char*>(alignedBlock), m_serializedSize);
+	if (!file)
+	{
+		Release();
+		return false;
+	}
+
+	PxSerializationRegistry* registry = PxSerialization::createSerializationRegistry(physX);
+	PxCollection* externalRefs = CreateExternalReferences(sharedMaterial);
+
+	m_collection = PxSerialization::createCollectionFromBinary(alignedBlock, *registry, externalRefs);
+
+	externalRefs->release();
+	registry->release();
+
+	if (m_collection == nullptr)
+	{
+		Release();
+		return false;
+	}
+
+	m_numActors = 0;
+	for (PxU32 objectIndex = 0; objectIndex < m_collection->getNbObjects(); ++objectIndex)
+	{
+		if (m_collection->getObject(objectIndex).is<PxRigidActor>() != nullptr)
+		{
+			m_numActors++;
+		}
+	}
+
+	pxScene.addCollection(*m_collection);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXSceneSnapshot::BeginCapture(PxScene& pxScene)
+{
+	Release();
+
+	m_actorsBeforeCapture.clear();
+	m_articulationsBeforeCapture.clear();
+
+	PxActorTypeFlags actorTypes = PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC;
+	std::vector<PxActor*> actors(pxScene.getNbActors(actorTypes));
+	if (!actors.empty())
+	{
+		pxScene.getActors(actorTypes, &actors[0], (PxU32)actors.size());
+	}
+	m_actorsBeforeCapture.insert(actors.begin(), actors.end());
+
+	std::vector<PxArticulationBase*> articulations(pxScene.getNbArticulations());
+	if (!articulations.empty())
+	{
+		pxScene.getArticulations(&articulations[0], (PxU32)articulations.size());
+	}
+	m_articulationsBeforeCapture.insert(articulations.begin(), articulations.end());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXSceneSnapshot::EndCapture(PxScene& pxScene, PxPhysics& physX, PxMaterial& sharedMaterial)
+{
+	m_collection = PxCreateCollection();
+	m_numActors = 0;
+
+	PxActorTypeFlags actorTypes = PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC;
+	std::vector<PxActor*> actors(pxScene.getNbActors(actorTypes));
+	if (!actors.empty())
+	{
+		pxScene.getActors(actorTypes, &actors[0], (PxU32)actors.size());
+	}
+
+	for (int actorIndex = 0; actorIndex < (int)actors.size(); ++actorIndex)
+	{
+		//Articulation links are reached through their articulation below
+		if (m_actorsBeforeCapture.count(actors[actorIndex]) == 0 && actors[actorIndex]->is<PxArticulationLink>() == nullptr)
+		{
+			m_collection->add(*actors[actorIndex]);
+			m_numActors++;
+		}
+	}
+
+	std::vector<PxArticulationBase*> articulations(pxScene.getNbArticulations());
+	if (!articulations.empty())
+	{
+		pxScene.getArticulations(&articulations[0], (PxU32)articulations.size());
+	}
+
+	for (int articulationIndex = 0; articulationIndex < (int)articulations.size(); ++articulationIndex)
+	{
+		if (m_articulationsBeforeCapture.count(articulations[articulationIndex]) == 0)
+		{
+			m_collection->add(*articulations[articulationIndex]);
+		}
+	}
+
+	m_actorsBeforeCapture.clear();
+	m_articulationsBeforeCapture.clear();
+
+	//Pull in the shapes, meshes and materials the new actors reference so Release frees them too. The engine's
+	//default material stays outside the collection
+	PxSerializationRegistry* registry = PxSerialization::createSerializationRegistry(physX);
+	PxCollection* externalRefs = CreateExternalReferences(sharedMaterial);
+
+	PxSerialization::complete(*m_collection, *registry, externalRefs);
+
+	externalRefs->release();
+	registry->release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysXSceneSnapshot::Save(const std::string& filePath, PxU32 buildVersion, PxPhysics& physX, PxMaterial& sharedMaterial) const
+{
+	if (m_collection == nullptr)
+	{
+		return false;
+	}
+
+	PxSerializationRegistry* registry = PxSerialization::createSerializationRegistry(physX);
+	PxCollection* externalRefs = CreateExternalReferences(sharedMaterial);
+
+	bool isSaved = false;
+	PxDefaultMemoryOutputStream serializedStream(gSnapshotAllocator);
+	if (PxSerialization::isSerializable(*m_collection, *registry, externalRefs)
+		&& PxSerialization::serializeCollectionToBinary(serializedStream, *m_collection, *registry, externalRefs))
+	{
+		PxDefaultFileOutputStream file(filePath.c_str());
+		if (file.isValid())
+		{
+			SceneSnapshotHeader header;
+			header.m_buildVersion = buildVersion;
+			header.m_dataSize = serializedStream.getSize();
+
+			file.write(&header, sizeof(header));
+			isSaved = file.write(serializedStream.getData(), serializedStream.getSize()) == serializedStream.getSize();
+		}
+	}
+
+	externalRefs->release();
+	registry->release();
+	return isSaved;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXSceneSnapshot::Release()
+{
+	if (m_collection != nullptr)
+	{
+		//Releasing the actors also removes them from the scene
+		PxCollectionExt::releaseObjects(*m_collection);
+		m_collection->release();
+		m_collection = nullptr;
+	}
+
+	if (m_serializedBlock != nullptr)
+	{
+		gSnapshotAllocator.deallocate(m_serializedBlock);
+		m_serializedBlock = nullptr;
+	}
+
+	m_serializedSize = 0;
+	m_numActors = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int PhysXSceneSnapshot::GetNumObjects() const
+{
+	if (m_collection == nullptr)
+	{
+		return 0;
+	}
+
+	return (int)m_collection->getNbObjects();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxCollection* PhysXSceneSnapshot::CreateExternalReferences(PxMaterial& sharedMaterial) const
+{
+	PxCollection* externalRefs = PxCreateCollection();
+	externalRefs->add(sharedMaterial, gSharedMaterialId);
+	return externalRefs;
+}
@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <string>
+#include <unordered_set>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Owns the actors a scene build adds on top of what the engine already created (ground, player car). The build is
+// captured into a PxCollection and can be written out as PhysX binary serialization, so later starts deserialize the
+// whole scene straight from a 128 byte aligned block instead of creating and cooking every object again. Only actors
+// and articulations are captured, joints between them are not
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXSceneSnapshot
+{
+public:
+	PhysXSceneSnapshot();
+	~PhysXSceneSnapshot();
+
+	//Loads a snapshot written with the same build version and adds it to the scene
+	bool								Load(const std::string& filePath, PxU32 buildVersion, PxScene& pxScene, PxPhysics& physX, PxMaterial& sharedMaterial);
+
+	//Wrap a procedural build. Everything added to the scene in between is owned by the snapshot afterwards
+	void								BeginCapture(PxScene& pxScene);
+	void								EndCapture(PxScene& pxScene, PxPhysics& physX, PxMaterial& sharedMaterial);
+	bool								Save(const std::string& filePath, PxU32 buildVersion, PxPhysics& physX, PxMaterial& sharedMaterial) const;
+
+	//Releases every owned object. Must run before the PhysX SDK goes away and while no step is in flight
+	void								Release();
+
+	bool								IsLoadedFromFile() const { return m_serializedBlock != nullptr; }
+	int									GetNumActors() const { return m_numActors; }
+	int									GetNumObjects() const;
+	size_t								GetSerializedSize() const { return m_serializedSize; }
+
+private:
+	PxCollection*						CreateExternalReferences(PxMaterial& sharedMaterial) const;
+
+private:
+	PxCollection*						m_collection = nullptr;
+	int									m_numActors = 0;
+
+	//Actors that existed before the capture started and stay owned by whoever made them
+	std::unordered_set<PxActor*>		m_actorsBeforeCapture;
+	std::unordered_set<PxArticulationBase*>	m_articulationsBeforeCapture;
+
+	//Deserialized objects live inside this block, so it is freed only after they are all released
+	void*								m_serializedBlock = nullptr;
+	size_t								m_serializedSize = 0;
+};
@@ -0,0 +1,190 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PhysXStatsRecorder.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Standard
+#include <chrono>
+#include <fstream>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Bump the version whenever PhysXStatsSample or the counter list changes
+const PxU32 gPhysXStatsMagic = 0x54535850;	//"PXST"
+const PxU32 gPhysXStatsVersion = 1;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXStatsFileHeader
+{
+	PxU32								m_magic = gPhysXStatsMagic;
+	PxU32								m_version = gPhysXStatsVersion;
+	PxU32								m_sampleSize = sizeof(PhysXStatsSample);
+	PxU32								m_numCounters = NUM_PHYSX_STATS_COUNTERS;
+	PxU32								m_numSamples = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static double GetStatsTimeSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXStatsRecorder::PhysXStatsRecorder(int capacity)
+{
+	m_samples.resize(capacity > 0 ? capacity : 1);
+	m_startTime = GetStatsTimeSeconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysXStatsRecorder::~PhysXStatsRecorder()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const char* PhysXStatsRecorder::GetCounterName(ePhysXStatsCounter counter)
+{
+	switch (counter)
+	{
+	case PHYSX_STATS_ACTIVE_DYNAMIC_BODIES:		return "activeDynamicBodies";
+	case PHYSX_STATS_ACTIVE_KINEMATIC_BODIES:	return "activeKinematicBodies";
+	case PHYSX_STATS_ACTIVE_CONSTRAINTS:		return "activeConstraints";
+	case PHYSX_STATS_AXIS_SOLVER_CONSTRAINTS:	return "axisSolverConstraints";
+	case PHYSX_STATS_SOLVER_PARTITIONS:			return "solverPartitions";
+	case PHYSX_STATS_CONTACT_PAIRS:				return "contactPairs";
+	case PHYSX_STATS_NEW_PAIRS:					return "newPairs";
+	case PHYSX_STATS_LOST_PAIRS:				return "lostPairs";
+	case PHYSX_STATS_NEW_TOUCHES:				return "newTouches";
+	case PHYSX_STATS_LOST_TOUCHES:				return "lostTouches";
+	case PHYSX_STATS_BROADPHASE_ADDS:			return "broadPhaseAdds";
+	case PHYSX_STATS_BROADPHASE_REMOVES:		return "broadPhaseRemoves";
+	case PHYSX_STATS_CONTACT_STREAM_BYTES:		return "contactStreamBytes";
+	case PHYSX_STATS_ACTIVE_ACTORS:				return "activeActors";
+	case PHYSX_STATS_VEHICLES:					return "vehicles";
+	case PHYSX_STATS_SUSPENSION_QUERIES:		return "suspensionQueries";
+	default:									return "unknown";
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXStatsRecorder::RecordStep(PxScene& scene, int numVehicles, int numSuspensionQueries, float frameSeconds)
+{
+	PxSimulationStatistics stats;
+	scene.getSimulationStatistics(stats);
+
+	PxU32 numActiveActors = 0;
+	scene.getActiveActors(numActiveActors);
+
+	PhysXStatsSample& sample = m_samples[m_nextSampleIndex];
+	sample.m_stepIndex = m_numStepsRecorded;
+	sample.m_timeSeconds = (float)(GetStatsTimeSeconds() - m_startTime);
+	sample.m_frameMs = frameSeconds * 1000.f;
+
+	PxU32* counters = sample.m_counters;
+	counters[PHYSX_STATS_ACTIVE_DYNAMIC_BODIES] = stats.nbActiveDynamicBodies;
+	counters[PHYSX_STATS_ACTIVE_KINEMATIC_BODIES] = stats.nbActiveKinematicBodies;
+	counters[PHYSX_STATS_ACTIVE_CONSTRAINTS] = stats.nbActiveConstraints;
+	counters[PHYSX_STATS_AXIS_SOLVER_CONSTRAINTS] = stats.nbAxisSolverConstraints;
+	counters[PHYSX_STATS_SOLVER_PARTITIONS] = stats.nbPartitions;
+	counters[PHYSX_STATS_CONTACT_PAIRS] = stats.nbDiscreteContactPairsTotal;
+	counters[PHYSX_STATS_NEW_PAIRS] = stats.nbNewPairs;
+	counters[PHYSX_STATS_LOST_PAIRS] = stats.nbLostPairs;
+	counters[PHYSX_STATS_NEW_TOUCHES] = stats.nbNewTouches;
+	counters[PHYSX_STATS_LOST_TOUCHES] = stats.nbLostTouches;
+	counters[PHYSX_STATS_BROADPHASE_ADDS] = stats.getNbBroadPhaseAdds();
+	counters[PHYSX_STATS_BROADPHASE_REMOVES] = stats.getNbBroadPhaseRemoves();
+	counters[PHYSX_STATS_CONTACT_STREAM_BYTES] = stats.compressedContactSize;
+	counters[PHYSX_STATS_ACTIVE_ACTORS] = numActiveActors;
+	counters[PHYSX_STATS_VEHICLES] = (PxU32)numVehicles;
+	counters[PHYSX_STATS_SUSPENSION_QUERIES] = (PxU32)numSuspensionQueries;
+
+	m_nextSampleIndex = (m_nextSampleIndex + 1) % (int)m_samples.size();
+	m_numSamples = m_numSamples < (int)m_samples.size() ? m_numSamples + 1 : m_numSamples;
+	m_numStepsRecorded++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysXStatsRecorder::Reset()
+{
+	m_nextSampleIndex = 0;
+	m_numSamples = 0;
+	m_numStepsRecorded = 0;
+	m_startTime = GetStatsTimeSeconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const PhysXStatsSample& PhysXStatsRecorder::GetSample(int sampleIndex) const
+{
+	//Oldest first once the ring buffer has wrapped
+	int capacity = (int)m_samples.size();
+	int firstIndex = m_numSamples < capacity ? 0 : m_nextSampleIndex;
+	return m_samples[(firstIndex + sampleIndex) % capacity];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxU32 PhysXStatsRecorder::GetPeakValue(ePhysXStatsCounter counter) const
+{
+	PxU32 peakValue = 0;
+	for (int sampleIndex = 0; sampleIndex < m_numSamples; ++sampleIndex)
+	{
+		PxU32 value = m_samples[sampleIndex].m_counters[counter];
+		peakValue = value > peakValue ? value : peakValue;
+	}
+	return peakValue;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysXStatsRecorder::WriteCSV(const std::string& filePath) const
+{
+	std::ofstream file(filePath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "step,timeSeconds,frameMs";
+	for (int counterIndex = 0; counterIndex < NUM_PHYSX_STATS_COUNTERS; ++counterIndex)
+	{
+		file << "," << GetCounterName((ePhysXStatsCounter)counterIndex);
+	}
+	file << "\n";
+
+	for (int sampleIndex = 0; sampleIndex < m_numSamples; ++sampleIndex)
+	{
+		const PhysXStatsSample& sample = GetSample(sampleIndex);
+		file << sample.m_stepIndex << "," << sample.m_timeSeconds << "," << sample.m_frameMs;
+		for (int counterIndex = 0; counterIndex < NUM_PHYSX_STATS_COUNTERS; ++counterIndex)
+		{
+			file << "," << sample.m_counters[counterIndex];
+		}
+		file << "\n";
+	}
+
+	return file.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Header followed by the samples oldest first. Counter order is the ePhysXStatsCounter order, GetCounterName gives the names
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysXStatsRecorder::WriteBinary(const std::string& filePath) const
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	PhysXStatsFileHeader header;
+	header.m_numSamples = (PxU32)m_numSamples;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	//The ring is at most two contiguous runs
+	int capacity = (int)m_samples.size();
+	int firstIndex = m_numSamples < capacity ? 0 : m_nextSampleIndex;
+	int numBeforeWrap = m_numSamples < capacity - firstIndex ? m_numSamples : capacity - firstIndex;
+	file.write(reinterpret_cast<const char*>(&m_samples[firstIndex]), sizeof(PhysXStatsSample) * numBeforeWrap);
+	file.write(reinterpret_cast<const char*>(&m_samples[0]), sizeof(PhysXStatsSample) * (m_numSamples - numBeforeWrap));
+
+	return file.good();
+}
@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <string>
+#include <vector>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum ePhysXStatsCounter
+{
+	//From PxSimulationStatistics
+	PHYSX_STATS_ACTIVE_DYNAMIC_BODIES,
+	PHYSX_STATS_ACTIVE_KINEMATIC_BODIES,
+	PHYSX_STATS_ACTIVE_CONSTRAINTS,
+	PHYSX_STATS_AXIS_SOLVER_CONSTRAINTS,
+	PHYSX_STATS_SOLVER_PARTITIONS,
+	PHYSX_STATS_CONTACT_PAIRS,
+	PHYSX_STATS_NEW_PAIRS,
+	PHYSX_STATS_LOST_PAIRS,
+	PHYSX_STATS_NEW_TOUCHES,
+	PHYSX_STATS_LOST_TOUCHES,
+	PHYSX_STATS_BROADPHASE_ADDS,
+	PHYSX_STATS_BROADPHASE_REMOVES,
+	PHYSX_STATS_CONTACT_STREAM_BYTES,
+
+	//Ours
+	PHYSX_STATS_ACTIVE_ACTORS,
+	PHYSX_STATS_VEHICLES,
+	PHYSX_STATS_SUSPENSION_QUERIES,
+
+	NUM_PHYSX_STATS_COUNTERS
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One simulation step. Every field is 4 bytes so the binary export is the struct as is, with no padding
+//------------------------------------------------------------------------------------------------------------------------------
+struct PhysXStatsSample
+{
+	PxU32								m_stepIndex = 0;
+	float								m_timeSeconds = 0.f;	//Since the recorder was created or reset
+	float								m_frameMs = 0.f;		//Frame (or headless step) the sample was taken in
+	PxU32								m_counters[NUM_PHYSX_STATS_COUNTERS] = {};
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Keeps the last N steps of scene statistics in a ring buffer that is allocated up front, so recording never touches the
+// heap. Written once per fetched step, read by the ImGui plots and the CSV/binary exports
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysXStatsRecorder
+{
+public:
+	explicit PhysXStatsRecorder(int capacity);
+	~PhysXStatsRecorder();
+
+	static const char*					GetCounterName(ePhysXStatsCounter counter);
+
+	//Call after fetchResults, while the scene's statistics and active actors still describe that step
+	void								RecordStep(PxScene& scene, int numVehicles, int numSuspensionQueries, float frameSeconds);
+	void								Reset();
+
+	int									GetCapacity() const { return (int)m_samples.size(); }
+	int									GetNumSamples() const { return m_numSamples; }
+	//0 is the oldest sample still held
+	const PhysXStatsSample&				GetSample(int sampleIndex) const;
+	PxU32								GetPeakValue(ePhysXStatsCounter counter) const;
+
+	bool								WriteCSV(const std::string& filePath) const;
+	bool								WriteBinary(const std::string& filePath) const;
+
+private:
+	std::vector<PhysXStatsSample>		m_samples;
+	int									m_nextSampleIndex = 0;
+	int									m_numSamples = 0;
+	PxU32								m_numStepsRecorded = 0;
+	double								m_startTime = 0.0;
+};
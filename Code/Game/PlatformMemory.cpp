@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PlatformMemory.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/AllocationCounter.hpp"
+//Standard
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void* PlatformMemory::AlignedAllocate(size_t numBytes, size_t alignment)
+{
+	AllocationCounter::CountAllocation(numBytes);
+
+#if defined(_WIN32)
+	return _aligned_malloc(numBytes, alignment);
+#else
+	void* block = nullptr;
+	if (posix_memalign(&block, alignment, numBytes) != 0)
+	{
+		return nullptr;
+	}
+	return block;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void PlatformMemory::AlignedFree(void* block)
+{
+#if defined(_WIN32)
+	_aligned_free(block);
+#else
+	free(block);
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t PlatformMemory::GetProcessPrivateBytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS_EX counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters)))
+	{
+		return 0;
+	}
+
+	return (uint64_t)counters.PrivateUsage;
+#elif defined(__linux__)
+	FILE* statusFile = fopen("/proc/self/status", "r");
+	if (statusFile == nullptr)
+	{
+		return 0;
+	}
+
+	uint64_t privateKB = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), statusFile) != nullptr)
+	{
+		unsigned long long lineKB = 0;
+		if (sscanf(line, "RssAnon: %llu kB", &lineKB) == 1)
+		{
+			privateKB = (uint64_t)lineKB;
+			break;
+		}
+	}
+
+	fclose(statusFile);
+	return privateKB * 1024;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,21 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Standard
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The few memory calls that differ between the Windows and POSIX builds, so the rest of the game includes no OS headers
+//------------------------------------------------------------------------------------------------------------------------------
+class PlatformMemory
+{
+public:
+	//Alignment must be a power of two and a multiple of sizeof(void*). Blocks go back through AlignedFree, and are counted
+	//by AllocationCounter while it is enabled
+	static void*						AlignedAllocate(size_t numBytes, size_t alignment);
+	static void							AlignedFree(void* block);
+
+	//Private memory the process holds, 0 where there is no probe. Unlike the AllocationCounter totals this includes PhysX's
+	//foundation allocations, at page granularity. Committed bytes on Windows, resident anonymous bytes on Linux
+	static uint64_t						GetProcessPrivateBytes();
+};
@@ -0,0 +1,258 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/Profiler.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Standard
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfileThreadBuffer
+{
+	ProfileEvent						m_events[Profiler::EVENTS_PER_THREAD];
+	//Only the owning thread stores, the exporting thread loads
+	std::atomic<uint64_t>				m_numWritten{ 0 };
+	uint64_t							m_numWrittenAtCaptureStart = 0;
+
+	const char*							m_threadName = nullptr;
+	int									m_threadIndex = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Buffers outlive their threads so zones from a worker that already exited still make it into the trace
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfileThreadBufferList
+{
+	std::mutex							m_mutex;
+	std::vector<ProfileThreadBuffer*>	m_buffers;
+
+	~ProfileThreadBufferList()
+	{
+		for (int bufferIndex = 0; bufferIndex < (int)m_buffers.size(); ++bufferIndex)
+		{
+			delete m_buffers[bufferIndex];
+		}
+		m_buffers.clear();
+	}
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+static std::atomic<bool> gIsProfilerCapturing{ false };
+static ProfileThreadBufferList gProfileThreadBuffers;
+thread_local ProfileThreadBuffer* tl_profileThreadBuffer = nullptr;
+
+//Capture state, main thread only
+static int gCaptureFramesRemaining = 0;
+static uint64_t gCaptureStartNs = 0;
+static std::string gCaptureTracePath;
+static int gLastNumEvents = 0;
+static int gLastNumDroppedEvents = 0;
+static bool gWasLastTraceWritten = false;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void WriteEscapedJSONString(std::ofstream& file, const char* text)
+{
+	file << '"';
+	for (const char* character = text; *character != '\0'; ++character)
+	{
+		if (*character == '"' || *character == '\\')
+		{
+			file << '\\';
+		}
+		file << *character;
+	}
+	file << '"';
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void Profiler::SetThreadName(const char* threadName)
+{
+	GetThreadBuffer().m_threadName = threadName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void Profiler::BeginCapture(int numFrames, const std::string& tracePath)
+{
+	if (IsCapturing() || numFrames <= 0)
+	{
+		return;
+	}
+
+	{
+		//Only zones written from here on belong to this capture
+		std::lock_guard<std::mutex> lock(gProfileThreadBuffers.m_mutex);
+		for (int bufferIndex = 0; bufferIndex < (int)gProfileThreadBuffers.m_buffers.size(); ++bufferIndex)
+		{
+			ProfileThreadBuffer* buffer = gProfileThreadBuffers.m_buffers[bufferIndex];
+			buffer->m_numWrittenAtCaptureStart = buffer->m_numWritten.load(std::memory_order_acquire);
+		}
+	}
+
+	gCaptureFramesRemaining = numFrames;
+	gCaptureTracePath = tracePath;
+	gCaptureStartNs = GetTimeNs();
+	gIsProfilerCapturing.store(true, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Profiler::IsCapturing()
+{
+	return gIsProfilerCapturing.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Profiler::EndFrame()
+{
+	if (!IsCapturing())
+	{
+		return false;
+	}
+
+	gCaptureFramesRemaining--;
+	if (gCaptureFramesRemaining > 0)
+	{
+		return false;
+	}
+
+	gIsProfilerCapturing.store(false, std::memory_order_release);
+	gWasLastTraceWritten = WriteChromeTrace();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void Profiler::RecordZone(const char* name, uint64_t startNs, uint64_t endNs)
+{
+	ProfileThreadBuffer& buffer = GetThreadBuffer();
+
+	//Single writer per buffer, so a plain load and a release store are enough to publish the slot
+	uint64_t eventIndex = buffer.m_numWritten.load(std::memory_order_relaxed);
+	ProfileEvent& profileEvent = buffer.m_events[eventIndex % EVENTS_PER_THREAD];
+	profileEvent.m_name = name;
+	profileEvent.m_startNs = startNs;
+	profileEvent.m_endNs = endNs;
+
+	buffer.m_numWritten.store(eventIndex + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t Profiler::GetTimeNs()
+{
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const std::string& Profiler::GetLastTracePath()
+{
+	return gCaptureTracePath;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC int Profiler::GetLastNumEvents()
+{
+	return gLastNumEvents;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC int Profiler::GetLastNumDroppedEvents()
+{
+	return gLastNumDroppedEvents;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Profiler::WasLastTraceWritten()
+{
+	return gWasLastTraceWritten;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC ProfileThreadBuffer& Profiler::GetThreadBuffer()
+{
+	if (tl_profileThreadBuffer == nullptr)
+	{
+		//Once per thread, the only time recording takes a lock
+		ProfileThreadBuffer* buffer = new ProfileThreadBuffer();
+
+		std::lock_guard<std::mutex> lock(gProfileThreadBuffers.m_mutex);
+		buffer->m_threadIndex = (int)gProfileThreadBuffers.m_buffers.size();
+		gProfileThreadBuffers.m_buffers.push_back(buffer);
+
+		tl_profileThreadBuffer = buffer;
+	}
+
+	return *tl_profileThreadBuffer;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Profiler::WriteChromeTrace()
+{
+	gLastNumEvents = 0;
+	gLastNumDroppedEvents = 0;
+
+	std::ofstream file(gCaptureTracePath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(gProfileThreadBuffers.m_mutex);
+
+	file << "{\"traceEvents\":[\n";
+	bool isFirstEvent = true;
+	char line[256];
+
+	for (int bufferIndex = 0; bufferIndex < (int)gProfileThreadBuffers.m_buffers.size(); ++bufferIndex)
+	{
+		const ProfileThreadBuffer& buffer = *gProfileThreadBuffers.m_buffers[bufferIndex];
+
+		uint64_t endIndex = buffer.m_numWritten.load(std::memory_order_acquire);
+		uint64_t startIndex = buffer.m_numWrittenAtCaptureStart;
+		if (endIndex - startIndex > (uint64_t)EVENTS_PER_THREAD)
+		{
+			//The ring wrapped during the capture, the oldest zones are gone
+			gLastNumDroppedEvents += (int)(endIndex - startIndex - EVENTS_PER_THREAD);
+			startIndex = endIndex - EVENTS_PER_THREAD;
+		}
+
+		if (startIndex == endIndex)
+		{
+			continue;
+		}
+
+		char fallbackName[32];
+		snprintf(fallbackName, sizeof(fallbackName), "Thread %d", buffer.m_threadIndex);
+
+		file << (isFirstEvent ? "" : ",\n");
+		snprintf(line, sizeof(line), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", buffer.m_threadIndex);
+		file << line;
+		WriteEscapedJSONString(file, buffer.m_threadName != nullptr ? buffer.m_threadName : fallbackName);
+		file << "}}";
+		isFirstEvent = false;
+
+		for (uint64_t eventIndex = startIndex; eventIndex < endIndex; ++eventIndex)
+		{
+			const ProfileEvent& profileEvent = buffer.m_events[eventIndex % EVENTS_PER_THREAD];
+			if (profileEvent.m_startNs < gCaptureStartNs)
+			{
+				//Opened before the capture began
+				continue;
+			}
+
+			file << ",\n{\"name\":";
+			WriteEscapedJSONString(file, profileEvent.m_name);
+			snprintf(line, sizeof(line), ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer.m_threadIndex,
+				(double)(profileEvent.m_startNs - gCaptureStartNs) / 1000.0, (double)(profileEvent.m_endNs - profileEvent.m_startNs) / 1000.0);
+			file << line;
+			gLastNumEvents++;
+		}
+	}
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return file.good();
+}
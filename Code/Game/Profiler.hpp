@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Standard
+#include <stdint.h>
+#include <string>
+
+struct ProfileThreadBuffer;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfileEvent
+{
+	const char*							m_name = nullptr;
+	uint64_t							m_startNs = 0;
+	uint64_t							m_endNs = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Captures scoped CPU zones for a window of frames and writes them out as Chrome trace JSON (chrome://tracing or Perfetto).
+// Every thread that records a zone gets its own ring buffer, written only by that thread and published with an atomic
+// counter, so recording never takes a lock. Outside a capture a zone costs one relaxed atomic load.
+// Zone names must be string literals or otherwise outlive the capture
+//------------------------------------------------------------------------------------------------------------------------------
+class Profiler
+{
+public:
+	static const int EVENTS_PER_THREAD = 16384;
+
+public:
+	static void							SetThreadName(const char* threadName);
+
+	static void							BeginCapture(int numFrames, const std::string& tracePath);
+	static bool							IsCapturing();
+
+	//Call once per frame (or headless step) from the main thread. Returns true on the frame a capture finished and was written
+	static bool							EndFrame();
+
+	static void							RecordZone(const char* name, uint64_t startNs, uint64_t endNs);
+	static uint64_t						GetTimeNs();
+
+	static const std::string&			GetLastTracePath();
+	static int							GetLastNumEvents();
+	static int							GetLastNumDroppedEvents();
+	static bool							WasLastTraceWritten();
+
+private:
+	static ProfileThreadBuffer&			GetThreadBuffer();
+	static bool							WriteChromeTrace();
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name)
+	{
+		if (Profiler::IsCapturing())
+		{
+			m_name = name;
+			m_startNs = Profiler::GetTimeNs();
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (m_name != nullptr)
+		{
+			Profiler::RecordZone(m_name, m_startNs, Profiler::GetTimeNs());
+		}
+	}
+
+private:
+	const char*							m_name = nullptr;
+	uint64_t							m_startNs = 0;
+};
+
+#define PROFILE_SCOPE_JOIN_INNER(a, b) a##b
+#define PROFILE_SCOPE_JOIN(a, b) PROFILE_SCOPE_JOIN_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_JOIN(profileScope_, __LINE__)(name)
@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/ProjectilePool.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Well below the bounds so parked bodies never show up in suspension queries
+const PxVec3 gProjectileParkingOrigin = PxVec3(0.f, -10000.f, 0.f);
+const float gProjectileParkingSpacing = 10.f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProjectilePool::ProjectilePool()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProjectilePool::~ProjectilePool()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProjectilePool::StartUp(PxPhysics& physX, PxScene& pxScene, PxMaterial& material, const PxGeometry& geometry, const PxFilterData& simFilterData,
+	const PxFilterData& queryFilterData, float density, int capacity)
+{
+	m_shape = physX.createShape(geometry, material, false);
+	m_shape->setSimulationFilterData(simFilterData);
+	m_shape->setQueryFilterData(queryFilterData);
+
+	m_projectiles.resize(capacity);
+	std::vector<PxActor*> actors;
+	actors.reserve(capacity);
+
+	for (int projectileIndex = 0; projectileIndex < capacity; ++projectileIndex)
+	{
+		PxRigidDynamic* actor = physX.createRigidDynamic(GetParkingPose(projectileIndex));
+		actor->attachShape(*m_shape);
+
+		if (projectileIndex == 0)
+		{
+			PxRigidBodyExt::updateMassAndInertia(*actor, density);
+		}
+		else
+		{
+			PxRigidDynamic* firstActor = m_projectiles[0].m_actor;
+			actor->setMass(firstActor->getMass());
+			actor->setMassSpaceInertiaTensor(firstActor->getMassSpaceInertiaTensor());
+			actor->setCMassLocalPose(firstActor->getCMassLocalPose());
+		}
+
+		//Fast projectiles tunnel through thin obstacles without CCD
+		actor->setRigidBodyFlag(PxRigidBodyFlag::eENABLE_CCD, true);
+		actor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, true);
+
+		m_projectiles[projectileIndex].m_actor = actor;
+		actors.push_back(actor);
+	}
+
+	if (!actors.empty())
+	{
+		pxScene.addActors(&actors[0], (PxU32)actors.size());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProjectilePool::Shutdown()
+{
+	for (int projectileIndex = 0; projectileIndex < (int)m_projectiles.size(); ++projectileIndex)
+	{
+		m_projectiles[projectileIndex].m_actor->release();
+	}
+	m_projectiles.clear();
+	m_movedActors.clear();
+
+	if (m_shape != nullptr)
+	{
+		m_shape->release();
+		m_shape = nullptr;
+	}
+
+	m_numActive = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxRigidDynamic* ProjectilePool::Fire(const PxTransform& pose, const PxVec3& velocity)
+{
+	if (m_projectiles.empty())
+	{
+		return nullptr;
+	}
+
+	//First parked slot, otherwise the oldest live one
+	int chosenIndex = -1;
+	float oldestAge = -1.f;
+	for (int projectileIndex = 0; projectileIndex < (int)m_projectiles.size(); ++projectileIndex)
+	{
+		const PooledProjectile& projectile = m_projectiles[projectileIndex];
+		if (!projectile.m_isActive)
+		{
+			chosenIndex = projectileIndex;
+			break;
+		}
+
+		if (projectile.m_ageSeconds > oldestAge)
+		{
+			oldestAge = projectile.m_ageSeconds;
+			chosenIndex = projectileIndex;
+		}
+	}
+
+	PooledProjectile& projectile = m_projectiles[chosenIndex];
+	if (projectile.m_isActive)
+	{
+		m_numRecycled++;
+	}
+	else
+	{
+		m_numActive++;
+	}
+
+	PxRigidDynamic* actor = projectile.m_actor;
+
+	//Velocities can only be set once the body simulates again
+	actor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, false);
+	actor->setGlobalPose(pose);
+	actor->setLinearVelocity(velocity);
+	actor->setAngularVelocity(PxVec3(0.f, 0.f, 0.f));
+	actor->wakeUp();
+
+	projectile.m_isActive = true;
+	projectile.m_ageSeconds = 0.f;
+
+	m_numFired++;
+	m_movedActors.push_back(actor);
+	return actor;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProjectilePool::Update(float deltaSeconds)
+{
+	for (int projectileIndex = 0; projectileIndex < (int)m_projectiles.size(); ++projectileIndex)
+	{
+		PooledProjectile& projectile = m_projectiles[projectileIndex];
+		if (!projectile.m_isActive)
+		{
+			continue;
+		}
+
+		projectile.m_ageSeconds += deltaSeconds;
+
+		bool isExpired = projectile.m_ageSeconds >= m_lifetimeSeconds;
+		bool isOutOfBounds = !m_bounds.contains(projectile.m_actor->getGlobalPose().p);
+		if (isExpired || isOutOfBounds)
+		{
+			Park(projectileIndex);
+			m_numDespawned++;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProjectilePool::ParkAll()
+{
+	for (int projectileIndex = 0; projectileIndex < (int)m_projectiles.size(); ++projectileIndex)
+	{
+		if (m_projectiles[projectileIndex].m_isActive)
+		{
+			Park(projectileIndex);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProjectilePool::Park(int projectileIndex)
+{
+	PooledProjectile& projectile = m_projectiles[projectileIndex];
+	PxRigidDynamic* actor = projectile.m_actor;
+
+	actor->setLinearVelocity(PxVec3(0.f, 0.f, 0.f));
+	actor->setAngularVelocity(PxVec3(0.f, 0.f, 0.f));
+	actor->setGlobalPose(GetParkingPose(projectileIndex));
+	actor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, true);
+
+	projectile.m_isActive = false;
+	projectile.m_ageSeconds = 0.f;
+
+	m_numActive--;
+	m_movedActors.push_back(actor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxTransform ProjectilePool::GetParkingPose(int projectileIndex) const
+{
+	//Spread out so parked bodies never overlap if simulation is ever turned back on in place
+	return PxTransform(gProjectileParkingOrigin + PxVec3(projectileIndex * gProjectileParkingSpacing, 0.f, 0.f));
+}
@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <vector>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PooledProjectile
+{
+	PxRigidDynamic*						m_actor = nullptr;
+	float								m_ageSeconds = 0.f;
+	bool								m_isActive = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Fixed set of rigid bodies that all share one shape. Parked bodies stay in the scene with simulation disabled under the
+// world, so firing is a teleport instead of an allocation and the actor count never grows. Projectiles despawn when they
+// outlive their lifetime or leave the bounds, and when every slot is busy the oldest one is recycled
+//------------------------------------------------------------------------------------------------------------------------------
+class ProjectilePool
+{
+public:
+	ProjectilePool();
+	~ProjectilePool();
+
+	void								StartUp(PxPhysics& physX, PxScene& pxScene, PxMaterial& material, const PxGeometry& geometry, const PxFilterData& simFilterData,
+											const PxFilterData& queryFilterData, float density, int capacity);
+	void								Shutdown();
+
+	PxRigidDynamic*						Fire(const PxTransform& pose, const PxVec3& velocity);
+	void								Update(float deltaSeconds);
+	void								ParkAll();
+
+	void								SetLifetimeSeconds(float lifetimeSeconds) { m_lifetimeSeconds = lifetimeSeconds; }
+	void								SetBounds(const PxBounds3& bounds) { m_bounds = bounds; }
+
+	//Actors fired or parked since the last ClearMovedActors, for anything caching their poses
+	const std::vector<PxRigidDynamic*>&	GetMovedActors() const { return m_movedActors; }
+	void								ClearMovedActors() { m_movedActors.clear(); }
+
+	int									GetCapacity() const { return (int)m_projectiles.size(); }
+	int									GetNumActive() const { return m_numActive; }
+	int									GetNumFired() const { return m_numFired; }
+	int									GetNumRecycled() const { return m_numRecycled; }
+	int									GetNumDespawned() const { return m_numDespawned; }
+
+private:
+	void								Park(int projectileIndex);
+	PxTransform							GetParkingPose(int projectileIndex) const;
+
+private:
+	std::vector<PooledProjectile>		m_projectiles;
+	std::vector<PxRigidDynamic*>		m_movedActors;
+	PxShape*							m_shape = nullptr;
+
+	float								m_lifetimeSeconds = 10.f;
+	PxBounds3							m_bounds = PxBounds3(PxVec3(-1000.f, -50.f, -1000.f), PxVec3(1000.f, 1000.f, 1000.f));
+
+	int									m_numActive = 0;
+	int									m_numFired = 0;
+	int									m_numRecycled = 0;
+	int									m_numDespawned = 0;
+};
@@ -0,0 +1,273 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/SceneBenchmark.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/AllocationCounter.hpp"
+#include "Game/Game.hpp"
+#include "Game/PhysXPoolAllocator.hpp"
+//Standard
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <stdio.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static double GetBenchmarkTimeSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+SceneBenchmark::SceneBenchmark(const SceneBenchmarkSettings& settings)
+	: m_settings(settings)
+{
+	m_stepSeconds.reserve(m_settings.m_numSteps);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+SceneBenchmark::~SceneBenchmark()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const char* SceneBenchmark::GetBuilderName(eSceneBenchmarkBuilder builder)
+{
+	switch (builder)
+	{
+	case SCENE_BENCHMARK_STACKS:		return "stacks";
+	case SCENE_BENCHMARK_WALL:			return "wall";
+	case SCENE_BENCHMARK_CHAINS:		return "chains";
+	case SCENE_BENCHMARK_ARTICULATION:	return "articulation";
+	case SCENE_BENCHMARK_CONVEX_HULLS:	return "convexHulls";
+	case SCENE_BENCHMARK_VEHICLES:		return "vehicles";
+	default:							return "unknown";
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SceneBenchmark::Run()
+{
+	if (m_settings.m_numSteps <= 0 || m_settings.m_stepSeconds <= 0.f)
+	{
+		ERROR_AND_DIE(">> Scene benchmark needs a positive step count and step size");
+	}
+
+	printf("\n >> Scene benchmark : %i warm-up and %i measured steps of %f s per builder", m_settings.m_numWarmupSteps, m_settings.m_numSteps,
+		m_settings.m_stepSeconds);
+	printf("\n >> %-14s %9s %9s %9s %9s %9s %8s %8s", "Builder", "Build ms", "Mean ms", "p50 ms", "p99 ms", "Max ms", "Dynamic", "Static");
+
+	for (int builderIndex = 0; builderIndex < NUM_SCENE_BENCHMARK_BUILDERS; ++builderIndex)
+	{
+		eSceneBenchmarkBuilder builder = (eSceneBenchmarkBuilder)builderIndex;
+		if (!ShouldRunBuilder(builder))
+		{
+			continue;
+		}
+
+		m_results.emplace_back();
+		RunCase(MakeCase(builder), m_results.back());
+		PrintResult(m_results.back());
+	}
+
+	bool isWritten = WriteJSON();
+	printf("\n >> Scene benchmark results %s %s\n", isWritten ? "written to" : "could not be written to", m_settings.m_jsonPath.c_str());
+	return isWritten;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SceneBenchmark::ShouldRunBuilder(eSceneBenchmarkBuilder builder) const
+{
+	if (m_settings.m_buildersToRun.empty())
+	{
+		return true;
+	}
+
+	//Whole names only, so "wall" does not also pick something like "wallRun"
+	std::string name = GetBuilderName(builder);
+	std::string builders = "," + m_settings.m_buildersToRun + ",";
+	return builders.find("," + name + ",") != std::string::npos;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+SceneBenchmarkCase SceneBenchmark::MakeCase(eSceneBenchmarkBuilder builder) const
+{
+	SceneBenchmarkCase benchmarkCase;
+	benchmarkCase.m_builder = builder;
+
+	switch (builder)
+	{
+	case SCENE_BENCHMARK_STACKS:
+		benchmarkCase.m_size = m_settings.m_stackSize;
+		benchmarkCase.m_count = m_settings.m_numStacks;
+		break;
+	case SCENE_BENCHMARK_WALL:
+		benchmarkCase.m_size = m_settings.m_wallWidth;
+		benchmarkCase.m_count = m_settings.m_wallHeight;
+		break;
+	case SCENE_BENCHMARK_CHAINS:
+		benchmarkCase.m_size = m_settings.m_chainLength;
+		break;
+	case SCENE_BENCHMARK_ARTICULATION:
+		benchmarkCase.m_size = m_settings.m_numCapsules;
+		break;
+	case SCENE_BENCHMARK_CONVEX_HULLS:
+		benchmarkCase.m_count = m_settings.m_numConvexHulls;
+		break;
+	case SCENE_BENCHMARK_VEHICLES:
+		benchmarkCase.m_size = m_settings.m_numVehicles;
+		break;
+	default:
+		break;
+	}
+
+	return benchmarkCase;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneBenchmark::RunCase(const SceneBenchmarkCase& benchmarkCase, SceneBenchmarkResult& result)
+{
+	result.m_case = benchmarkCase;
+
+	//Every case gets an empty scene, nothing a previous builder left behind can skew the next one
+	g_PxPhysXSystem = new PhysXSystem();
+
+	AllocationCounter::SetEnabled(true);
+	uint64_t numAllocationsAtStart = AllocationCounter::GetNumAllocations();
+	uint64_t numBytesAtStart = AllocationCounter::GetNumBytes();
+	double buildStart = GetBenchmarkTimeSeconds();
+
+	Game* game = new Game(true);
+	game->StartUpBenchmark(benchmarkCase);
+
+	result.m_buildMs = (GetBenchmarkTimeSeconds() - buildStart) * 1000.0;
+	result.m_buildHeapAllocations = AllocationCounter::GetNumAllocations() - numAllocationsAtStart;
+	result.m_buildHeapBytes = AllocationCounter::GetNumBytes() - numBytesAtStart;
+
+	m_stepSeconds.clear();
+	uint64_t numAllocationsAtMeasureStart = 0;
+	float stepSeconds = m_settings.m_stepSeconds;
+	for (int stepIndex = 0; stepIndex < m_settings.m_numWarmupSteps + m_settings.m_numSteps; ++stepIndex)
+	{
+		if (stepIndex == m_settings.m_numWarmupSteps)
+		{
+			numAllocationsAtMeasureStart = AllocationCounter::GetNumAllocations();
+		}
+
+		double stepStart = GetBenchmarkTimeSeconds();
+
+		g_PxPhysXSystem->BeginFrame();
+		game->UpdateVehicles(stepSeconds);
+		g_PxPhysXSystem->Update(stepSeconds);
+		g_PxPhysXSystem->EndFrame();
+
+		if (stepIndex >= m_settings.m_numWarmupSteps)
+		{
+			m_stepSeconds.push_back(GetBenchmarkTimeSeconds() - stepStart);
+		}
+	}
+
+	result.m_stepHeapAllocations = AllocationCounter::GetNumAllocations() - numAllocationsAtMeasureStart;
+	AllocationCounter::SetEnabled(false);
+	//Nothing here is a steady-state check, drop anything the Game's own scopes recorded
+	AllocationCounter::ClearScopeFailures();
+
+	double totalSeconds = 0.0;
+	for (int stepIndex = 0; stepIndex < (int)m_stepSeconds.size(); ++stepIndex)
+	{
+		totalSeconds += m_stepSeconds[stepIndex];
+	}
+	result.m_meanStepMs = totalSeconds * 1000.0 / (double)m_stepSeconds.size();
+	result.m_p50StepMs = GetStepPercentileMs(50.f);
+	result.m_p99StepMs = GetStepPercentileMs(99.f);
+	result.m_maxStepMs = GetStepPercentileMs(100.f);
+
+	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
+	PxSimulationStatistics stats;
+	scene->getSimulationStatistics(stats);
+
+	result.m_numDynamicActors = (int)scene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC);
+	result.m_numStaticActors = (int)scene->getNbActors(PxActorTypeFlag::eRIGID_STATIC);
+	result.m_numArticulations = (int)scene->getNbArticulations();
+	result.m_numConstraints = (int)scene->getNbConstraints();
+	result.m_numVehicles = game->GetVehicleManager()->GetNumVehicles();
+	result.m_physXPoolLiveBytes = g_PxPoolAllocator.GetLiveBytes();
+	result.m_bytesPerAIVehicle = game->GetBytesPerAIVehicle();
+	result.m_peakConstraintMemory = stats.peakConstraintMemory;
+
+	delete game;
+	game = nullptr;
+
+	delete g_PxPhysXSystem;
+	g_PxPhysXSystem = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double SceneBenchmark::GetStepPercentileMs(float percentile)
+{
+	int numSteps = (int)m_stepSeconds.size();
+
+	//Nearest rank
+	int rank = (int)(percentile * 0.01f * (float)(numSteps - 1) + 0.5f);
+	if (rank < 0)
+	{
+		rank = 0;
+	}
+	else if (rank > numSteps - 1)
+	{
+		rank = numSteps - 1;
+	}
+	std::nth_element(m_stepSeconds.begin(), m_stepSeconds.begin() + rank, m_stepSeconds.end());
+
+	return m_stepSeconds[rank] * 1000.0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneBenchmark::PrintResult(const SceneBenchmarkResult& result) const
+{
+	printf("\n >> %-14s %9.3f %9.4f %9.4f %9.4f %9.4f %8i %8i", GetBuilderName(result.m_case.m_builder), result.m_buildMs, result.m_meanStepMs,
+		result.m_p50StepMs, result.m_p99StepMs, result.m_maxStepMs, result.m_numDynamicActors, result.m_numStaticActors);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SceneBenchmark::WriteJSON() const
+{
+	std::ofstream file(m_settings.m_jsonPath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	char line[512];
+	snprintf(line, sizeof(line), "{\n\"steps\":%d,\n\"warmupSteps\":%d,\n\"stepSeconds\":%f,\n\"heapCounts\":\"%s\",\n\"cases\":[", m_settings.m_numSteps,
+		m_settings.m_numWarmupSteps, m_settings.m_stepSeconds, AllocationCounter::GetCoverageDescription());
+	file << line;
+
+	for (int resultIndex = 0; resultIndex < (int)m_results.size(); ++resultIndex)
+	{
+		const SceneBenchmarkResult& result = m_results[resultIndex];
+
+		snprintf(line, sizeof(line), "%s\n{\"builder\":\"%s\",\"size\":%d,\"count\":%d,\"buildMs\":%.4f,", resultIndex == 0 ? "" : ",",
+			GetBuilderName(result.m_case.m_builder), result.m_case.m_size, result.m_case.m_count, result.m_buildMs);
+		file << line;
+
+		snprintf(line, sizeof(line), "\"stepMs\":{\"mean\":%.4f,\"p50\":%.4f,\"p99\":%.4f,\"max\":%.4f},", result.m_meanStepMs, result.m_p50StepMs,
+			result.m_p99StepMs, result.m_maxStepMs);
+		file << line;
+
+		snprintf(line, sizeof(line), "\"actors\":{\"dynamic\":%d,\"static\":%d,\"articulations\":%d,\"constraints\":%d,\"vehicles\":%d},",
+			result.m_numDynamicActors, result.m_numStaticActors, result.m_numArticulations, result.m_numConstraints, result.m_numVehicles);
+		file << line;
+
+		snprintf(line, sizeof(line), "\"memory\":{\"buildHeapBytes\":%llu,\"buildHeapAllocations\":%llu,\"stepHeapAllocations\":%llu,"
+			"\"physXPoolLiveBytes\":%lld,\"peakConstraintMemory\":%u,\"bytesPerAIVehicle\":%lld}}", (unsigned long long)result.m_buildHeapBytes,
+			(unsigned long long)result.m_buildHeapAllocations, (unsigned long long)result.m_stepHeapAllocations, (long long)result.m_physXPoolLiveBytes,
+			result.m_peakConstraintMemory, (long long)result.m_bytesPerAIVehicle);
+		file << line;
+	}
+
+	file << "\n]\n}\n";
+	return file.good();
+}
@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Standard
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eSceneBenchmarkBuilder
+{
+	SCENE_BENCHMARK_STACKS,
+	SCENE_BENCHMARK_WALL,
+	SCENE_BENCHMARK_CHAINS,
+	SCENE_BENCHMARK_ARTICULATION,
+	SCENE_BENCHMARK_CONVEX_HULLS,
+	SCENE_BENCHMARK_VEHICLES,
+
+	NUM_SCENE_BENCHMARK_BUILDERS
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One Game scene builder at one scale. What m_size and m_count mean depends on the builder:
+// stacks (layers, stacks), wall (width, height), chains (length, -), articulation (capsules, -), convex hulls (-, hulls),
+// vehicles (AI vehicles, -)
+//------------------------------------------------------------------------------------------------------------------------------
+struct SceneBenchmarkCase
+{
+	eSceneBenchmarkBuilder				m_builder = SCENE_BENCHMARK_STACKS;
+	int									m_size = 0;
+	int									m_count = 1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SceneBenchmarkSettings
+{
+	int									m_numSteps = 600;
+	int									m_numWarmupSteps = 60;
+	float								m_stepSeconds = 1.f / 60.f;
+
+	int									m_stackSize = 10;
+	int									m_numStacks = 5;
+	int									m_wallWidth = 12;
+	int									m_wallHeight = 4;
+	int									m_chainLength = 5;
+	int									m_numCapsules = 40;
+	int									m_numConvexHulls = 16;
+	int									m_numVehicles = 64;
+
+	//Comma separated builder names, empty runs every builder
+	std::string							m_buildersToRun;
+	std::string							m_jsonPath = "SceneBenchmark.json";
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SceneBenchmarkResult
+{
+	SceneBenchmarkCase					m_case;
+
+	double								m_buildMs = 0.0;
+	double								m_meanStepMs = 0.0;
+	double								m_p50StepMs = 0.0;
+	double								m_p99StepMs = 0.0;
+	double								m_maxStepMs = 0.0;
+
+	int									m_numDynamicActors = 0;
+	int									m_numStaticActors = 0;
+	int									m_numArticulations = 0;
+	int									m_numConstraints = 0;
+	int									m_numVehicles = 0;
+
+	//operator new traffic, PhysX's own foundation allocations are not included
+	uint64_t							m_buildHeapBytes = 0;
+	uint64_t							m_buildHeapAllocations = 0;
+	uint64_t							m_stepHeapAllocations = 0;
+	//Game owned PhysX allocations still live after the measured steps
+	int64_t								m_physXPoolLiveBytes = 0;
+	uint32_t							m_peakConstraintMemory = 0;
+	//Process private bytes per spawned AI car, PhysX foundation allocations included. Only the vehicles builder spawns any
+	int64_t								m_bytesPerAIVehicle = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Runs each Game scene builder on its own fresh PhysXSystem and Game, steps it a fixed number of times and writes step
+// time percentiles, memory and actor counts as JSON. Headless only, it owns g_PxPhysXSystem while it runs
+//------------------------------------------------------------------------------------------------------------------------------
+class SceneBenchmark
+{
+public:
+	explicit SceneBenchmark(const SceneBenchmarkSettings& settings);
+	~SceneBenchmark();
+
+	static const char*					GetBuilderName(eSceneBenchmarkBuilder builder);
+
+	//Returns false if the results could not be written
+	bool								Run();
+
+private:
+	bool								ShouldRunBuilder(eSceneBenchmarkBuilder builder) const;
+	SceneBenchmarkCase					MakeCase(eSceneBenchmarkBuilder builder) const;
+	void								RunCase(const SceneBenchmarkCase& benchmarkCase, SceneBenchmarkResult& result);
+	double								GetStepPercentileMs(float percentile);
+	void								PrintResult(const SceneBenchmarkResult& result) const;
+	bool								WriteJSON() const;
+
+private:
+	SceneBenchmarkSettings				m_settings;
+	std::vector<SceneBenchmarkResult>	m_results;
+	//Measured steps of the case being run
+	std::vector<double>					m_stepSeconds;
+};
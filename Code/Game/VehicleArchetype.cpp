@@ -0,0 +1,328 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/VehicleArchetype.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
+//Standard
+#include <chrono>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+const int gVehicleWheelMeshSides = 16;
+const PxU16 gVehicleMeshVertexLimit = 255;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static double GetArchetypeTimeSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleArchetype::VehicleArchetype(const VehicleDescriptor& descriptor, const VehicleSimTemplate& simTemplate, const VehicleShapeMeshes& shapeMeshes)
+	: m_descriptor(descriptor)
+{
+	double buildStart = GetArchetypeTimeSeconds();
+
+	m_vehicleDesc = MakeVehicleDesc(m_descriptor);
+	m_chassisData.mMOI = m_vehicleDesc.chassisMOI;
+	m_chassisData.mMass = m_vehicleDesc.chassisMass;
+	m_chassisData.mCMOffset = m_vehicleDesc.chassisCMOffset;
+
+	m_wheelMesh = shapeMeshes.m_wheelMesh;
+	m_wheelMesh->acquireReference();
+	m_chassisMesh = shapeMeshes.m_chassisMesh;
+	m_chassisMesh->acquireReference();
+
+	m_wheelsSimData = PxVehicleWheelsSimData::allocate(simTemplate.m_wheelsSimData->getNbWheels());
+	*m_wheelsSimData = *simTemplate.m_wheelsSimData;
+	m_driveSimData = simTemplate.m_driveSimData;
+
+	FitSimDataToBody(simTemplate.m_vehicleDesc);
+	m_descriptor.ApplyToSimData(*m_wheelsSimData, m_driveSimData);
+
+	m_steerVsForwardSpeedTable = m_descriptor.MakeSteerVsForwardSpeedTable();
+	m_padSmoothingData = m_descriptor.MakePadSmoothingData();
+
+	m_buildSeconds = GetArchetypeTimeSeconds() - buildStart;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleArchetype::~VehicleArchetype()
+{
+	if (m_wheelsSimData != nullptr)
+	{
+		m_wheelsSimData->free();
+		m_wheelsSimData = nullptr;
+	}
+
+	PX_RELEASE(m_wheelMesh);
+	PX_RELEASE(m_chassisMesh);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxVehicleDrive4W* VehicleArchetype::CreateVehicle(PxPhysics& physX)
+{
+	PxU32 numWheels = m_wheelsSimData->getNbWheels();
+
+	PxConvexMesh* wheelMeshes[PX_MAX_NB_WHEELS];
+	PxMaterial* wheelMaterials[PX_MAX_NB_WHEELS];
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; ++wheelIndex)
+	{
+		wheelMeshes[wheelIndex] = m_wheelMesh;
+		wheelMaterials[wheelIndex] = m_vehicleDesc.wheelMaterial;
+	}
+
+	PxConvexMesh* chassisMeshes[1] = { m_chassisMesh };
+	PxMaterial* chassisMaterials[1] = { m_vehicleDesc.chassisMaterial };
+
+	PxRigidDynamic* actor = createVehicleActor(m_chassisData, wheelMaterials, wheelMeshes, numWheels, m_vehicleDesc.wheelSimFilterData,
+		chassisMaterials, chassisMeshes, 1, m_vehicleDesc.chassisSimFilterData, physX);
+
+	//setup copies the sim data into the vehicle's block, nothing here is computed again
+	PxVehicleDrive4W* vehicle = PxVehicleDrive4W::allocate(numWheels);
+	vehicle->setup(&physX, actor, *m_wheelsSimData, m_driveSimData, numWheels - 4);
+
+	m_numInstancesCreated++;
+	return vehicle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleArchetype::FitSimDataToBody(const VehicleDesc& templateDesc)
+{
+	//Wheels keep the template's place relative to the chassis box: sides flush, tops under the floor, axles at the same
+	//fraction of the length. With the template's body and masses nothing below changes
+	const PxVec3 chassisDelta = m_vehicleDesc.chassisDims - templateDesc.chassisDims;
+	const float wheelWidthDelta = m_vehicleDesc.wheelWidth - templateDesc.wheelWidth;
+	const float wheelRadiusDelta = m_vehicleDesc.wheelRadius - templateDesc.wheelRadius;
+	const float lengthScale = m_vehicleDesc.chassisDims.z / templateDesc.chassisDims.z;
+
+	PxU32 numWheels = m_wheelsSimData->getNbWheels();
+	PxVec3 wheelActorOffsets[PX_MAX_NB_WHEELS];
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; ++wheelIndex)
+	{
+		PxVec3 templateOffset = m_wheelsSimData->getWheelCentreOffset(wheelIndex) + templateDesc.chassisCMOffset;
+		float side = templateOffset.x < 0.f ? -1.f : 1.f;
+
+		wheelActorOffsets[wheelIndex].x = templateOffset.x + side * 0.5f * (chassisDelta.x - wheelWidthDelta);
+		wheelActorOffsets[wheelIndex].y = templateOffset.y - 0.5f * chassisDelta.y - wheelRadiusDelta;
+		wheelActorOffsets[wheelIndex].z = templateOffset.z * lengthScale;
+	}
+
+	PxF32 sprungMasses[PX_MAX_NB_WHEELS];
+	PxVehicleComputeSprungMasses(numWheels, wheelActorOffsets, m_vehicleDesc.chassisCMOffset, m_vehicleDesc.chassisMass, 1, sprungMasses);
+
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; ++wheelIndex)
+	{
+		PxVehicleWheelData wheel = m_wheelsSimData->getWheelData(wheelIndex);
+		wheel.mMass = m_vehicleDesc.wheelMass;
+		wheel.mMOI = m_vehicleDesc.wheelMOI;
+		wheel.mRadius = m_vehicleDesc.wheelRadius;
+		wheel.mWidth = m_vehicleDesc.wheelWidth;
+		m_wheelsSimData->setWheelData(wheelIndex, wheel);
+
+		PxVehicleSuspensionData suspension = m_wheelsSimData->getSuspensionData(wheelIndex);
+		suspension.mSprungMass = sprungMasses[wheelIndex];
+		m_wheelsSimData->setSuspensionData(wheelIndex, suspension);
+
+		//Suspension and tire forces stay at the template's height relative to the centre of mass
+		PxVec3 wheelCentreOffset = wheelActorOffsets[wheelIndex] - m_vehicleDesc.chassisCMOffset;
+		PxVec3 suspForceOffset = m_wheelsSimData->getSuspForceAppPointOffset(wheelIndex);
+		PxVec3 tireForceOffset = m_wheelsSimData->getTireForceAppPointOffset(wheelIndex);
+		m_wheelsSimData->setWheelCentreOffset(wheelIndex, wheelCentreOffset);
+		m_wheelsSimData->setSuspForceAppPointOffset(wheelIndex, PxVec3(wheelCentreOffset.x, suspForceOffset.y, wheelCentreOffset.z));
+		m_wheelsSimData->setTireForceAppPointOffset(wheelIndex, PxVec3(wheelCentreOffset.x, tireForceOffset.y, wheelCentreOffset.z));
+	}
+
+	const PxVec3& frontLeft = wheelActorOffsets[PxVehicleDrive4WWheelOrder::eFRONT_LEFT];
+	const PxVec3& frontRight = wheelActorOffsets[PxVehicleDrive4WWheelOrder::eFRONT_RIGHT];
+	const PxVec3& rearLeft = wheelActorOffsets[PxVehicleDrive4WWheelOrder::eREAR_LEFT];
+	const PxVec3& rearRight = wheelActorOffsets[PxVehicleDrive4WWheelOrder::eREAR_RIGHT];
+
+	PxVehicleAckermannGeometryData ackermann = m_driveSimData.getAckermannGeometryData();
+	ackermann.mFrontWidth = frontRight.x - frontLeft.x;
+	ackermann.mRearWidth = rearRight.x - rearLeft.x;
+	ackermann.mAxleSeparation = frontLeft.z - rearLeft.z;
+	m_driveSimData.setAckermannGeometryData(ackermann);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC VehicleDesc VehicleArchetype::MakeVehicleDesc(const VehicleDescriptor& descriptor)
+{
+	const PxF32 chassisMass = descriptor.m_chassisMass;
+	const PxVec3 chassisDims(descriptor.m_chassisWidth, descriptor.m_chassisHeight, descriptor.m_chassisLength);
+	const PxVec3 chassisMOI
+	((chassisDims.y * chassisDims.y + chassisDims.z * chassisDims.z) * chassisMass / 12.0f,
+		(chassisDims.x * chassisDims.x + chassisDims.z * chassisDims.z) * 0.8f * chassisMass / 12.0f,
+		(chassisDims.x * chassisDims.x + chassisDims.y * chassisDims.y) * chassisMass / 12.0f);
+	const PxVec3 chassisCMOffset(0.0f, descriptor.m_centerOfMassHeight, descriptor.m_centerOfMassForward);
+
+	const PxF32 wheelMass = descriptor.m_wheelMass;
+	const PxF32 wheelRadius = descriptor.m_wheelRadius;
+	const PxF32 wheelWidth = descriptor.m_wheelWidth;
+	const PxF32 wheelMOI = 0.5f * wheelMass * wheelRadius * wheelRadius;
+	const PxU32 nbWheels = 4;
+
+	PxMaterial* material = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	VehicleDesc vehicleDesc;
+
+	vehicleDesc.chassisMass = chassisMass;
+	vehicleDesc.chassisDims = chassisDims;
+	vehicleDesc.chassisMOI = chassisMOI;
+	vehicleDesc.chassisCMOffset = chassisCMOffset;
+	vehicleDesc.chassisMaterial = material;
+	vehicleDesc.chassisSimFilterData = PxFilterData(COLLISION_FLAG_CHASSIS, COLLISION_FLAG_CHASSIS_AGAINST, 0, 0);
+
+	vehicleDesc.wheelMass = wheelMass;
+	vehicleDesc.wheelRadius = wheelRadius;
+	vehicleDesc.wheelWidth = wheelWidth;
+	vehicleDesc.wheelMOI = wheelMOI;
+	vehicleDesc.numWheels = nbWheels;
+	vehicleDesc.wheelMaterial = material;
+	vehicleDesc.wheelSimFilterData = PxFilterData(COLLISION_FLAG_WHEEL, COLLISION_FLAG_WHEEL_AGAINST, 0, 0);
+
+	return vehicleDesc;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleArchetypeRegistry::VehicleArchetypeRegistry()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleArchetypeRegistry::~VehicleArchetypeRegistry()
+{
+	ReleaseArchetypes();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleArchetype& VehicleArchetypeRegistry::FindOrCreateArchetype(const VehicleDescriptor& descriptor)
+{
+	for (int archetypeIndex = 0; archetypeIndex < (int)m_archetypes.size(); ++archetypeIndex)
+	{
+		if (m_archetypes[archetypeIndex]->GetDescriptor().IsSameModel(descriptor))
+		{
+			return *m_archetypes[archetypeIndex];
+		}
+	}
+
+	if (m_simTemplate.m_wheelsSimData == nullptr)
+	{
+		CreateSimTemplate(descriptor);
+	}
+
+	const VehicleShapeMeshes& shapeMeshes = FindOrCreateShapeMeshes(VehicleArchetype::MakeVehicleDesc(descriptor));
+	VehicleArchetype* archetype = new VehicleArchetype(descriptor, m_simTemplate, shapeMeshes);
+	m_archetypes.push_back(archetype);
+	return *archetype;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleArchetypeRegistry::ReleaseArchetypes()
+{
+	for (int archetypeIndex = 0; archetypeIndex < (int)m_archetypes.size(); ++archetypeIndex)
+	{
+		delete m_archetypes[archetypeIndex];
+	}
+	m_archetypes.clear();
+
+	for (int meshIndex = 0; meshIndex < (int)m_shapeMeshes.size(); ++meshIndex)
+	{
+		PX_RELEASE(m_shapeMeshes[meshIndex].m_wheelMesh);
+		PX_RELEASE(m_shapeMeshes[meshIndex].m_chassisMesh);
+	}
+	m_shapeMeshes.clear();
+
+	if (m_simTemplate.m_wheelsSimData != nullptr)
+	{
+		m_simTemplate.m_wheelsSimData->free();
+		m_simTemplate.m_wheelsSimData = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleArchetypeRegistry::CreateSimTemplate(const VehicleDescriptor& descriptor)
+{
+	//The vehicle SDK start up code lays out and tunes a whole car, so build one the normal way and keep its sim data. Its
+	//meshes become the first shape meshes, the only ones cooked outside the convex cache
+	PxPhysics& physX = *g_PxPhysXSystem->GetPhysXSDK();
+	m_simTemplate.m_vehicleDesc = VehicleArchetype::MakeVehicleDesc(descriptor);
+	PxVehicleDrive4W* prototype = createVehicle4W(m_simTemplate.m_vehicleDesc, &physX, g_PxPhysXSystem->GetPhysXCookingModule());
+
+	PxRigidDynamic* prototypeActor = prototype->getRigidDynamicActor();
+	PxU32 numWheels = prototype->mWheelsSimData.getNbWheels();
+
+	//createVehicleActor adds the wheel shapes first, then the chassis
+	PxShape* shapes[PX_MAX_NB_WHEELS + 1];
+	prototypeActor->getShapes(shapes, numWheels + 1);
+
+	VehicleShapeMeshes shapeMeshes;
+	shapeMeshes.m_chassisDims = m_simTemplate.m_vehicleDesc.chassisDims;
+	shapeMeshes.m_wheelRadius = m_simTemplate.m_vehicleDesc.wheelRadius;
+	shapeMeshes.m_wheelWidth = m_simTemplate.m_vehicleDesc.wheelWidth;
+
+	PxConvexMeshGeometry convexGeometry;
+	shapes[0]->getConvexMeshGeometry(convexGeometry);
+	shapeMeshes.m_wheelMesh = convexGeometry.convexMesh;
+	shapeMeshes.m_wheelMesh->acquireReference();
+
+	shapes[numWheels]->getConvexMeshGeometry(convexGeometry);
+	shapeMeshes.m_chassisMesh = convexGeometry.convexMesh;
+	shapeMeshes.m_chassisMesh->acquireReference();
+	m_shapeMeshes.push_back(shapeMeshes);
+
+	m_simTemplate.m_wheelsSimData = PxVehicleWheelsSimData::allocate(numWheels);
+	*m_simTemplate.m_wheelsSimData = prototype->mWheelsSimData;
+	m_simTemplate.m_driveSimData = prototype->mDriveSimData;
+
+	prototypeActor->release();
+	prototype->free();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const VehicleShapeMeshes& VehicleArchetypeRegistry::FindOrCreateShapeMeshes(const VehicleDesc& vehicleDesc)
+{
+	for (int meshIndex = 0; meshIndex < (int)m_shapeMeshes.size(); ++meshIndex)
+	{
+		const VehicleShapeMeshes& shapeMeshes = m_shapeMeshes[meshIndex];
+		if (shapeMeshes.m_chassisDims == vehicleDesc.chassisDims && shapeMeshes.m_wheelRadius == vehicleDesc.wheelRadius &&
+			shapeMeshes.m_wheelWidth == vehicleDesc.wheelWidth)
+		{
+			return shapeMeshes;
+		}
+	}
+
+	PxPhysics& physX = *g_PxPhysXSystem->GetPhysXSDK();
+	PxCooking& pxCooking = *g_PxPhysXSystem->GetPhysXCookingModule();
+
+	VehicleShapeMeshes shapeMeshes;
+	shapeMeshes.m_chassisDims = vehicleDesc.chassisDims;
+	shapeMeshes.m_wheelRadius = vehicleDesc.wheelRadius;
+	shapeMeshes.m_wheelWidth = vehicleDesc.wheelWidth;
+
+	//Same hulls the SDK start up cooks: a 16 sided cylinder on the x axis and the chassis box
+	PxVec3 wheelPoints[2 * gVehicleWheelMeshSides];
+	for (int sideIndex = 0; sideIndex < gVehicleWheelMeshSides; ++sideIndex)
+	{
+		float angle = (float)sideIndex * 2.f * PxPi / (float)gVehicleWheelMeshSides;
+		float y = vehicleDesc.wheelRadius * PxCos(angle);
+		float z = vehicleDesc.wheelRadius * PxSin(angle);
+		wheelPoints[2 * sideIndex + 0] = PxVec3(-0.5f * vehicleDesc.wheelWidth, y, z);
+		wheelPoints[2 * sideIndex + 1] = PxVec3(0.5f * vehicleDesc.wheelWidth, y, z);
+	}
+	shapeMeshes.m_wheelMesh = m_cookedConvexCache.CreateConvexMesh(wheelPoints, 2 * gVehicleWheelMeshSides, gVehicleMeshVertexLimit, physX, pxCooking);
+
+	PxVec3 halfDims = 0.5f * vehicleDesc.chassisDims;
+	PxVec3 chassisPoints[8];
+	for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+	{
+		chassisPoints[cornerIndex] = PxVec3((cornerIndex & 1) ? halfDims.x : -halfDims.x, (cornerIndex & 2) ? halfDims.y : -halfDims.y,
+			(cornerIndex & 4) ? halfDims.z : -halfDims.z);
+	}
+	shapeMeshes.m_chassisMesh = m_cookedConvexCache.CreateConvexMesh(chassisPoints, 8, gVehicleMeshVertexLimit, physX, pxCooking);
+
+	m_shapeMeshes.push_back(shapeMeshes);
+	return m_shapeMeshes.back();
+}
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include "Game/PhysXCookedConvexCache.hpp"
+#include "Game/VehicleDescriptor.hpp"
+//Standard
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Wheel and chassis convex meshes for one set of body dimensions. Handling changes never touch these, so every model with
+// the same chassis box and wheel size shares one set
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleShapeMeshes
+{
+	PxVec3								m_chassisDims = PxVec3(0.f, 0.f, 0.f);
+	float								m_wheelRadius = 0.f;
+	float								m_wheelWidth = 0.f;
+
+	PxConvexMesh*						m_wheelMesh = nullptr;
+	PxConvexMesh*						m_chassisMesh = nullptr;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The wheel and drive sim data of the car the vehicle SDK start up builds, the tuning every archetype starts from
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleSimTemplate
+{
+	VehicleDesc							m_vehicleDesc;
+	PxVehicleWheelsSimData*				m_wheelsSimData = nullptr;
+	PxVehicleDriveSimData4W				m_driveSimData;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One car model, built once from a VehicleDescriptor: the rigid body data, the wheel, suspension, tire and drive sim data
+// and the input smoothing tables, plus a reference on the shared meshes for its body. The sim data is the template's,
+// moved to this model's body and masses, with the descriptor's tuning on top. The vehicle SDK copies the sim data into each
+// vehicle's own block when it is set up, so per car that copy, the actor with its shapes and the dynamic state are all that
+// get allocated. Nothing is cooked per model or per car
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleArchetype
+{
+public:
+	VehicleArchetype(const VehicleDescriptor& descriptor, const VehicleSimTemplate& simTemplate, const VehicleShapeMeshes& shapeMeshes);
+	~VehicleArchetype();
+
+	//Not added to any scene. Release it the usual way, actor first and then the vehicle
+	PxVehicleDrive4W*					CreateVehicle(PxPhysics& physX);
+
+	const VehicleDescriptor&			GetDescriptor() const { return m_descriptor; }
+	const PxFixedSizeLookupTable<MAX_STEER_VS_SPEED_POINTS>&	GetSteerVsForwardSpeedTable() const { return m_steerVsForwardSpeedTable; }
+	const PxVehiclePadSmoothingData&	GetPadSmoothingData() const { return m_padSmoothingData; }
+
+	int									GetNumInstancesCreated() const { return m_numInstancesCreated; }
+	double								GetBuildSeconds() const { return m_buildSeconds; }
+
+	static VehicleDesc					MakeVehicleDesc(const VehicleDescriptor& descriptor);
+
+private:
+	void								FitSimDataToBody(const VehicleDesc& templateDesc);
+
+private:
+	VehicleDescriptor					m_descriptor;
+	VehicleDesc							m_vehicleDesc;
+	PxVehicleChassisData				m_chassisData;
+
+	//A reference of our own on each, shapes of live instances keep theirs
+	PxConvexMesh*						m_wheelMesh = nullptr;
+	PxConvexMesh*						m_chassisMesh = nullptr;
+
+	PxVehicleWheelsSimData*				m_wheelsSimData = nullptr;
+	PxVehicleDriveSimData4W				m_driveSimData;
+
+	PxFixedSizeLookupTable<MAX_STEER_VS_SPEED_POINTS>	m_steerVsForwardSpeedTable;
+	PxVehiclePadSmoothingData			m_padSmoothingData;
+
+	int									m_numInstancesCreated = 0;
+	double								m_buildSeconds = 0.0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Archetypes keyed by descriptor, so every car built from the same descriptor is an instance of one model. Archetypes live
+// until ReleaseArchetypes and never move, vehicles may keep pointers to them. The sim template is built with the first
+// archetype and shape meshes are cooked through the convex cache the first time a body size is asked for, so a sweep over
+// handling parameters builds one vehicle through the SDK start up and cooks nothing more. Not thread safe, spawn from one thread
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleArchetypeRegistry
+{
+public:
+	VehicleArchetypeRegistry();
+	~VehicleArchetypeRegistry();
+
+	VehicleArchetype&					FindOrCreateArchetype(const VehicleDescriptor& descriptor);
+	//Only once every vehicle pointing at them is gone, the PhysX SDK has to still be up
+	void								ReleaseArchetypes();
+
+	int									GetNumArchetypes() const { return (int)m_archetypes.size(); }
+	const VehicleArchetype&				GetArchetype(int archetypeIndex) const { return *m_archetypes[archetypeIndex]; }
+	int									GetNumShapeMeshes() const { return (int)m_shapeMeshes.size(); }
+
+private:
+	void								CreateSimTemplate(const VehicleDescriptor& descriptor);
+	const VehicleShapeMeshes&			FindOrCreateShapeMeshes(const VehicleDesc& vehicleDesc);
+
+private:
+	std::vector<VehicleArchetype*>		m_archetypes;
+
+	VehicleSimTemplate					m_simTemplate;
+	std::vector<VehicleShapeMeshes>		m_shapeMeshes;
+	//Wheel and chassis streams under Run/Data/Cache, next to the game's own
+	PhysXCookedConvexCache				m_cookedConvexCache{ "Data/Cache/" };
+};
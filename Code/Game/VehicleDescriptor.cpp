@@ -0,0 +1,287 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/VehicleDescriptor.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/XMLUtils/XMLUtils.hpp"
+//Standard
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleDescriptorParameter
+{
+	const char*							m_element;
+	const char*							m_attribute;
+	float VehicleDescriptor::*			m_member;
+};
+
+//The XML layout and the parameter names both come from this table
+const VehicleDescriptorParameter gVehicleDescriptorParameters[] =
+{
+	{ "Chassis",		"mass",					&VehicleDescriptor::m_chassisMass },
+	{ "Chassis",		"width",				&VehicleDescriptor::m_chassisWidth },
+	{ "Chassis",		"height",				&VehicleDescriptor::m_chassisHeight },
+	{ "Chassis",		"length",				&VehicleDescriptor::m_chassisLength },
+	{ "Chassis",		"centerOfMassHeight",	&VehicleDescriptor::m_centerOfMassHeight },
+	{ "Chassis",		"centerOfMassForward",	&VehicleDescriptor::m_centerOfMassForward },
+
+	{ "Wheels",			"mass",					&VehicleDescriptor::m_wheelMass },
+	{ "Wheels",			"radius",				&VehicleDescriptor::m_wheelRadius },
+	{ "Wheels",			"width",				&VehicleDescriptor::m_wheelWidth },
+	{ "Wheels",			"maxSteerDegrees",		&VehicleDescriptor::m_maxSteerDegrees },
+	{ "Wheels",			"maxBrakeTorque",		&VehicleDescriptor::m_maxBrakeTorque },
+	{ "Wheels",			"maxHandbrakeTorque",	&VehicleDescriptor::m_maxHandbrakeTorque },
+
+	{ "Suspension",		"springStrength",		&VehicleDescriptor::m_springStrength },
+	{ "Suspension",		"damperRate",			&VehicleDescriptor::m_springDamperRate },
+	{ "Suspension",		"maxCompression",		&VehicleDescriptor::m_maxCompression },
+	{ "Suspension",		"maxDroop",				&VehicleDescriptor::m_maxDroop },
+
+	{ "Tires",			"latStiffX",			&VehicleDescriptor::m_tireLatStiffX },
+	{ "Tires",			"latStiffY",			&VehicleDescriptor::m_tireLatStiffY },
+	{ "Tires",			"longitudinalStiffness",	&VehicleDescriptor::m_tireLongitudinalStiffness },
+
+	{ "Engine",			"peakTorque",			&VehicleDescriptor::m_enginePeakTorque },
+	{ "Engine",			"maxOmega",				&VehicleDescriptor::m_engineMaxOmega },
+	{ "Gears",			"switchTime",			&VehicleDescriptor::m_gearSwitchTime },
+	{ "Gears",			"finalRatio",			&VehicleDescriptor::m_gearFinalRatio },
+	{ "Clutch",			"strength",				&VehicleDescriptor::m_clutchStrength },
+
+	{ "PadSmoothing",	"accelRise",			&VehicleDescriptor::m_accelRiseRate },
+	{ "PadSmoothing",	"brakeRise",			&VehicleDescriptor::m_brakeRiseRate },
+	{ "PadSmoothing",	"handbrakeRise",		&VehicleDescriptor::m_handbrakeRiseRate },
+	{ "PadSmoothing",	"steerRise",			&VehicleDescriptor::m_steerRiseRate },
+	{ "PadSmoothing",	"accelFall",			&VehicleDescriptor::m_accelFallRate },
+	{ "PadSmoothing",	"brakeFall",			&VehicleDescriptor::m_brakeFallRate },
+	{ "PadSmoothing",	"handbrakeFall",		&VehicleDescriptor::m_handbrakeFallRate },
+	{ "PadSmoothing",	"steerFall",			&VehicleDescriptor::m_steerFallRate },
+};
+const int gNumVehicleDescriptorParameters = sizeof(gVehicleDescriptorParameters) / sizeof(gVehicleDescriptorParameters[0]);
+
+//------------------------------------------------------------------------------------------------------------------------------
+const char* gDifferentialTypeNames[PxVehicleDifferential4WData::eMAX_NB_DIFF_TYPES] =
+{
+	"LS_4WD",
+	"LS_FRONTWD",
+	"LS_REARWD",
+	"OPEN_4WD",
+	"OPEN_FRONTWD",
+	"OPEN_REARWD"
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleDescriptor::LoadFromXml(const std::string& filePath)
+{
+	tinyxml2::XMLDocument document;
+	if (document.LoadFile(filePath.c_str()) != tinyxml2::XML_SUCCESS)
+	{
+		return false;
+	}
+
+	const tinyxml2::XMLElement* rootElement = document.RootElement();
+	if (rootElement == nullptr || strcmp(rootElement->Name(), "VehicleDescriptor") != 0)
+	{
+		return false;
+	}
+
+	//Anything left out of the file keeps its default
+	for (int parameterIndex = 0; parameterIndex < gNumVehicleDescriptorParameters; ++parameterIndex)
+	{
+		const VehicleDescriptorParameter& parameter = gVehicleDescriptorParameters[parameterIndex];
+		const tinyxml2::XMLElement* element = rootElement->FirstChildElement(parameter.m_element);
+		if (element != nullptr)
+		{
+			element->QueryFloatAttribute(parameter.m_attribute, &(this->*parameter.m_member));
+		}
+	}
+
+	const tinyxml2::XMLElement* differentialElement = rootElement->FirstChildElement("Differential");
+	const char* differentialName = differentialElement != nullptr ? differentialElement->Attribute("type") : nullptr;
+	if (differentialName != nullptr)
+	{
+		for (int typeIndex = 0; typeIndex < PxVehicleDifferential4WData::eMAX_NB_DIFF_TYPES; ++typeIndex)
+		{
+			if (strcmp(differentialName, gDifferentialTypeNames[typeIndex]) == 0)
+			{
+				m_differentialType = typeIndex;
+			}
+		}
+	}
+
+	const tinyxml2::XMLElement* steerElement = rootElement->FirstChildElement("SteerVsSpeed");
+	if (steerElement != nullptr)
+	{
+		m_numSteerVsForwardSpeedPoints = 0;
+		const tinyxml2::XMLElement* pointElement = steerElement->FirstChildElement("Point");
+		while (pointElement != nullptr && m_numSteerVsForwardSpeedPoints < MAX_STEER_VS_SPEED_POINTS)
+		{
+			float* point = &m_steerVsForwardSpeed[m_numSteerVsForwardSpeedPoints * 2];
+			pointElement->QueryFloatAttribute("speed", &point[0]);
+			pointElement->QueryFloatAttribute("steer", &point[1]);
+			m_numSteerVsForwardSpeedPoints++;
+
+			pointElement = pointElement->NextSiblingElement("Point");
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleDescriptor::SaveToXml(const std::string& filePath) const
+{
+	tinyxml2::XMLDocument document;
+	tinyxml2::XMLElement* rootElement = document.NewElement("VehicleDescriptor");
+	document.InsertEndChild(rootElement);
+
+	//The table is grouped by element, so a new element starts whenever the name changes
+	tinyxml2::XMLElement* element = nullptr;
+	for (int parameterIndex = 0; parameterIndex < gNumVehicleDescriptorParameters; ++parameterIndex)
+	{
+		const VehicleDescriptorParameter& parameter = gVehicleDescriptorParameters[parameterIndex];
+		if (element == nullptr || strcmp(element->Name(), parameter.m_element) != 0)
+		{
+			element = document.NewElement(parameter.m_element);
+			rootElement->InsertEndChild(element);
+		}
+
+		element->SetAttribute(parameter.m_attribute, this->*parameter.m_member);
+	}
+
+	tinyxml2::XMLElement* differentialElement = document.NewElement("Differential");
+	differentialElement->SetAttribute("type", gDifferentialTypeNames[m_differentialType]);
+	rootElement->InsertEndChild(differentialElement);
+
+	tinyxml2::XMLElement* steerElement = document.NewElement("SteerVsSpeed");
+	rootElement->InsertEndChild(steerElement);
+	for (int pointIndex = 0; pointIndex < m_numSteerVsForwardSpeedPoints; ++pointIndex)
+	{
+		tinyxml2::XMLElement* pointElement = document.NewElement("Point");
+		pointElement->SetAttribute("speed", m_steerVsForwardSpeed[pointIndex * 2]);
+		pointElement->SetAttribute("steer", m_steerVsForwardSpeed[pointIndex * 2 + 1]);
+		steerElement->InsertEndChild(pointElement);
+	}
+
+	return document.SaveFile(filePath.c_str()) == tinyxml2::XML_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float* VehicleDescriptor::FindParameter(const std::string& name)
+{
+	return const_cast<float*>(static_cast<const VehicleDescriptor*>(this)->FindParameter(name));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const float* VehicleDescriptor::FindParameter(const std::string& name) const
+{
+	for (int parameterIndex = 0; parameterIndex < gNumVehicleDescriptorParameters; ++parameterIndex)
+	{
+		const VehicleDescriptorParameter& parameter = gVehicleDescriptorParameters[parameterIndex];
+		if (name == std::string(parameter.m_element) + "." + parameter.m_attribute)
+		{
+			return &(this->*parameter.m_member);
+		}
+	}
+
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleDescriptor::IsSameModel(const VehicleDescriptor& other) const
+{
+	for (int parameterIndex = 0; parameterIndex < gNumVehicleDescriptorParameters; ++parameterIndex)
+	{
+		float VehicleDescriptor::* member = gVehicleDescriptorParameters[parameterIndex].m_member;
+		if (this->*member != other.*member)
+		{
+			return false;
+		}
+	}
+
+	if (m_differentialType != other.m_differentialType || m_numSteerVsForwardSpeedPoints != other.m_numSteerVsForwardSpeedPoints)
+	{
+		return false;
+	}
+
+	for (int valueIndex = 0; valueIndex < 2 * m_numSteerVsForwardSpeedPoints; ++valueIndex)
+	{
+		if (m_steerVsForwardSpeed[valueIndex] != other.m_steerVsForwardSpeed[valueIndex])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleDescriptor::ApplyToVehicle(PxVehicleDrive4W& vehicle) const
+{
+	ApplyToSimData(vehicle.mWheelsSimData, vehicle.mDriveSimData);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleDescriptor::ApplyToSimData(PxVehicleWheelsSimData& wheelsSimData, PxVehicleDriveSimData4W& driveSimData) const
+{
+	PxVehicleEngineData engine = driveSimData.getEngineData();
+	engine.mPeakTorque = m_enginePeakTorque;
+	engine.mMaxOmega = m_engineMaxOmega;
+	driveSimData.setEngineData(engine);
+
+	PxVehicleGearsData gears = driveSimData.getGearsData();
+	gears.mSwitchTime = m_gearSwitchTime;
+	gears.mFinalRatio = m_gearFinalRatio;
+	driveSimData.setGearsData(gears);
+
+	PxVehicleClutchData clutch = driveSimData.getClutchData();
+	clutch.mStrength = m_clutchStrength;
+	driveSimData.setClutchData(clutch);
+
+	PxVehicleDifferential4WData differential = driveSimData.getDiffData();
+	differential.mType = (PxVehicleDifferential4WData::Enum)m_differentialType;
+	driveSimData.setDiffData(differential);
+
+	for (PxU32 wheelIndex = 0; wheelIndex < wheelsSimData.getNbWheels(); ++wheelIndex)
+	{
+		//Front wheels steer, rear wheels take the handbrake
+		bool isFrontWheel = wheelIndex == PxVehicleDrive4WWheelOrder::eFRONT_LEFT || wheelIndex == PxVehicleDrive4WWheelOrder::eFRONT_RIGHT;
+		bool isRearWheel = wheelIndex == PxVehicleDrive4WWheelOrder::eREAR_LEFT || wheelIndex == PxVehicleDrive4WWheelOrder::eREAR_RIGHT;
+
+		PxVehicleWheelData wheel = wheelsSimData.getWheelData(wheelIndex);
+		wheel.mMaxBrakeTorque = m_maxBrakeTorque;
+		wheel.mMaxSteer = isFrontWheel ? m_maxSteerDegrees * PxPi / 180.f : 0.f;
+		wheel.mMaxHandBrakeTorque = isRearWheel ? m_maxHandbrakeTorque : 0.f;
+		wheelsSimData.setWheelData(wheelIndex, wheel);
+
+		PxVehicleSuspensionData suspension = wheelsSimData.getSuspensionData(wheelIndex);
+		suspension.mSpringStrength = m_springStrength;
+		suspension.mSpringDamperRate = m_springDamperRate;
+		suspension.mMaxCompression = m_maxCompression;
+		suspension.mMaxDroop = m_maxDroop;
+		wheelsSimData.setSuspensionData(wheelIndex, suspension);
+
+		PxVehicleTireData tire = wheelsSimData.getTireData(wheelIndex);
+		tire.mLatStiffX = m_tireLatStiffX;
+		tire.mLatStiffY = m_tireLatStiffY;
+		tire.mLongitudinalStiffnessPerUnitGravity = m_tireLongitudinalStiffness;
+		wheelsSimData.setTireData(wheelIndex, tire);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxFixedSizeLookupTable<MAX_STEER_VS_SPEED_POINTS> VehicleDescriptor::MakeSteerVsForwardSpeedTable() const
+{
+	return PxFixedSizeLookupTable<MAX_STEER_VS_SPEED_POINTS>(m_steerVsForwardSpeed, (PxU32)m_numSteerVsForwardSpeedPoints);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxVehiclePadSmoothingData VehicleDescriptor::MakePadSmoothingData() const
+{
+	PxVehiclePadSmoothingData padSmoothing =
+	{
+		{ m_accelRiseRate, m_brakeRiseRate, m_handbrakeRiseRate, m_steerRiseRate, m_steerRiseRate },
+		{ m_accelFallRate, m_brakeFallRate, m_handbrakeFallRate, m_steerFallRate, m_steerFallRate }
+	};
+	return padSmoothing;
+}
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+#include "ThirdParty/PhysX/include/vehicle/PxVehicleUtil.h"
+//Standard
+#include <string>
+
+using namespace physx;
+
+//Points the steer vs forward speed table can hold, the size of PxFixedSizeLookupTable the vehicle SDK takes
+constexpr int MAX_STEER_VS_SPEED_POINTS = 8;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Everything that makes one car handle the way it does, loaded from a Data/Gameplay vehicle XML instead of compiled in.
+// Every float can be looked up by "Element.attribute", the same name it has in the XML, which is what parameter sweeps use.
+// Defaults are the car the vehicle SDK start up builds
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleDescriptor
+{
+	//Chassis, only used when a vehicle is created
+	float								m_chassisMass = 1500.f;
+	float								m_chassisWidth = 2.5f;
+	float								m_chassisHeight = 2.f;
+	float								m_chassisLength = 5.f;
+	//Relative to the middle of the chassis box
+	float								m_centerOfMassHeight = -0.35f;
+	float								m_centerOfMassForward = 0.25f;
+
+	//Wheels, mass, radius and width are only used when a vehicle is created
+	float								m_wheelMass = 20.f;
+	float								m_wheelRadius = 0.5f;
+	float								m_wheelWidth = 0.4f;
+	float								m_maxSteerDegrees = 60.f;
+	float								m_maxBrakeTorque = 1500.f;
+	float								m_maxHandbrakeTorque = 4000.f;
+
+	float								m_springStrength = 35000.f;
+	float								m_springDamperRate = 4500.f;
+	float								m_maxCompression = 0.3f;
+	float								m_maxDroop = 0.1f;
+
+	float								m_tireLatStiffX = 2.f;
+	float								m_tireLatStiffY = 17.9049f;
+	float								m_tireLongitudinalStiffness = 1000.f;
+
+	float								m_enginePeakTorque = 500.f;
+	float								m_engineMaxOmega = 600.f;
+	float								m_gearSwitchTime = 0.5f;
+	float								m_gearFinalRatio = 4.f;
+	float								m_clutchStrength = 10.f;
+	int									m_differentialType = PxVehicleDifferential4WData::eDIFF_TYPE_LS_4WD;
+
+	//Analog input smoothing, steer is shared between left and right
+	float								m_accelRiseRate = 6.f;
+	float								m_brakeRiseRate = 6.f;
+	float								m_handbrakeRiseRate = 6.f;
+	float								m_steerRiseRate = 2.5f;
+	float								m_accelFallRate = 10.f;
+	float								m_brakeFallRate = 10.f;
+	float								m_handbrakeFallRate = 10.f;
+	float								m_steerFallRate = 5.f;
+
+	//Forward speed, steer scale pairs
+	float								m_steerVsForwardSpeed[2 * MAX_STEER_VS_SPEED_POINTS] =
+	{
+		0.0f,		0.75f,
+		5.0f,		0.75f,
+		30.0f,		0.125f,
+		120.0f,		0.1f,
+	};
+	int									m_numSteerVsForwardSpeedPoints = 4;
+
+	bool								LoadFromXml(const std::string& filePath);
+	bool								SaveToXml(const std::string& filePath) const;
+
+	//"Engine.peakTorque" style names, nullptr if there is no such parameter
+	float*								FindParameter(const std::string& name);
+	const float*						FindParameter(const std::string& name) const;
+	//Every parameter, the differential and the steer table match, so both build the same VehicleArchetype
+	bool								IsSameModel(const VehicleDescriptor& other) const;
+
+	//Drive, wheel, suspension and tire data. The chassis and wheel shapes are left alone, they need the vehicle created again
+	void								ApplyToVehicle(PxVehicleDrive4W& vehicle) const;
+	void								ApplyToSimData(PxVehicleWheelsSimData& wheelsSimData, PxVehicleDriveSimData4W& driveSimData) const;
+	PxFixedSizeLookupTable<MAX_STEER_VS_SPEED_POINTS>	MakeSteerVsForwardSpeedTable() const;
+	PxVehiclePadSmoothingData			MakePadSmoothingData() const;
+};
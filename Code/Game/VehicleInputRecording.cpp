@@ -0,0 +1,297 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/VehicleInputRecording.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Standard
+#include <fstream>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Bump the version whenever RecordedVehicleInput, the header or the state hash changes
+const PxU32 gInputRecordingMagic = 0x52495850;	//"PXIR"
+const PxU32 gInputRecordingVersion = 1;
+
+//Ten minutes at 60Hz, so recording a normal session never reallocates mid step
+const int gInputRecordingReserveSteps = 36000;
+
+//Step sizes come from the same config value, anything past float noise is a different step
+const float gStepSecondsTolerance = 1e-6f;
+
+//Actor poses are read in batches of this many, which keeps the hash off the heap
+const PxU32 gStateHashActorBatch = 64;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eRecordedDigitalInput
+{
+	RECORDED_DIGITAL_ACCEL = 1 << 0,
+	RECORDED_DIGITAL_BRAKE = 1 << 1,
+	RECORDED_DIGITAL_HANDBRAKE = 1 << 2,
+	RECORDED_DIGITAL_STEER_LEFT = 1 << 3,
+	RECORDED_DIGITAL_STEER_RIGHT = 1 << 4,
+	RECORDED_GEAR_UP = 1 << 5,
+	RECORDED_GEAR_DOWN = 1 << 6
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct InputRecordingHeader
+{
+	PxU32								m_magic = gInputRecordingMagic;
+	PxU32								m_version = gInputRecordingVersion;
+	PxU32								m_physXVersion = PX_PHYSICS_VERSION;
+	PxU32								m_sceneFlags = 0;
+	PxU32								m_numVehicles = 0;
+	PxU32								m_isDigitalInput = 0;
+	PxU32								m_numSteps = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// 64 bit FNV-1a, the same on every build and platform so hashes can be compared across them
+//------------------------------------------------------------------------------------------------------------------------------
+static void HashBytes(PxU64& hash, const void* data, size_t numBytes)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t byteIndex = 0; byteIndex < numBytes; ++byteIndex)
+	{
+		hash ^= bytes[byteIndex];
+		hash *= 1099511628211ULL;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleInputRecording::VehicleInputRecording()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleInputRecording::~VehicleInputRecording()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxU64 VehicleInputRecording::ComputeStateHash(const PxScene& scene, const PxVehicleDrive4W& playerVehicle)
+{
+	PxU64 hash = 14695981039346656037ULL;
+
+	//Bitwise, a determinism break shows up even when it is far below anything visible
+	const PxRigidDynamic* chassis = playerVehicle.getRigidDynamicActor();
+	PxTransform chassisPose = chassis->getGlobalPose();
+	PxVec3 linearVelocity = chassis->getLinearVelocity();
+	PxVec3 angularVelocity = chassis->getAngularVelocity();
+	HashBytes(hash, &chassisPose, sizeof(chassisPose));
+	HashBytes(hash, &linearVelocity, sizeof(linearVelocity));
+	HashBytes(hash, &angularVelocity, sizeof(angularVelocity));
+
+	PxReal engineSpeed = playerVehicle.mDriveDynData.getEngineRotationSpeed();
+	PxU32 currentGear = playerVehicle.mDriveDynData.getCurrentGear();
+	HashBytes(hash, &engineSpeed, sizeof(engineSpeed));
+	HashBytes(hash, &currentGear, sizeof(currentGear));
+
+	PxU32 numWheels = playerVehicle.mWheelsSimData.getNbWheels();
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; ++wheelIndex)
+	{
+		PxReal wheelSpeed = playerVehicle.mWheelsDynData.getWheelRotationSpeed(wheelIndex);
+		HashBytes(hash, &wheelSpeed, sizeof(wheelSpeed));
+	}
+
+	//Then every dynamic in scene order, which only depends on the order the actors were added in
+	PxActor* actors[gStateHashActorBatch];
+	PxU32 numActors = scene.getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC);
+	for (PxU32 startIndex = 0; startIndex < numActors; startIndex += gStateHashActorBatch)
+	{
+		PxU32 numInBatch = scene.getActors(PxActorTypeFlag::eRIGID_DYNAMIC, actors, gStateHashActorBatch, startIndex);
+		for (PxU32 actorIndex = 0; actorIndex < numInBatch; ++actorIndex)
+		{
+			PxTransform pose = static_cast<PxRigidDynamic*>(actors[actorIndex])->getGlobalPose();
+			HashBytes(hash, &pose, sizeof(pose));
+		}
+	}
+
+	return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleInputRecording::BeginRecording(PxU32 sceneFlags, int numVehicles, bool isDigitalInput)
+{
+	m_mode = VEHICLE_INPUT_RECORDING;
+	m_steps.clear();
+	m_steps.reserve(gInputRecordingReserveSteps);
+
+	m_sceneFlags = sceneFlags;
+	m_numVehicles = numVehicles;
+	m_isDigitalInput = isDigitalInput;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleInputRecording::RecordInput(const PxVehicleDrive4WRawInputData& inputData, int forcedGear, float stepSeconds)
+{
+	if (m_mode != VEHICLE_INPUT_RECORDING)
+	{
+		return;
+	}
+
+	RecordedVehicleInput step;
+	step.m_stepSeconds = stepSeconds;
+	step.m_analogAccel = inputData.getAnalogAccel();
+	step.m_analogBrake = inputData.getAnalogBrake();
+	step.m_analogHandbrake = inputData.getAnalogHandbrake();
+	step.m_analogSteer = inputData.getAnalogSteer();
+	step.m_forcedGear = (PxI8)forcedGear;
+
+	step.m_digitalFlags |= inputData.getDigitalAccel() ? RECORDED_DIGITAL_ACCEL : 0;
+	step.m_digitalFlags |= inputData.getDigitalBrake() ? RECORDED_DIGITAL_BRAKE : 0;
+	step.m_digitalFlags |= inputData.getDigitalHandbrake() ? RECORDED_DIGITAL_HANDBRAKE : 0;
+	step.m_digitalFlags |= inputData.getDigitalSteerLeft() ? RECORDED_DIGITAL_STEER_LEFT : 0;
+	step.m_digitalFlags |= inputData.getDigitalSteerRight() ? RECORDED_DIGITAL_STEER_RIGHT : 0;
+	step.m_digitalFlags |= inputData.getGearUp() ? RECORDED_GEAR_UP : 0;
+	step.m_digitalFlags |= inputData.getGearDown() ? RECORDED_GEAR_DOWN : 0;
+
+	m_steps.push_back(step);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleInputRecording::RecordStateHash(PxU64 stateHash)
+{
+	if (m_mode != VEHICLE_INPUT_RECORDING || m_steps.empty())
+	{
+		return;
+	}
+
+	m_steps.back().m_stateHash = stateHash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleInputRecording::EndRecording(const std::string& filePath)
+{
+	if (m_mode != VEHICLE_INPUT_RECORDING)
+	{
+		return false;
+	}
+
+	m_mode = VEHICLE_INPUT_IDLE;
+
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	InputRecordingHeader header;
+	header.m_sceneFlags = m_sceneFlags;
+	header.m_numVehicles = (PxU32)m_numVehicles;
+	header.m_isDigitalInput = m_isDigitalInput ? 1 : 0;
+	header.m_numSteps = (PxU32)m_steps.size();
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (!m_steps.empty())
+	{
+		file.write(reinterpret_cast<const char*>(&m_steps[0]), sizeof(RecordedVehicleInput) * m_steps.size());
+	}
+
+	return file.good();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleInputRecording::BeginReplay(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	InputRecordingHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.m_magic != gInputRecordingMagic || header.m_version != gInputRecordingVersion)
+	{
+		return false;
+	}
+
+	//A different PhysX version is allowed, catching what that breaks is what the hashes are for
+	m_steps.resize(header.m_numSteps);
+	if (header.m_numSteps > 0)
+	{
+		file.read(reinterpret_cast<char*>(&m_steps[0]), sizeof(RecordedVehicleInput) * header.m_numSteps);
+		if (!file)
+		{
+			m_steps.clear();
+			return false;
+		}
+	}
+
+	m_mode = VEHICLE_INPUT_REPLAYING;
+	m_sceneFlags = header.m_sceneFlags;
+	m_numVehicles = (int)header.m_numVehicles;
+	m_isDigitalInput = header.m_isDigitalInput != 0;
+
+	m_numReplayedSteps = 0;
+	m_numHashMismatches = 0;
+	m_firstMismatchStep = -1;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleInputRecording::ReplayInput(PxVehicleDrive4WRawInputData& inputData, int& forcedGear, float& stepSeconds)
+{
+	if (m_mode != VEHICLE_INPUT_REPLAYING || m_numReplayedSteps >= (int)m_steps.size())
+	{
+		return false;
+	}
+
+	const RecordedVehicleInput& step = m_steps[m_numReplayedSteps];
+	m_numReplayedSteps++;
+
+	inputData.setAnalogAccel(step.m_analogAccel);
+	inputData.setAnalogBrake(step.m_analogBrake);
+	inputData.setAnalogHandbrake(step.m_analogHandbrake);
+	inputData.setAnalogSteer(step.m_analogSteer);
+
+	inputData.setDigitalAccel((step.m_digitalFlags & RECORDED_DIGITAL_ACCEL) != 0);
+	inputData.setDigitalBrake((step.m_digitalFlags & RECORDED_DIGITAL_BRAKE) != 0);
+	inputData.setDigitalHandbrake((step.m_digitalFlags & RECORDED_DIGITAL_HANDBRAKE) != 0);
+	inputData.setDigitalSteerLeft((step.m_digitalFlags & RECORDED_DIGITAL_STEER_LEFT) != 0);
+	inputData.setDigitalSteerRight((step.m_digitalFlags & RECORDED_DIGITAL_STEER_RIGHT) != 0);
+	inputData.setGearUp((step.m_digitalFlags & RECORDED_GEAR_UP) != 0);
+	inputData.setGearDown((step.m_digitalFlags & RECORDED_GEAR_DOWN) != 0);
+
+	forcedGear = step.m_forcedGear;
+	stepSeconds = step.m_stepSeconds;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleInputRecording::CheckStateHash(PxU64 stateHash)
+{
+	if (m_mode != VEHICLE_INPUT_REPLAYING || m_numReplayedSteps == 0)
+	{
+		return;
+	}
+
+	int stepIndex = m_numReplayedSteps - 1;
+	if (m_steps[stepIndex].m_stateHash != stateHash)
+	{
+		//Once diverged every later step differs too, the first one is what matters
+		m_firstMismatchStep = m_numHashMismatches == 0 ? stepIndex : m_firstMismatchStep;
+		m_numHashMismatches++;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int VehicleInputRecording::FindFirstStepNotSized(float stepSeconds) const
+{
+	for (int stepIndex = 0; stepIndex < (int)m_steps.size(); ++stepIndex)
+	{
+		if (PxAbs(m_steps[stepIndex].m_stepSeconds - stepSeconds) > gStepSecondsTolerance)
+		{
+			return stepIndex;
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleInputRecording::EndReplay()
+{
+	m_mode = VEHICLE_INPUT_IDLE;
+}
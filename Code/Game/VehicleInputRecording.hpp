@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <string>
+#include <vector>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eVehicleInputRecordingMode
+{
+	VEHICLE_INPUT_IDLE,
+	VEHICLE_INPUT_RECORDING,
+	VEHICLE_INPUT_REPLAYING
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One fixed step of player input and the scene hash after that step. CarController forces gear changes directly on the
+// drive data, outside the raw input, so those are kept alongside it
+//------------------------------------------------------------------------------------------------------------------------------
+struct RecordedVehicleInput
+{
+	float								m_stepSeconds = 0.f;
+	float								m_analogAccel = 0.f;
+	float								m_analogBrake = 0.f;
+	float								m_analogHandbrake = 0.f;
+	float								m_analogSteer = 0.f;
+	PxU8								m_digitalFlags = 0;
+	PxI8								m_forcedGear = -1;		//-1 when no gear was forced
+	PxU16								m_padding = 0;
+	PxU64								m_stateHash = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Records the player car's per-step input to a compact binary file and replays it without a controller. Every step also
+// stores a hash of the simulation state, so a replay on another build reports the first step where the two diverge.
+// Replays only match when they start from the same scene state, so the Game resets the scene before both
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleInputRecording
+{
+public:
+	VehicleInputRecording();
+	~VehicleInputRecording();
+
+	static PxU64						ComputeStateHash(const PxScene& scene, const PxVehicleDrive4W& playerVehicle);
+
+	void								BeginRecording(PxU32 sceneFlags, int numVehicles, bool isDigitalInput);
+	void								RecordInput(const PxVehicleDrive4WRawInputData& inputData, int forcedGear, float stepSeconds);
+	void								RecordStateHash(PxU64 stateHash);
+	bool								EndRecording(const std::string& filePath);
+
+	bool								BeginReplay(const std::string& filePath);
+	//Writes the next recorded step into inputData, false once every step has been replayed
+	bool								ReplayInput(PxVehicleDrive4WRawInputData& inputData, int& forcedGear, float& stepSeconds);
+	void								CheckStateHash(PxU64 stateHash);
+	void								EndReplay();
+
+	eVehicleInputRecordingMode			GetMode() const { return m_mode; }
+	int									GetNumSteps() const { return (int)m_steps.size(); }
+	int									GetNumReplayedSteps() const { return m_numReplayedSteps; }
+	int									GetNumHashMismatches() const { return m_numHashMismatches; }
+	int									GetFirstMismatchStep() const { return m_firstMismatchStep; }
+
+	PxU32								GetRecordedSceneFlags() const { return m_sceneFlags; }
+	int									GetRecordedNumVehicles() const { return m_numVehicles; }
+	bool								WasRecordedWithDigitalInput() const { return m_isDigitalInput; }
+	float								GetRecordedStepSeconds(int stepIndex) const { return m_steps[stepIndex].m_stepSeconds; }
+	//First recorded step whose size isn't stepSeconds, -1 when every step matches
+	int									FindFirstStepNotSized(float stepSeconds) const;
+
+private:
+	eVehicleInputRecordingMode			m_mode = VEHICLE_INPUT_IDLE;
+	std::vector<RecordedVehicleInput>	m_steps;
+
+	PxU32								m_sceneFlags = 0;
+	int									m_numVehicles = 0;
+	bool								m_isDigitalInput = false;
+
+	int									m_numReplayedSteps = 0;
+	int									m_numHashMismatches = 0;
+	int									m_firstMismatchStep = -1;
+};
@@ -0,0 +1,795 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/VehicleManager.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/VehicleArchetype.hpp"
+#include "Game/VehicleSpline.hpp"
+#include "Game/WorkerPool.hpp"
+//PhysX
+#include "ThirdParty/PhysX/include/vehicle/PxVehicleUtil.h"
+//Standard
+#include <algorithm>
+#include <chrono>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Touches kept per swept wheel, the vehicle SDK picks the best one
+const PxU16 gSweepHitsPerWheel = 4;
+
+//Vehicle SDK sub-steps below and above the threshold speed. Full matches the SDK default, reduced takes a single step
+const PxReal gSubStepThresholdSpeed = 5.f;
+const PxU32 gFullLODLowSpeedSubSteps = 3;
+const PxU32 gReducedLODLowSpeedSubSteps = 1;
+const PxU32 gHighSpeedSubSteps = 1;
+
+//How far above and below a kinematic car the ground is looked for
+const float gKinematicGroundProbe = 10.f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Engine time is built on the Win32 performance counter, which the headless build doesn't have
+//------------------------------------------------------------------------------------------------------------------------------
+static double GetVehicleUpdateTimeSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleManager::VehicleManager(int maxVehicles, PxScene& scene, VehicleArchetypeRegistry& archetypes)
+	: m_maxVehicles(maxVehicles)
+	, m_scene(scene)
+	, m_archetypes(archetypes)
+	, m_queryAllocator(g_PxPoolAllocator, "VehicleSceneQueryData")
+{
+	//One raycast per wheel, every vehicle in a single batch
+	m_sceneQueryData = VehicleSceneQueryData::allocate(m_maxVehicles, PX_MAX_NB_WHEELS, 1, m_maxVehicles, WheelSceneQueryPreFilterBlocking, NULL, m_queryAllocator);
+	m_batchQuery = VehicleSceneQueryData::setUpBatchedSceneQuery(0, *m_sceneQueryData, &m_scene);
+
+	//Sweeps need every touch rather than the first block, so they get their own buffers and non-blocking filters
+	m_sweepQueryData = VehicleSceneQueryData::allocate(m_maxVehicles, PX_MAX_NB_WHEELS, gSweepHitsPerWheel, m_maxVehicles, WheelSceneQueryPreFilterNonBlocking, WheelSceneQueryPostFilterNonBlocking, m_queryAllocator);
+	m_sweepBatchQuery = VehicleSceneQueryData::setUpBatchedSceneQuery(0, *m_sweepQueryData, &m_scene);
+
+	m_vehiclesToRaycast = new bool[m_maxVehicles];
+	m_vehiclesToSweep = new bool[m_maxVehicles];
+
+	m_vehicles.reserve(m_maxVehicles);
+	m_vehicleWheels.reserve(m_maxVehicles);
+	m_vehicleQueryResults.reserve(m_maxVehicles);
+	m_wheelQueryResults.resize(m_maxVehicles * PX_MAX_NB_WHEELS);
+
+	m_concurrentUpdates.reserve(m_maxVehicles);
+	m_concurrentWheelUpdates.resize(m_maxVehicles * PX_MAX_NB_WHEELS);
+
+	m_simulatedWheels.reserve(m_maxVehicles);
+	m_simulatedQueryResults.reserve(m_maxVehicles);
+	m_simulatedConcurrentUpdates.reserve(m_maxVehicles);
+	m_simLODTargets.reserve(m_maxVehicles);
+	m_lodCandidates.reserve(m_maxVehicles);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleManager::~VehicleManager()
+{
+	ReleaseOwnedVehicles();
+
+	delete m_workerPool;
+	m_workerPool = nullptr;
+
+	PX_RELEASE(m_batchQuery);
+	PX_RELEASE(m_sweepBatchQuery);
+
+	if (m_sceneQueryData != nullptr)
+	{
+		m_sceneQueryData->free(m_queryAllocator);
+		m_sceneQueryData = nullptr;
+	}
+
+	if (m_sweepQueryData != nullptr)
+	{
+		m_sweepQueryData->free(m_queryAllocator);
+		m_sweepQueryData = nullptr;
+	}
+
+	delete[] m_vehiclesToRaycast;
+	m_vehiclesToRaycast = nullptr;
+
+	delete[] m_vehiclesToSweep;
+	m_vehiclesToSweep = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int VehicleManager::AddVehicle(PxVehicleDrive4W& vehicle, PxVehicleDrive4WRawInputData& inputData, const VehicleDescriptor& descriptor)
+{
+	return AddVehicle(vehicle, inputData, m_archetypes.FindOrCreateArchetype(descriptor));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int VehicleManager::AddVehicle(PxVehicleDrive4W& vehicle, PxVehicleDrive4WRawInputData& inputData, const VehicleArchetype& archetype)
+{
+	if ((int)m_vehicles.size() >= m_maxVehicles)
+	{
+		ERROR_AND_DIE("VehicleManager is full, raise the max vehicle count");
+	}
+
+	ManagedVehicle managedVehicle;
+	managedVehicle.m_vehicle = &vehicle;
+	managedVehicle.m_inputData = &inputData;
+	managedVehicle.m_archetype = &archetype;
+	m_vehicles.push_back(managedVehicle);
+
+	//The wheel query results are carved out of one buffer, PX_MAX_NB_WHEELS per vehicle
+	int vehicleIndex = (int)m_vehicles.size() - 1;
+	PxVehicleWheelQueryResult queryResult = { &m_wheelQueryResults[vehicleIndex * PX_MAX_NB_WHEELS], vehicle.mWheelsSimData.getNbWheels() };
+
+	m_vehicleWheels.push_back(&vehicle);
+	m_vehicleQueryResults.push_back(queryResult);
+
+	m_concurrentUpdates.emplace_back();
+	SetConcurrentUpdateBuffers(vehicleIndex);
+
+	m_simLODTargets.push_back(VEHICLE_LOD_FULL);
+	vehicle.mWheelsSimData.setSubStepCount(gSubStepThresholdSpeed, gFullLODLowSpeedSubSteps, gHighSpeedSubSteps);
+
+	return vehicleIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int VehicleManager::SpawnVehicle(const PxTransform& startPose)
+{
+	return SpawnVehicle(startPose, m_defaultDescriptor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int VehicleManager::SpawnVehicle(const PxTransform& startPose, const VehicleDescriptor& descriptor)
+{
+	//Only the first car of a model cooks meshes and builds sim data
+	VehicleArchetype& archetype = m_archetypes.FindOrCreateArchetype(descriptor);
+	PxVehicleDrive4W* vehicle = archetype.CreateVehicle(*g_PxPhysXSystem->GetPhysXSDK());
+
+	vehicle->getRigidDynamicActor()->setGlobalPose(startPose);
+	m_scene.addActor(*vehicle->getRigidDynamicActor());
+
+	vehicle->setToRestState();
+	vehicle->mDriveDynData.forceGearChange(PxVehicleGearsData::eFIRST);
+	vehicle->mDriveDynData.setUseAutoGears(true);
+
+	int vehicleIndex = AddVehicle(*vehicle, *new PxVehicleDrive4WRawInputData(), archetype);
+	m_vehicles[vehicleIndex].m_isOwned = true;
+
+	return vehicleIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetVehicleDescriptor(int vehicleIndex, const VehicleDescriptor& descriptor)
+{
+	ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+	descriptor.ApplyToVehicle(*managedVehicle.m_vehicle);
+	managedVehicle.m_archetype = &m_archetypes.FindOrCreateArchetype(descriptor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::ReleaseOwnedVehicles()
+{
+	//Compact the arrays so only the externally owned vehicles are left
+	int writeIndex = 0;
+	for (int vehicleIndex = 0; vehicleIndex < (int)m_vehicles.size(); ++vehicleIndex)
+	{
+		ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+		if (managedVehicle.m_isOwned)
+		{
+			managedVehicle.m_vehicle->getRigidDynamicActor()->release();
+			managedVehicle.m_vehicle->free();
+			delete managedVehicle.m_inputData;
+			continue;
+		}
+
+		m_vehicles[writeIndex] = managedVehicle;
+		m_vehicleWheels[writeIndex] = managedVehicle.m_vehicle;
+		m_vehicleQueryResults[writeIndex].wheelQueryResults = &m_wheelQueryResults[writeIndex * PX_MAX_NB_WHEELS];
+		m_vehicleQueryResults[writeIndex].nbWheelQueryResults = managedVehicle.m_vehicle->mWheelsSimData.getNbWheels();
+		SetConcurrentUpdateBuffers(writeIndex);
+		writeIndex++;
+	}
+
+	m_vehicles.resize(writeIndex);
+	m_vehicleWheels.resize(writeIndex);
+	m_vehicleQueryResults.resize(writeIndex);
+	m_concurrentUpdates.resize(writeIndex);
+	m_simLODTargets.resize(writeIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::ResetQueryState()
+{
+	for (int vehicleIndex = 0; vehicleIndex < (int)m_vehicles.size(); ++vehicleIndex)
+	{
+		//Due for a refresh, so cached vehicles don't drive on contact planes from before the reset
+		m_vehicles[vehicleIndex].m_stepsSinceQuery = PxMax(m_cachedQuerySteps, m_reducedQuerySteps);
+		m_vehicles[vehicleIndex].m_isInAir = false;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::Update(float deltaTime)
+{
+	PROFILE_SCOPE("VehicleManager::Update");
+
+	int numVehicles = (int)m_vehicles.size();
+	if (numVehicles == 0)
+	{
+		return;
+	}
+
+	PxVehicleDrivableSurfaceToTireFrictionPairs* tireFrictionPairs = g_PxPhysXSystem->GetVehicleTireFrictionPairs();
+
+	//Promotions and demotions happen before anything reads the vehicles this step
+	SelectSimLODs();
+
+	//Update the control inputs for every simulated vehicle
+	for (int vehicleIndex = 0; vehicleIndex < numVehicles; ++vehicleIndex)
+	{
+		if (m_vehicles[vehicleIndex].m_simLOD != VEHICLE_LOD_KINEMATIC)
+		{
+			SmoothVehicleInputs(m_vehicles[vehicleIndex], deltaTime);
+		}
+	}
+
+	MoveKinematicVehicles(deltaTime);
+
+	//At most one sweep batch and one raycast batch, vehicles left out of both reuse their last contact planes
+	SelectSuspensionQueries();
+	RunSuspensionQueries();
+
+	//Vehicle update, kinematic vehicles are left out since PxVehicleUpdates has no per vehicle mask
+	int numSimulatedVehicles = GatherSimulatedVehicles();
+	const PxVec3 grav = m_scene.getGravity();
+	double vehicleUpdateStart = GetVehicleUpdateTimeSeconds();
+	if (numSimulatedVehicles == 0)
+	{
+		//Every vehicle is kinematic
+	}
+	else if (m_workerPool != nullptr && numSimulatedVehicles > m_vehiclesPerChunk)
+	{
+		UpdateVehiclesConcurrent(numSimulatedVehicles, deltaTime, grav, *tireFrictionPairs);
+	}
+	else
+	{
+		PROFILE_SCOPE("PxVehicleUpdates");
+		PxVehicleUpdates(deltaTime, grav, *tireFrictionPairs, numSimulatedVehicles, &m_simulatedWheels[0], &m_simulatedQueryResults[0]);
+	}
+	m_lastVehicleUpdateSeconds = GetVehicleUpdateTimeSeconds() - vehicleUpdateStart;
+
+	//Work out which vehicles are in the air
+	for (int vehicleIndex = 0; vehicleIndex < numVehicles; ++vehicleIndex)
+	{
+		ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+		if (managedVehicle.m_simLOD == VEHICLE_LOD_KINEMATIC || managedVehicle.m_vehicle->getRigidDynamicActor()->isSleeping())
+		{
+			managedVehicle.m_isInAir = false;
+			continue;
+		}
+
+		managedVehicle.m_isInAir = PxVehicleIsInAir(m_vehicleQueryResults[vehicleIndex]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetDigitalInput(int vehicleIndex, bool isDigitalInput)
+{
+	m_vehicles[vehicleIndex].m_isDigitalInput = isDigitalInput;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SelectSuspensionQueries()
+{
+	m_numRaycastVehicles = 0;
+	m_numSweepVehicles = 0;
+	m_numWheelQueriesLastStep = 0;
+	for (int qualityIndex = 0; qualityIndex < NUM_VEHICLE_QUERY_QUALITIES; ++qualityIndex)
+	{
+		m_numVehiclesAtQuality[qualityIndex] = 0;
+	}
+
+	for (int vehicleIndex = 0; vehicleIndex < (int)m_vehicles.size(); ++vehicleIndex)
+	{
+		ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+
+		//Kinematic vehicles have no suspension to feed
+		if (managedVehicle.m_simLOD == VEHICLE_LOD_KINEMATIC)
+		{
+			m_vehiclesToSweep[vehicleIndex] = false;
+			m_vehiclesToRaycast[vehicleIndex] = false;
+			continue;
+		}
+
+		//Far cars are also at the reduced tier, unless hysteresis is still holding them at full
+		bool isReduced = managedVehicle.m_simLOD == VEHICLE_LOD_REDUCED;
+		if (!managedVehicle.m_hasQualityOverride)
+		{
+			bool isFar = managedVehicle.m_lodDistance > m_raycastDistance;
+			managedVehicle.m_queryQuality = (isFar || isReduced || managedVehicle.m_vehicle->getRigidDynamicActor()->isSleeping()) ? VEHICLE_QUERY_CACHED : VEHICLE_QUERY_RAYCAST;
+		}
+
+		m_numVehiclesAtQuality[managedVehicle.m_queryQuality]++;
+
+		bool doSweep = managedVehicle.m_queryQuality == VEHICLE_QUERY_SWEEP;
+		bool doRaycast = managedVehicle.m_queryQuality == VEHICLE_QUERY_RAYCAST;
+
+		//Cached vehicles still refresh now and then so they notice the ground changing under them
+		if (managedVehicle.m_queryQuality == VEHICLE_QUERY_CACHED)
+		{
+			doRaycast = managedVehicle.m_stepsSinceQuery >= (isReduced ? m_reducedQuerySteps : m_cachedQuerySteps);
+		}
+
+		m_vehiclesToSweep[vehicleIndex] = doSweep;
+		m_vehiclesToRaycast[vehicleIndex] = doRaycast;
+
+		if (doSweep || doRaycast)
+		{
+			managedVehicle.m_stepsSinceQuery = 0;
+			m_numWheelQueriesLastStep += managedVehicle.m_vehicle->mWheelsSimData.getNbWheels();
+		}
+		else
+		{
+			managedVehicle.m_stepsSinceQuery++;
+		}
+
+		m_numSweepVehicles += doSweep ? 1 : 0;
+		m_numRaycastVehicles += doRaycast ? 1 : 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::RunSuspensionQueries()
+{
+	PROFILE_SCOPE("VehicleManager::RunSuspensionQueries");
+
+	int numVehicles = (int)m_vehicles.size();
+
+	if (m_numSweepVehicles > 0)
+	{
+		PxSweepQueryResult* sweepResults = m_sweepQueryData->getSweepQueryResultBuffer(0);
+		const PxU32 sweepResultsSize = m_sweepQueryData->getQueryResultBufferSize();
+		PxVehicleSuspensionSweeps(m_sweepBatchQuery, numVehicles, &m_vehicleWheels[0], sweepResultsSize, sweepResults, gSweepHitsPerWheel, m_vehiclesToSweep, 1.0f, 1.01f);
+	}
+
+	if (m_numRaycastVehicles > 0)
+	{
+		PxRaycastQueryResult* raycastResults = m_sceneQueryData->getRaycastQueryResultBuffer(0);
+		const PxU32 raycastResultsSize = m_sceneQueryData->getQueryResultBufferSize();
+		PxVehicleSuspensionRaycasts(m_batchQuery, numVehicles, &m_vehicleWheels[0], raycastResultsSize, raycastResults, m_vehiclesToRaycast);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetQueryQualityOverride(int vehicleIndex, eVehicleQueryQuality quality)
+{
+	m_vehicles[vehicleIndex].m_queryQuality = quality;
+	m_vehicles[vehicleIndex].m_hasQualityOverride = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::ClearQueryQualityOverride(int vehicleIndex)
+{
+	m_vehicles[vehicleIndex].m_hasQualityOverride = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetQueryLODSettings(float raycastDistance, int cachedQuerySteps)
+{
+	m_raycastDistance = raycastDistance;
+	m_cachedQuerySteps = cachedQuerySteps > 0 ? cachedQuerySteps : 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetSimLODSettings(float kinematicDistance, float hysteresis, int reducedQuerySteps, int maxFullVehicles, int maxReducedVehicles)
+{
+	m_reducedQuerySteps = reducedQuerySteps > 0 ? reducedQuerySteps : 1;
+	m_kinematicDistance = kinematicDistance;
+	m_lodHysteresis = hysteresis > 0.f ? hysteresis : 0.f;
+	m_maxFullLODVehicles = maxFullVehicles > 0 ? maxFullVehicles : 0;
+	m_maxReducedLODVehicles = maxReducedVehicles > 0 ? maxReducedVehicles : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetSimLODOverride(int vehicleIndex, eVehicleSimLOD simLOD)
+{
+	ChangeSimLOD(m_vehicles[vehicleIndex], simLOD);
+	m_vehicles[vehicleIndex].m_hasSimLODOverride = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::ClearSimLODOverride(int vehicleIndex)
+{
+	m_vehicles[vehicleIndex].m_hasSimLODOverride = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetLODSpline(int vehicleIndex, const VehicleSpline* spline)
+{
+	ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+	managedVehicle.m_lodSpline = spline;
+
+	//Already kinematic, pick the spline up from where the car is. Without one the car holds still
+	if (managedVehicle.m_simLOD == VEHICLE_LOD_KINEMATIC)
+	{
+		if (spline != nullptr)
+		{
+			managedVehicle.m_splineDistance = spline->FindClosestDistance(managedVehicle.m_vehicle->getRigidDynamicActor()->getGlobalPose().p);
+		}
+		else
+		{
+			managedVehicle.m_kinematicSpeed = 0.f;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::ResetSimLOD()
+{
+	for (int vehicleIndex = 0; vehicleIndex < (int)m_vehicles.size(); ++vehicleIndex)
+	{
+		ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+		if (managedVehicle.m_simLOD == VEHICLE_LOD_KINEMATIC)
+		{
+			ChangeSimLOD(managedVehicle, VEHICLE_LOD_REDUCED);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SelectSimLODs()
+{
+	PROFILE_SCOPE("VehicleManager::SelectSimLODs");
+
+	int numVehicles = (int)m_vehicles.size();
+	for (int vehicleIndex = 0; vehicleIndex < numVehicles; ++vehicleIndex)
+	{
+		ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+		PxVec3 position = managedVehicle.m_vehicle->getRigidDynamicActor()->getGlobalPose().p;
+
+		//Closest of the focus and the edge of every observer's interest radius
+		float distance = (position - m_lodFocus).magnitude();
+		for (int observerIndex = 0; observerIndex < (int)m_lodObservers.size(); ++observerIndex)
+		{
+			const VehicleLODObserver& observer = m_lodObservers[observerIndex];
+			distance = PxMin(distance, PxMax((position - observer.m_position).magnitude() - observer.m_interestRadius, 0.f));
+		}
+		managedVehicle.m_lodDistance = distance;
+
+		if (managedVehicle.m_hasSimLODOverride)
+		{
+			m_simLODTargets[vehicleIndex] = managedVehicle.m_simLOD;
+			continue;
+		}
+
+		//Moving up a tier needs the car to be hysteresis inside the boundary, so cars sitting on it don't flip every step
+		eVehicleSimLOD simLOD = distance <= m_raycastDistance ? VEHICLE_LOD_FULL : (distance <= m_kinematicDistance ? VEHICLE_LOD_REDUCED : VEHICLE_LOD_KINEMATIC);
+		if (simLOD < managedVehicle.m_simLOD)
+		{
+			float promoteDistance = distance + m_lodHysteresis;
+			simLOD = promoteDistance <= m_raycastDistance ? VEHICLE_LOD_FULL : (promoteDistance <= m_kinematicDistance ? VEHICLE_LOD_REDUCED : VEHICLE_LOD_KINEMATIC);
+			simLOD = PxMin(simLOD, managedVehicle.m_simLOD);
+		}
+
+		m_simLODTargets[vehicleIndex] = simLOD;
+	}
+
+	//Full first, so cars it pushes out can still be pushed out of reduced too
+	if (m_maxFullLODVehicles > 0)
+	{
+		ApplySimLODBudget(VEHICLE_LOD_FULL, m_maxFullLODVehicles);
+	}
+
+	if (m_maxReducedLODVehicles > 0)
+	{
+		ApplySimLODBudget(VEHICLE_LOD_REDUCED, m_maxReducedLODVehicles);
+	}
+
+	m_numSimLODChangesLastStep = 0;
+	for (int lodIndex = 0; lodIndex < NUM_VEHICLE_SIM_LODS; ++lodIndex)
+	{
+		m_numVehiclesAtSimLOD[lodIndex] = 0;
+	}
+
+	for (int vehicleIndex = 0; vehicleIndex < numVehicles; ++vehicleIndex)
+	{
+		ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+		if (managedVehicle.m_simLOD != m_simLODTargets[vehicleIndex])
+		{
+			ChangeSimLOD(managedVehicle, m_simLODTargets[vehicleIndex]);
+			m_numSimLODChangesLastStep++;
+		}
+
+		m_numVehiclesAtSimLOD[managedVehicle.m_simLOD]++;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::ApplySimLODBudget(eVehicleSimLOD simLOD, int maxVehicles)
+{
+	//Pinned vehicles use up the budget but are never moved
+	m_lodCandidates.clear();
+	int numPinned = 0;
+	for (int vehicleIndex = 0; vehicleIndex < (int)m_vehicles.size(); ++vehicleIndex)
+	{
+		if (m_simLODTargets[vehicleIndex] > simLOD)
+		{
+			continue;
+		}
+
+		if (m_vehicles[vehicleIndex].m_hasSimLODOverride)
+		{
+			numPinned++;
+		}
+		else
+		{
+			m_lodCandidates.push_back(vehicleIndex);
+		}
+	}
+
+	int numAllowed = PxMax(maxVehicles - numPinned, 0);
+	if ((int)m_lodCandidates.size() <= numAllowed)
+	{
+		return;
+	}
+
+	//The closest numAllowed keep the tier, the rest drop to the one below. Cars already at the tier or better rank hysteresis
+	//closer, so a newcomer has to be clearly nearer to take a place and cars at about the same distance don't swap every step
+	auto getRankDistance = [this, simLOD](int vehicleIndex)
+	{
+		const ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+		return managedVehicle.m_simLOD <= simLOD ? managedVehicle.m_lodDistance - m_lodHysteresis : managedVehicle.m_lodDistance;
+	};
+
+	std::nth_element(m_lodCandidates.begin(), m_lodCandidates.begin() + numAllowed, m_lodCandidates.end(), [&getRankDistance](int lhs, int rhs)
+	{
+		return getRankDistance(lhs) < getRankDistance(rhs);
+	});
+
+	eVehicleSimLOD demotedLOD = (eVehicleSimLOD)(simLOD + 1);
+	for (int candidateIndex = numAllowed; candidateIndex < (int)m_lodCandidates.size(); ++candidateIndex)
+	{
+		m_simLODTargets[m_lodCandidates[candidateIndex]] = demotedLOD;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::ChangeSimLOD(ManagedVehicle& managedVehicle, eVehicleSimLOD simLOD)
+{
+	if (managedVehicle.m_simLOD == simLOD)
+	{
+		return;
+	}
+
+	if (simLOD == VEHICLE_LOD_KINEMATIC)
+	{
+		MakeKinematic(managedVehicle);
+	}
+	else
+	{
+		if (managedVehicle.m_simLOD == VEHICLE_LOD_KINEMATIC)
+		{
+			MakeSimulated(managedVehicle);
+		}
+
+		PxU32 lowSpeedSubSteps = simLOD == VEHICLE_LOD_FULL ? gFullLODLowSpeedSubSteps : gReducedLODLowSpeedSubSteps;
+		managedVehicle.m_vehicle->mWheelsSimData.setSubStepCount(gSubStepThresholdSpeed, lowSpeedSubSteps, gHighSpeedSubSteps);
+	}
+
+	managedVehicle.m_simLOD = simLOD;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::MakeKinematic(ManagedVehicle& managedVehicle)
+{
+	PxVehicleDrive4W& vehicle = *managedVehicle.m_vehicle;
+	PxRigidDynamic* actor = vehicle.getRigidDynamicActor();
+
+	//Carried along the spline and handed back on promotion. Kinematic actors go through walls, so a car with no spline
+	//to keep it on the road parks where it is instead
+	managedVehicle.m_kinematicSpeed = 0.f;
+	if (managedVehicle.m_lodSpline != nullptr)
+	{
+		managedVehicle.m_kinematicSpeed = vehicle.computeForwardSpeed();
+		managedVehicle.m_splineDistance = managedVehicle.m_lodSpline->FindClosestDistance(actor->getGlobalPose().p);
+	}
+
+	actor->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, true);
+	managedVehicle.m_isInAir = false;
+
+	//Cars demoted in the air or mid bounce are set down at ride height, so they don't hover or get promoted inside the ground
+	PxTransform pose = actor->getGlobalPose();
+	if (PlaceOnGround(managedVehicle, pose.q.getBasisVector2(), pose))
+	{
+		actor->setKinematicTarget(pose);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleManager::PlaceOnGround(const ManagedVehicle& managedVehicle, const PxVec3& heading, PxTransform& pose) const
+{
+	//Wheel centre offsets are at rest, so this is how high the actor sits over flat ground
+	const PxVehicleWheelsSimData& wheelsSimData = managedVehicle.m_vehicle->mWheelsSimData;
+	float rideHeight = wheelsSimData.getWheelData(0).mRadius - wheelsSimData.getWheelCentreOffset(0).y;
+
+	//Statics only, the other vehicles are dynamic or kinematic actors
+	PxRaycastBuffer groundHit;
+	PxVec3 probeStart = pose.p + PxVec3(0.f, gKinematicGroundProbe, 0.f);
+	if (!m_scene.raycast(probeStart, PxVec3(0.f, -1.f, 0.f), 2.f * gKinematicGroundProbe + rideHeight, groundHit, PxHitFlag::eDEFAULT, PxQueryFilterData(PxQueryFlag::eSTATIC)))
+	{
+		//Nothing under the car, leave it where it is
+		return false;
+	}
+
+	//Level with the ground under it, pointing along the heading
+	PxVec3 up = groundHit.block.normal;
+	PxVec3 forward = heading - up * heading.dot(up);
+	if (forward.normalize() == 0.f)
+	{
+		return false;
+	}
+
+	pose.p = groundHit.block.position + up * rideHeight;
+	pose.q = PxQuat(PxMat33(up.cross(forward), up, forward));
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::MakeSimulated(ManagedVehicle& managedVehicle)
+{
+	PxVehicleDrive4W& vehicle = *managedVehicle.m_vehicle;
+	PxRigidDynamic* actor = vehicle.getRigidDynamicActor();
+	actor->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, false);
+
+	//Pick up at the speed the car was following the spline with, wheels rolling and engine turning to match
+	const float speed = managedVehicle.m_kinematicSpeed;
+	PxVec3 forward = actor->getGlobalPose().q.getBasisVector2();
+	actor->setLinearVelocity(forward * speed);
+	actor->setAngularVelocity(PxVec3(0.f, 0.f, 0.f));
+
+	PxU32 numWheels = vehicle.mWheelsSimData.getNbWheels();
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; ++wheelIndex)
+	{
+		vehicle.mWheelsDynData.setWheelRotationSpeed(wheelIndex, speed / vehicle.mWheelsSimData.getWheelData(wheelIndex).mRadius);
+	}
+
+	const PxVehicleGearsData& gearsData = vehicle.mDriveSimData.getGearsData();
+	float wheelRotationSpeed = speed / vehicle.mWheelsSimData.getWheelData(0).mRadius;
+	float gearRatio = gearsData.getGearRatio((PxVehicleGearsData::Enum)vehicle.mDriveDynData.getCurrentGear());
+	float engineRotationSpeed = PxAbs(wheelRotationSpeed * gearRatio * gearsData.mFinalRatio);
+	vehicle.mDriveDynData.setEngineRotationSpeed(PxMin(engineRotationSpeed, vehicle.mDriveSimData.getEngineData().mMaxOmega));
+
+	//The contact planes are from before the car went kinematic, query straight away
+	managedVehicle.m_stepsSinceQuery = PxMax(m_cachedQuerySteps, m_reducedQuerySteps);
+	managedVehicle.m_isInAir = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::MoveKinematicVehicles(float deltaTime)
+{
+	if (m_numVehiclesAtSimLOD[VEHICLE_LOD_KINEMATIC] == 0)
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("VehicleManager::MoveKinematicVehicles");
+
+	for (int vehicleIndex = 0; vehicleIndex < (int)m_vehicles.size(); ++vehicleIndex)
+	{
+		ManagedVehicle& managedVehicle = m_vehicles[vehicleIndex];
+		if (managedVehicle.m_simLOD != VEHICLE_LOD_KINEMATIC || managedVehicle.m_kinematicSpeed == 0.f)
+		{
+			continue;
+		}
+
+		PxRigidDynamic* actor = managedVehicle.m_vehicle->getRigidDynamicActor();
+		PxTransform pose = actor->getGlobalPose();
+		float travel = managedVehicle.m_kinematicSpeed * deltaTime;
+
+		//Only cars with a spline move, see MakeKinematic. The spline gives the line, the ground under it the height
+		const VehicleSpline& spline = *managedVehicle.m_lodSpline;
+		managedVehicle.m_splineDistance = spline.WrapDistance(managedVehicle.m_splineDistance + travel);
+
+		PxVec3 splinePosition = spline.GetPosition(managedVehicle.m_splineDistance);
+		pose.p = PxVec3(splinePosition.x, pose.p.y, splinePosition.z);
+
+		//Faces back along the spline when reversing
+		PxVec3 heading = spline.GetTangent(managedVehicle.m_splineDistance) * (travel < 0.f ? -1.f : 1.f);
+		PlaceOnGround(managedVehicle, heading, pose);
+
+		actor->setKinematicTarget(pose);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int VehicleManager::GatherSimulatedVehicles()
+{
+	m_simulatedWheels.clear();
+	m_simulatedQueryResults.clear();
+	m_simulatedConcurrentUpdates.clear();
+
+	//Copies share the wheel buffers, so results still land where m_vehicleQueryResults points
+	for (int vehicleIndex = 0; vehicleIndex < (int)m_vehicles.size(); ++vehicleIndex)
+	{
+		if (m_vehicles[vehicleIndex].m_simLOD == VEHICLE_LOD_KINEMATIC)
+		{
+			continue;
+		}
+
+		m_simulatedWheels.push_back(m_vehicleWheels[vehicleIndex]);
+		m_simulatedQueryResults.push_back(m_vehicleQueryResults[vehicleIndex]);
+		m_simulatedConcurrentUpdates.push_back(m_concurrentUpdates[vehicleIndex]);
+	}
+
+	return (int)m_simulatedWheels.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetNumWorkerThreads(int numThreads)
+{
+	delete m_workerPool;
+	m_workerPool = nullptr;
+
+	//A single thread keeps the plain PxVehicleUpdates path with no deferred actor writes
+	if (numThreads > 1)
+	{
+		m_workerPool = new WorkerPool(numThreads);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetVehiclesPerChunk(int vehiclesPerChunk)
+{
+	m_vehiclesPerChunk = vehiclesPerChunk > 0 ? vehiclesPerChunk : 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int VehicleManager::GetNumWorkerThreads() const
+{
+	return m_workerPool != nullptr ? m_workerPool->GetNumThreads() : 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::UpdateVehiclesConcurrent(int numVehicles, float deltaTime, const PxVec3& gravity, const PxVehicleDrivableSurfaceToTireFrictionPairs& tireFrictionPairs)
+{
+	int numChunks = (numVehicles + m_vehiclesPerChunk - 1) / m_vehiclesPerChunk;
+
+	//Each chunk only reads shared data and writes its own slice of the concurrent buffers, nothing touches the actors yet
+	m_workerPool->ParallelFor(numChunks, [&](int chunkIndex)
+	{
+		PROFILE_SCOPE("VehicleManager::UpdateChunk");
+
+		int firstVehicle = chunkIndex * m_vehiclesPerChunk;
+		int numChunkVehicles = PxMin(m_vehiclesPerChunk, numVehicles - firstVehicle);
+
+		PxVehicleUpdates(deltaTime, gravity, tireFrictionPairs, numChunkVehicles, &m_simulatedWheels[firstVehicle], &m_simulatedQueryResults[firstVehicle], &m_simulatedConcurrentUpdates[firstVehicle]);
+	});
+
+	//Forces, velocities and wake ups are applied to the actors here, on this thread
+	PROFILE_SCOPE("PxVehiclePostUpdates");
+	PxVehiclePostUpdates(&m_simulatedConcurrentUpdates[0], numVehicles, &m_simulatedWheels[0]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetConcurrentUpdateBuffers(int vehicleIndex)
+{
+	PxVehicleConcurrentUpdateData& concurrentUpdate = m_concurrentUpdates[vehicleIndex];
+	concurrentUpdate.concurrentWheelUpdates = &m_concurrentWheelUpdates[vehicleIndex * PX_MAX_NB_WHEELS];
+	concurrentUpdate.nbConcurrentWheelUpdates = m_vehicles[vehicleIndex].m_vehicle->mWheelsSimData.getNbWheels();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SmoothVehicleInputs(ManagedVehicle& managedVehicle, float deltaTime)
+{
+	const VehicleArchetype& archetype = *managedVehicle.m_archetype;
+	if (managedVehicle.m_isDigitalInput)
+	{
+		PxVehicleDrive4WSmoothDigitalRawInputsAndSetAnalogInputs(m_keySmoothingData, archetype.GetSteerVsForwardSpeedTable(), *managedVehicle.m_inputData, deltaTime, managedVehicle.m_isInAir, *managedVehicle.m_vehicle);
+	}
+	else
+	{
+		PxVehicleDrive4WSmoothAnalogRawInputsAndSetAnalogInputs(archetype.GetPadSmoothingData(), archetype.GetSteerVsForwardSpeedTable(), *managedVehicle.m_inputData, deltaTime, managedVehicle.m_isInAir, *managedVehicle.m_vehicle);
+	}
+}
@@ -0,0 +1,238 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include "Game/PhysXPoolAllocator.hpp"
+#include "Game/VehicleDescriptor.hpp"
+//Standard
+#include <vector>
+
+class VehicleArchetype;
+class VehicleArchetypeRegistry;
+class VehicleSpline;
+class WorkerPool;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// How much scene query work a vehicle's suspension gets each step
+//------------------------------------------------------------------------------------------------------------------------------
+enum eVehicleQueryQuality
+{
+	VEHICLE_QUERY_SWEEP,		//Swept wheel shapes, catches kerbs and edges a ray misses
+	VEHICLE_QUERY_RAYCAST,		//One ray per wheel
+	VEHICLE_QUERY_CACHED,		//Reuses the last contact planes, refreshed with a raycast every few steps
+
+	NUM_VEHICLE_QUERY_QUALITIES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// How much simulation a vehicle gets, picked from its distance to the LOD focus and observers
+//------------------------------------------------------------------------------------------------------------------------------
+enum eVehicleSimLOD
+{
+	VEHICLE_LOD_FULL,			//Every step: suspension queries, vehicle SDK sub-steps at full count
+	VEHICLE_LOD_REDUCED,		//Cached suspension queries on their own refresh interval, one vehicle SDK sub-step
+	VEHICLE_LOD_KINEMATIC,		//Kinematic actor following its spline at the speed it had or parked, no vehicle update
+
+	NUM_VEHICLE_SIM_LODS
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Anything besides the focus that wants the vehicles around it at full detail, like another player's camera
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleLODObserver
+{
+	PxVec3								m_position = PxVec3(0.f, 0.f, 0.f);
+	float								m_interestRadius = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ManagedVehicle
+{
+	PxVehicleDrive4W*					m_vehicle = nullptr;
+	PxVehicleDrive4WRawInputData*		m_inputData = nullptr;
+
+	bool								m_isDigitalInput = false;
+	bool								m_isInAir = false;
+
+	eVehicleQueryQuality				m_queryQuality = VEHICLE_QUERY_RAYCAST;
+	//Pins the quality instead of picking it from distance to the LOD focus
+	bool								m_hasQualityOverride = false;
+	int									m_stepsSinceQuery = 0;
+	//AI vehicles are created and released here, the player car belongs to the engine's vehicle SDK setup
+	bool								m_isOwned = false;
+
+	//Model the car was built from, or for cars built elsewhere the one matching its descriptor. Supplies the input smoothing
+	const VehicleArchetype*				m_archetype = nullptr;
+
+	eVehicleSimLOD						m_simLOD = VEHICLE_LOD_FULL;
+	//Pins the LOD instead of picking it from distance and the LOD budgets
+	bool								m_hasSimLODOverride = false;
+	//Distance to the focus, or less inside an observer's interest radius
+	float								m_lodDistance = 0.f;
+
+	//Kinematic follower, set down on the ground under the spline. Without a spline the car parks
+	const VehicleSpline*				m_lodSpline = nullptr;
+	float								m_splineDistance = 0.f;
+	float								m_kinematicSpeed = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Steps every PxVehicleDrive4W in the scene with one batched suspension raycast and one PxVehicleUpdates call. Query
+// buffers are sized for the maximum vehicle count up front so adding cars never reallocates them. Spawned vehicles and
+// suspension queries go into the scene the manager was made for. Spawned vehicles are instances of an archetype from the
+// registry, which has to outlive the manager
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleManager
+{
+public:
+	VehicleManager(int maxVehicles, PxScene& scene, VehicleArchetypeRegistry& archetypes);
+	~VehicleManager();
+
+	//For vehicles built elsewhere, the descriptor names the model they were built from
+	int									AddVehicle(PxVehicleDrive4W& vehicle, PxVehicleDrive4WRawInputData& inputData, const VehicleDescriptor& descriptor);
+	//Spawns use the default descriptor unless they are given one
+	int									SpawnVehicle(const PxTransform& startPose);
+	int									SpawnVehicle(const PxTransform& startPose, const VehicleDescriptor& descriptor);
+	//Applies everything the descriptor can change on an existing vehicle, see VehicleDescriptor::ApplyToVehicle
+	void								SetVehicleDescriptor(int vehicleIndex, const VehicleDescriptor& descriptor);
+	void								SetDefaultDescriptor(const VehicleDescriptor& descriptor) { m_defaultDescriptor = descriptor; }
+	const VehicleDescriptor&			GetDefaultDescriptor() const { return m_defaultDescriptor; }
+	void								ReleaseOwnedVehicles();
+	//Forgets in-air flags and cached contacts after vehicles were teleported
+	void								ResetQueryState();
+
+	void								Update(float deltaTime);
+
+	void								SetDigitalInput(int vehicleIndex, bool isDigitalInput);
+	void								SetNumWorkerThreads(int numThreads);
+	void								SetVehiclesPerChunk(int vehiclesPerChunk);
+
+	int									GetNumWorkerThreads() const;
+	//Wall time of the PxVehicleUpdates call(s) alone, no queries or LOD work
+	double								GetLastVehicleUpdateSeconds() const { return m_lastVehicleUpdateSeconds; }
+
+	void								SetQueryQualityOverride(int vehicleIndex, eVehicleQueryQuality quality);
+	void								ClearQueryQualityOverride(int vehicleIndex);
+	void								SetQueryLODSettings(float raycastDistance, int cachedQuerySteps);
+	void								SetLODFocus(const PxVec3& focusPosition) { m_lodFocus = focusPosition; }
+
+	//Full inside the raycast distance, reduced out to kinematicDistance and kinematic beyond it. Promotion needs the car
+	//hysteresis metres inside a boundary. Reduced cars refresh their contact planes after reducedQuerySteps cached steps,
+	//other cached cars keep the query LOD interval. A budget above 0 caps how many cars get that LOD or better, the closest win
+	void								SetSimLODSettings(float kinematicDistance, float hysteresis, int reducedQuerySteps, int maxFullVehicles, int maxReducedVehicles);
+	void								SetSimLODOverride(int vehicleIndex, eVehicleSimLOD simLOD);
+	void								ClearSimLODOverride(int vehicleIndex);
+	//Not owned, has to outlive the vehicle or be cleared with nullptr. Kinematic cars without one park
+	void								SetLODSpline(int vehicleIndex, const VehicleSpline* spline);
+	const VehicleSpline*				GetLODSpline(int vehicleIndex) const { return m_vehicles[vehicleIndex].m_lodSpline; }
+	//Observers are usually replaced every step, clearing keeps the storage
+	void								AddLODObserver(const VehicleLODObserver& observer) { m_lodObservers.push_back(observer); }
+	void								ClearLODObservers() { m_lodObservers.clear(); }
+	//Every kinematic car goes back to a simulated one, call before teleporting vehicles
+	void								ResetSimLOD();
+
+	int									GetNumVehiclesAtQuality(eVehicleQueryQuality quality) const { return m_numVehiclesAtQuality[quality]; }
+	int									GetNumWheelQueriesLastStep() const { return m_numWheelQueriesLastStep; }
+	eVehicleQueryQuality				GetQueryQuality(int vehicleIndex) const { return m_vehicles[vehicleIndex].m_queryQuality; }
+	int									GetNumVehiclesAtSimLOD(eVehicleSimLOD simLOD) const { return m_numVehiclesAtSimLOD[simLOD]; }
+	int									GetNumSimLODChangesLastStep() const { return m_numSimLODChangesLastStep; }
+	eVehicleSimLOD						GetSimLOD(int vehicleIndex) const { return m_vehicles[vehicleIndex].m_simLOD; }
+
+	int									GetNumVehicles() const { return (int)m_vehicles.size(); }
+	int									GetMaxVehicles() const { return m_maxVehicles; }
+	PxVehicleDrive4W*					GetVehicle(int vehicleIndex) const { return m_vehicles[vehicleIndex].m_vehicle; }
+	PxVehicleDrive4WRawInputData*		GetVehicleInputData(int vehicleIndex) const { return m_vehicles[vehicleIndex].m_inputData; }
+	PxScene&							GetScene() const { return m_scene; }
+	const VehicleArchetype&				GetVehicleArchetype(int vehicleIndex) const { return *m_vehicles[vehicleIndex].m_archetype; }
+	bool								IsVehicleInAir(int vehicleIndex) const { return m_vehicles[vehicleIndex].m_isInAir; }
+
+private:
+	void								SmoothVehicleInputs(ManagedVehicle& managedVehicle, float deltaTime);
+	void								SelectSimLODs();
+	void								ApplySimLODBudget(eVehicleSimLOD simLOD, int maxVehicles);
+	void								ChangeSimLOD(ManagedVehicle& managedVehicle, eVehicleSimLOD simLOD);
+	int									AddVehicle(PxVehicleDrive4W& vehicle, PxVehicleDrive4WRawInputData& inputData, const VehicleArchetype& archetype);
+	void								MakeKinematic(ManagedVehicle& managedVehicle);
+	void								MakeSimulated(ManagedVehicle& managedVehicle);
+	bool								PlaceOnGround(const ManagedVehicle& managedVehicle, const PxVec3& heading, PxTransform& pose) const;
+	void								MoveKinematicVehicles(float deltaTime);
+	int									GatherSimulatedVehicles();
+	void								SelectSuspensionQueries();
+	void								RunSuspensionQueries();
+	void								UpdateVehiclesConcurrent(int numSimulatedVehicles, float deltaTime, const PxVec3& gravity, const PxVehicleDrivableSurfaceToTireFrictionPairs& tireFrictionPairs);
+	void								SetConcurrentUpdateBuffers(int vehicleIndex);
+
+private:
+	int									m_maxVehicles = 0;
+	PxScene&							m_scene;
+	VehicleArchetypeRegistry&			m_archetypes;
+	VehicleDescriptor					m_defaultDescriptor;
+	std::vector<ManagedVehicle>			m_vehicles;
+
+	//Shared query buffers, one batch holds every vehicle
+	PhysXTaggedAllocator				m_queryAllocator;
+	VehicleSceneQueryData*				m_sceneQueryData = nullptr;
+	PxBatchQuery*						m_batchQuery = nullptr;
+	VehicleSceneQueryData*				m_sweepQueryData = nullptr;
+	PxBatchQuery*						m_sweepBatchQuery = nullptr;
+
+	//Which vehicles query this step, indexed like m_vehicles
+	bool*								m_vehiclesToRaycast = nullptr;
+	bool*								m_vehiclesToSweep = nullptr;
+	int									m_numRaycastVehicles = 0;
+	int									m_numSweepVehicles = 0;
+
+	//Query LOD
+	PxVec3								m_lodFocus = PxVec3(0.f, 0.f, 0.f);
+	float								m_raycastDistance = 60.f;
+	int									m_cachedQuerySteps = 4;
+	int									m_numVehiclesAtQuality[NUM_VEHICLE_QUERY_QUALITIES] = {};
+	int									m_numWheelQueriesLastStep = 0;
+
+	//Simulation LOD, the full tier ends at m_raycastDistance
+	std::vector<VehicleLODObserver>		m_lodObservers;
+	float								m_kinematicDistance = 150.f;
+	float								m_lodHysteresis = 5.f;
+	int									m_reducedQuerySteps = 1;
+	int									m_maxFullLODVehicles = 0;
+	int									m_maxReducedLODVehicles = 0;
+	int									m_numVehiclesAtSimLOD[NUM_VEHICLE_SIM_LODS] = {};
+	int									m_numSimLODChangesLastStep = 0;
+	//Scratch for picking LODs, reserved for every vehicle. Targets are indexed like m_vehicles
+	std::vector<eVehicleSimLOD>			m_simLODTargets;
+	std::vector<int>					m_lodCandidates;
+
+	//Parallel arrays handed straight to the vehicle SDK
+	std::vector<PxVehicleWheels*>		m_vehicleWheels;
+	std::vector<PxWheelQueryResult>		m_wheelQueryResults;
+	std::vector<PxVehicleWheelQueryResult>	m_vehicleQueryResults;
+	//The same without kinematic vehicles, packed every step for PxVehicleUpdates
+	std::vector<PxVehicleWheels*>		m_simulatedWheels;
+	std::vector<PxVehicleWheelQueryResult>	m_simulatedQueryResults;
+	std::vector<PxVehicleConcurrentUpdateData>	m_simulatedConcurrentUpdates;
+
+	//Only used when the update is split across threads. Actor writes are deferred to a serial PxVehiclePostUpdates
+	WorkerPool*							m_workerPool = nullptr;
+	int									m_vehiclesPerChunk = 16;
+	std::vector<PxVehicleConcurrentUpdateData>		m_concurrentUpdates;
+	std::vector<PxVehicleWheelConcurrentUpdateData>	m_concurrentWheelUpdates;
+	double								m_lastVehicleUpdateSeconds = 0.0;
+
+public:
+	PxVehicleKeySmoothingData			m_keySmoothingData =
+	{
+		{
+			6.0f,	//rise rate eANALOG_INPUT_ACCEL
+			6.0f,	//rise rate eANALOG_INPUT_BRAKE
+			6.0f,	//rise rate eANALOG_INPUT_HANDBRAKE
+			2.5f,	//rise rate eANALOG_INPUT_STEER_LEFT
+			2.5f,	//rise rate eANALOG_INPUT_STEER_RIGHT
+		},
+		{
+			10.0f,	//fall rate eANALOG_INPUT_ACCEL
+			10.0f,	//fall rate eANALOG_INPUT_BRAKE
+			10.0f,	//fall rate eANALOG_INPUT_HANDBRAKE
+			5.0f,	//fall rate eANALOG_INPUT_STEER_LEFT
+			5.0f	//fall rate eANALOG_INPUT_STEER_RIGHT
+		}
+	};
+};
@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/VehicleSpline.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Standard
+#include <algorithm>
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleSpline::VehicleSpline(const std::vector<PxVec3>& controlPoints, bool isLooped, int samplesPerSegment)
+	: m_controlPoints(controlPoints)
+	, m_isLooped(isLooped)
+{
+	if (m_controlPoints.size() < 2 || samplesPerSegment < 1)
+	{
+		ERROR_AND_DIE(">> A vehicle spline needs at least two control points and one sample per segment");
+	}
+
+	int numSegments = m_isLooped ? (int)m_controlPoints.size() : (int)m_controlPoints.size() - 1;
+	m_samples.reserve(numSegments * samplesPerSegment + 1);
+	m_sampleDistances.reserve(numSegments * samplesPerSegment + 1);
+
+	for (int segmentIndex = 0; segmentIndex < numSegments; ++segmentIndex)
+	{
+		for (int sampleIndex = 0; sampleIndex < samplesPerSegment; ++sampleIndex)
+		{
+			m_samples.push_back(EvaluateSegment(segmentIndex, (float)sampleIndex / (float)samplesPerSegment));
+		}
+	}
+
+	//The end of the last segment, which is the first control point again on a loop
+	m_samples.push_back(m_isLooped ? m_controlPoints.front() : m_controlPoints.back());
+
+	float distance = 0.f;
+	m_sampleDistances.push_back(distance);
+	for (int sampleIndex = 1; sampleIndex < (int)m_samples.size(); ++sampleIndex)
+	{
+		distance += (m_samples[sampleIndex] - m_samples[sampleIndex - 1]).magnitude();
+		m_sampleDistances.push_back(distance);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleSpline::~VehicleSpline()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float VehicleSpline::WrapDistance(float distance) const
+{
+	float length = GetLength();
+	if (length <= 0.f)
+	{
+		return 0.f;
+	}
+
+	if (m_isLooped)
+	{
+		distance = fmodf(distance, length);
+		return distance < 0.f ? distance + length : distance;
+	}
+
+	return PxClamp(distance, 0.f, length);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxVec3 VehicleSpline::GetPosition(float distance) const
+{
+	distance = WrapDistance(distance);
+	int sampleIndex = FindSampleIndex(distance);
+
+	float segmentLength = m_sampleDistances[sampleIndex + 1] - m_sampleDistances[sampleIndex];
+	float fraction = segmentLength > 0.f ? (distance - m_sampleDistances[sampleIndex]) / segmentLength : 0.f;
+	return m_samples[sampleIndex] + (m_samples[sampleIndex + 1] - m_samples[sampleIndex]) * fraction;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxVec3 VehicleSpline::GetTangent(float distance) const
+{
+	int sampleIndex = FindSampleIndex(WrapDistance(distance));
+	PxVec3 tangent = m_samples[sampleIndex + 1] - m_samples[sampleIndex];
+
+	//Repeated control points leave zero length pieces
+	return tangent.isZero() ? PxVec3(0.f, 0.f, 1.f) : tangent.getNormalized();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float VehicleSpline::FindClosestDistance(const PxVec3& position) const
+{
+	int closestIndex = 0;
+	float closestDistanceSq = (m_samples[0] - position).magnitudeSquared();
+	for (int sampleIndex = 1; sampleIndex < (int)m_samples.size(); ++sampleIndex)
+	{
+		float distanceSq = (m_samples[sampleIndex] - position).magnitudeSquared();
+		if (distanceSq < closestDistanceSq)
+		{
+			closestDistanceSq = distanceSq;
+			closestIndex = sampleIndex;
+		}
+	}
+
+	return m_sampleDistances[closestIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxVec3 VehicleSpline::EvaluateSegment(int segmentIndex, float t) const
+{
+	int numControlPoints = (int)m_controlPoints.size();
+
+	//Open splines repeat their end points, looped ones wrap around
+	int indices[4];
+	for (int pointIndex = 0; pointIndex < 4; ++pointIndex)
+	{
+		int index = segmentIndex - 1 + pointIndex;
+		indices[pointIndex] = m_isLooped ? (index + numControlPoints) % numControlPoints : PxClamp(index, 0, numControlPoints - 1);
+	}
+
+	const PxVec3& p0 = m_controlPoints[indices[0]];
+	const PxVec3& p1 = m_controlPoints[indices[1]];
+	const PxVec3& p2 = m_controlPoints[indices[2]];
+	const PxVec3& p3 = m_controlPoints[indices[3]];
+
+	float t2 = t * t;
+	float t3 = t2 * t;
+	return (p1 * 2.f + (p2 - p0) * t + (p0 * 2.f - p1 * 5.f + p2 * 4.f - p3) * t2 + (p1 * 3.f - p0 - p2 * 3.f + p3) * t3) * 0.5f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int VehicleSpline::FindSampleIndex(float distance) const
+{
+	//Last sample at or before distance, never the final sample so there is always a next one
+	int sampleIndex = (int)(std::upper_bound(m_sampleDistances.begin(), m_sampleDistances.end(), distance) - m_sampleDistances.begin()) - 1;
+	return PxClamp(sampleIndex, 0, (int)m_samples.size() - 2);
+}
@@ -0,0 +1,43 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Third Party
+#include "PxPhysicsAPI.h"
+//Standard
+#include <vector>
+
+using namespace physx;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Catmull-Rom spline through a list of control points, sampled once into a polyline so it can be walked by distance.
+// Kinematic LOD vehicles follow one of these while they are too far away to be simulated
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleSpline
+{
+public:
+	//A looped spline joins the last control point back to the first. Needs at least two control points
+	VehicleSpline(const std::vector<PxVec3>& controlPoints, bool isLooped, int samplesPerSegment = 16);
+	~VehicleSpline();
+
+	float								GetLength() const { return m_sampleDistances.back(); }
+	bool								IsLooped() const { return m_isLooped; }
+
+	//Looped splines wrap the distance, open ones clamp it to the ends
+	float								WrapDistance(float distance) const;
+	PxVec3								GetPosition(float distance) const;
+	//Unit length
+	PxVec3								GetTangent(float distance) const;
+	//Distance along the spline of the sample closest to position
+	float								FindClosestDistance(const PxVec3& position) const;
+
+private:
+	PxVec3								EvaluateSegment(int segmentIndex, float t) const;
+	int									FindSampleIndex(float distance) const;
+
+private:
+	std::vector<PxVec3>					m_controlPoints;
+	bool								m_isLooped = false;
+
+	std::vector<PxVec3>					m_samples;
+	//Distance along the spline at each sample, starts at 0
+	std::vector<float>					m_sampleDistances;
+};
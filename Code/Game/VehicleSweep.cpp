@@ -0,0 +1,355 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/VehicleSweep.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/CarController.hpp"
+#include "Game/Game.hpp"
+#include "Game/VehicleManager.hpp"
+//Standard
+#include <algorithm>
+#include <fstream>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// GLOBAL DATA
+//------------------------------------------------------------------------------------------------------------------------------
+//Past this much tilt the car is on its side or roof and the lap is over
+const float gSweepRolledOverDegrees = 70.f;
+//Full lock for a waypoint this many radians off the nose
+const float gSweepSteerGain = 1.5f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static std::vector<std::string> SplitSweepString(const std::string& text, char delimiter)
+{
+	std::vector<std::string> parts;
+	size_t start = 0;
+	while (start <= text.size())
+	{
+		size_t end = text.find(delimiter, start);
+		end = end == std::string::npos ? text.size() : end;
+		if (end > start)
+		{
+			parts.push_back(text.substr(start, end - start));
+		}
+		start = end + 1;
+	}
+	return parts;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleSweep::VehicleSweep(const VehicleSweepSettings& settings)
+	: m_settings(settings)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleSweep::~VehicleSweep()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleSweep::Run(const Game& templateGame)
+{
+	const VehicleDescriptor& baseDescriptor = templateGame.m_vehicleDescriptor;
+	if (!ParseParameters(baseDescriptor))
+	{
+		return false;
+	}
+
+	ParseTrack(templateGame.GetCarController()->GetVehicle()->getRigidDynamicActor()->getGlobalPose());
+	if (m_trackWaypoints.empty())
+	{
+		printf("\n >> Vehicle sweep track %s has no waypoints\n", m_settings.m_track.c_str());
+		return false;
+	}
+
+	MakeCombinations(baseDescriptor);
+	printf("\n >> Vehicle sweep : %i combinations of %i parameters, %i waypoints, %.1f s lap limit", (int)m_descriptors.size(),
+		(int)m_parameters.size(), (int)m_trackWaypoints.size(), m_settings.m_maxLapSeconds);
+
+	//One car alone per scene, AI traffic would only add noise to the lap times. Every combination is a scene of its own, so
+	//they are built and released a wave at a time rather than all held at once
+	BatchEpisodeSettings batchSettings;
+	batchSettings.m_numEpisodes = (int)m_descriptors.size();
+	batchSettings.m_numStepsPerEpisode = (int)ceilf(m_settings.m_maxLapSeconds / m_settings.m_stepSeconds);
+	batchSettings.m_stepSeconds = m_settings.m_stepSeconds;
+	batchSettings.m_numThreads = m_settings.m_numThreads;
+	batchSettings.m_spawnTemplateAIVehicles = false;
+	batchSettings.m_runInWaves = true;
+
+	BatchEpisodeRunner batchRunner(batchSettings);
+	batchRunner.SetPlayerDescriptors(m_descriptors);
+	batchRunner.SetStepFunction([this](BatchEpisode& episode, int stepIndex)
+	{
+		return DriveTestLap(episode, stepIndex);
+	});
+
+	batchRunner.StartUp(templateGame);
+	batchRunner.Run();
+	batchRunner.PrintReport();
+
+	for (int episodeIndex = 0; episodeIndex < batchRunner.GetNumEpisodes(); ++episodeIndex)
+	{
+		const BatchEpisode& episode = batchRunner.GetEpisode(episodeIndex);
+		VehicleSweepResult& result = m_results[episodeIndex];
+		result.m_stepMicroseconds = episode.m_numStepsTaken > 0 ? episode.m_wallSeconds * 1000000.0 / (double)episode.m_numStepsTaken : 0.0;
+	}
+
+	batchRunner.ShutDown();
+
+	RankResults();
+	PrintResults();
+
+	bool isWritten = WriteCSV();
+	printf("\n >> Vehicle sweep results %s %s", isWritten ? "written to" : "could not be written to", m_settings.m_csvPath.c_str());
+
+	if (!m_settings.m_bestDescriptorPath.empty())
+	{
+		bool isBestWritten = m_descriptors[m_ranking[0]].SaveToXml(m_settings.m_bestDescriptorPath);
+		printf("\n >> Best setup %s %s", isBestWritten ? "written to" : "could not be written to", m_settings.m_bestDescriptorPath.c_str());
+		isWritten = isWritten && isBestWritten;
+	}
+
+	printf("\n");
+	return isWritten;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleSweep::ParseParameters(const VehicleDescriptor& baseDescriptor)
+{
+	std::vector<std::string> parameterStrings = SplitSweepString(m_settings.m_parameters, ';');
+	for (int parameterIndex = 0; parameterIndex < (int)parameterStrings.size(); ++parameterIndex)
+	{
+		const std::string& parameterString = parameterStrings[parameterIndex];
+		size_t equalsIndex = parameterString.find('=');
+
+		VehicleSweepParameter parameter;
+		parameter.m_name = parameterString.substr(0, equalsIndex);
+		if (equalsIndex == std::string::npos || baseDescriptor.FindParameter(parameter.m_name) == nullptr)
+		{
+			printf("\n >> Vehicle sweep parameter %s is not a vehicle descriptor parameter\n", parameterString.c_str());
+			return false;
+		}
+
+		std::vector<std::string> valueStrings = SplitSweepString(parameterString.substr(equalsIndex + 1), ',');
+		for (int valueIndex = 0; valueIndex < (int)valueStrings.size(); ++valueIndex)
+		{
+			parameter.m_values.push_back((float)atof(valueStrings[valueIndex].c_str()));
+		}
+
+		if (parameter.m_values.empty())
+		{
+			printf("\n >> Vehicle sweep parameter %s has no values\n", parameter.m_name.c_str());
+			return false;
+		}
+
+		m_parameters.push_back(parameter);
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleSweep::ParseTrack(const PxTransform& startPose)
+{
+	std::vector<std::string> waypointStrings = SplitSweepString(m_settings.m_track, ';');
+	for (int waypointIndex = 0; waypointIndex < (int)waypointStrings.size(); ++waypointIndex)
+	{
+		float x = 0.f;
+		float z = 0.f;
+		if (sscanf(waypointStrings[waypointIndex].c_str(), "%f,%f", &x, &z) == 2)
+		{
+			m_trackWaypoints.push_back(startPose.transform(PxVec3(x, 0.f, z)));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleSweep::MakeCombinations(const VehicleDescriptor& baseDescriptor)
+{
+	int numCombinations = 1;
+	for (int parameterIndex = 0; parameterIndex < (int)m_parameters.size(); ++parameterIndex)
+	{
+		numCombinations *= (int)m_parameters[parameterIndex].m_values.size();
+	}
+
+	m_descriptors.resize(numCombinations, baseDescriptor);
+	m_results.resize(numCombinations);
+
+	//The first parameter changes fastest
+	for (int combinationIndex = 0; combinationIndex < numCombinations; ++combinationIndex)
+	{
+		m_results[combinationIndex].m_combinationIndex = combinationIndex;
+
+		int remainder = combinationIndex;
+		for (int parameterIndex = 0; parameterIndex < (int)m_parameters.size(); ++parameterIndex)
+		{
+			const VehicleSweepParameter& parameter = m_parameters[parameterIndex];
+			int numValues = (int)parameter.m_values.size();
+
+			*m_descriptors[combinationIndex].FindParameter(parameter.m_name) = parameter.m_values[remainder % numValues];
+			remainder /= numValues;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleSweep::DriveTestLap(BatchEpisode& episode, int stepIndex)
+{
+	VehicleSweepResult& result = m_results[episode.m_episodeIndex];
+	PxTransform pose = episode.m_carController->GetVehicle()->getRigidDynamicActor()->getGlobalPose();
+
+	//Scored on the state the previous step left the car in
+	PxVec3 up = pose.q.getBasisVector1();
+	float tiltDegrees = acosf(PxClamp(up.y, -1.f, 1.f)) * 180.f / PxPi;
+	result.m_maxTiltDegrees = tiltDegrees > result.m_maxTiltDegrees ? tiltDegrees : result.m_maxTiltDegrees;
+	result.m_numAirborneSteps += episode.m_vehicleManager->IsVehicleInAir(episode.m_playerVehicleIndex) ? 1 : 0;
+	//States scored so far, the airborne share is taken over these
+	result.m_numSteps = stepIndex + 1;
+
+	if (tiltDegrees > gSweepRolledOverDegrees)
+	{
+		result.m_hasRolledOver = true;
+		return false;
+	}
+
+	PxVec3 toWaypoint = m_trackWaypoints[result.m_numWaypointsReached] - pose.p;
+	toWaypoint.y = 0.f;
+	if (toWaypoint.magnitude() < m_settings.m_waypointRadius)
+	{
+		result.m_numWaypointsReached++;
+		if (result.m_numWaypointsReached == (int)m_trackWaypoints.size())
+		{
+			result.m_isLapComplete = true;
+			result.m_lapSeconds = (float)stepIndex * m_settings.m_stepSeconds;
+			return false;
+		}
+
+		toWaypoint = m_trackWaypoints[result.m_numWaypointsReached] - pose.p;
+		toWaypoint.y = 0.f;
+	}
+
+	//Steer for the waypoint and ease off the throttle the harder the turn. CarController steers right for positive values
+	PxVec3 localToWaypoint = pose.q.rotateInv(toWaypoint);
+	float headingRadians = atan2f(localToWaypoint.x, localToWaypoint.z);
+	float steer = PxClamp(-headingRadians * gSweepSteerGain, -1.f, 1.f);
+
+	CarController& carController = *episode.m_carController;
+	carController.ReleaseAllControls();
+	carController.AccelerateForward(1.f - 0.5f * PxAbs(steer));
+	carController.Steer(steer);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleSweep::RankResults()
+{
+	m_ranking.resize(m_results.size());
+	for (int resultIndex = 0; resultIndex < (int)m_results.size(); ++resultIndex)
+	{
+		m_ranking[resultIndex] = resultIndex;
+	}
+
+	//Finished laps by time, then unfinished ones by how far they got. Ties go to the steadier car, then the cheaper step
+	std::stable_sort(m_ranking.begin(), m_ranking.end(), [this](int lhsIndex, int rhsIndex)
+	{
+		const VehicleSweepResult& lhs = m_results[lhsIndex];
+		const VehicleSweepResult& rhs = m_results[rhsIndex];
+
+		if (lhs.m_isLapComplete != rhs.m_isLapComplete)
+		{
+			return lhs.m_isLapComplete;
+		}
+
+		if (lhs.m_isLapComplete && lhs.m_lapSeconds != rhs.m_lapSeconds)
+		{
+			return lhs.m_lapSeconds < rhs.m_lapSeconds;
+		}
+
+		if (!lhs.m_isLapComplete && lhs.m_numWaypointsReached != rhs.m_numWaypointsReached)
+		{
+			return lhs.m_numWaypointsReached > rhs.m_numWaypointsReached;
+		}
+
+		if (lhs.m_maxTiltDegrees != rhs.m_maxTiltDegrees)
+		{
+			return lhs.m_maxTiltDegrees < rhs.m_maxTiltDegrees;
+		}
+
+		return lhs.m_stepMicroseconds < rhs.m_stepMicroseconds;
+	});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleSweep::PrintResults() const
+{
+	printf("\n >> %-5s %-9s %9s %9s %9s %9s %9s", "Rank", "Combo", "Lap s", "Waypoint", "Tilt deg", "Air %", "Step us");
+
+	int numToPrint = m_settings.m_numResultsToPrint < (int)m_ranking.size() ? m_settings.m_numResultsToPrint : (int)m_ranking.size();
+	for (int rankIndex = 0; rankIndex < numToPrint; ++rankIndex)
+	{
+		const VehicleSweepResult& result = m_results[m_ranking[rankIndex]];
+		float airbornePercent = result.m_numSteps > 0 ? 100.f * (float)result.m_numAirborneSteps / (float)result.m_numSteps : 0.f;
+
+		char lapText[32];
+		if (result.m_isLapComplete)
+		{
+			snprintf(lapText, sizeof(lapText), "%.2f", result.m_lapSeconds);
+		}
+		else
+		{
+			snprintf(lapText, sizeof(lapText), "%s", result.m_hasRolledOver ? "rolled" : "DNF");
+		}
+
+		printf("\n >> %-5i %-9i %9s %6i/%-2i %9.1f %9.1f %9.1f", rankIndex + 1, result.m_combinationIndex, lapText, result.m_numWaypointsReached,
+			(int)m_trackWaypoints.size(), result.m_maxTiltDegrees, airbornePercent, result.m_stepMicroseconds);
+
+		const VehicleDescriptor& descriptor = m_descriptors[result.m_combinationIndex];
+		for (int parameterIndex = 0; parameterIndex < (int)m_parameters.size(); ++parameterIndex)
+		{
+			const std::string& name = m_parameters[parameterIndex].m_name;
+			printf(" %s=%g", name.c_str(), *descriptor.FindParameter(name));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool VehicleSweep::WriteCSV() const
+{
+	std::ofstream file(m_settings.m_csvPath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "rank,combination";
+	for (int parameterIndex = 0; parameterIndex < (int)m_parameters.size(); ++parameterIndex)
+	{
+		file << "," << m_parameters[parameterIndex].m_name;
+	}
+	file << ",lapComplete,lapSeconds,waypointsReached,rolledOver,maxTiltDegrees,airborneSteps,steps,stepMicroseconds\n";
+
+	char line[256];
+	for (int rankIndex = 0; rankIndex < (int)m_ranking.size(); ++rankIndex)
+	{
+		const VehicleSweepResult& result = m_results[m_ranking[rankIndex]];
+		file << rankIndex + 1 << "," << result.m_combinationIndex;
+
+		const VehicleDescriptor& descriptor = m_descriptors[result.m_combinationIndex];
+		for (int parameterIndex = 0; parameterIndex < (int)m_parameters.size(); ++parameterIndex)
+		{
+			snprintf(line, sizeof(line), ",%g", *descriptor.FindParameter(m_parameters[parameterIndex].m_name));
+			file << line;
+		}
+
+		snprintf(line, sizeof(line), ",%d,%.4f,%d,%d,%.3f,%d,%d,%.3f\n", result.m_isLapComplete ? 1 : 0, result.m_lapSeconds,
+			result.m_numWaypointsReached, result.m_hasRolledOver ? 1 : 0, result.m_maxTiltDegrees, result.m_numAirborneSteps, result.m_numSteps,
+			result.m_stepMicroseconds);
+		file << line;
+	}
+
+	return file.good();
+}
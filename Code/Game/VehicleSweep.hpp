@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Game Systems
+#include "Game/BatchEpisodeRunner.hpp"
+#include "Game/VehicleDescriptor.hpp"
+//Standard
+#include <string>
+#include <vector>
+
+class Game;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleSweepSettings
+{
+	//"Engine.peakTorque=400,500,600;Suspension.springStrength=25000,35000", every combination of the values is driven
+	std::string							m_parameters;
+	//Waypoints as "x,z;x,z" in the player start pose's frame, a lap ends at the last one
+	std::string							m_track = "12,20;30,55;10,90;-15,60;-8,15";
+	float								m_waypointRadius = 6.f;
+	float								m_maxLapSeconds = 90.f;
+	float								m_stepSeconds = 1.f / 60.f;
+	int									m_numThreads = 0;
+
+	int									m_numResultsToPrint = 10;
+	std::string							m_csvPath = "VehicleSweep.csv";
+	//Empty skips writing the winning setup
+	std::string							m_bestDescriptorPath;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleSweepParameter
+{
+	std::string							m_name;
+	std::vector<float>					m_values;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleSweepResult
+{
+	int									m_combinationIndex = 0;
+	int									m_numWaypointsReached = 0;
+	bool								m_isLapComplete = false;
+	bool								m_hasRolledOver = false;
+	float								m_lapSeconds = 0.f;
+	float								m_maxTiltDegrees = 0.f;
+	int									m_numAirborneSteps = 0;
+	int									m_numSteps = 0;
+	double								m_stepMicroseconds = 0.0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Drives every combination of a grid of VehicleDescriptor parameters around a waypoint test track, one batch episode per
+// combination, and ranks them by lap time, then by how stable the car stayed and what a step cost. Headless only
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleSweep
+{
+public:
+	explicit VehicleSweep(const VehicleSweepSettings& settings);
+	~VehicleSweep();
+
+	//The template's vehicle descriptor is the base every combination changes. Returns false on bad settings or output
+	bool								Run(const Game& templateGame);
+
+private:
+	bool								ParseParameters(const VehicleDescriptor& baseDescriptor);
+	void								ParseTrack(const PxTransform& startPose);
+	void								MakeCombinations(const VehicleDescriptor& baseDescriptor);
+	bool								DriveTestLap(BatchEpisode& episode, int stepIndex);
+	void								RankResults();
+	void								PrintResults() const;
+	bool								WriteCSV() const;
+
+private:
+	VehicleSweepSettings				m_settings;
+	std::vector<VehicleSweepParameter>	m_parameters;
+	std::vector<PxVec3>					m_trackWaypoints;
+
+	//Indexed by combination, which is also the episode index. Each entry is only touched by the thread running that episode
+	std::vector<VehicleDescriptor>		m_descriptors;
+	std::vector<VehicleSweepResult>		m_results;
+
+	std::vector<int>					m_ranking;
+};
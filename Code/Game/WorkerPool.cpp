@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/WorkerPool.hpp"
+//Game Systems
+#include "Game/Profiler.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+WorkerPool::WorkerPool(int numThreads)
+{
+	m_nextJobIndex = 0;
+
+	for (int workerIndex = 1; workerIndex < numThreads; ++workerIndex)
+	{
+		m_workers.emplace_back(&WorkerPool::WorkerMain, this);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (int workerIndex = 0; workerIndex < (int)m_workers.size(); ++workerIndex)
+	{
+		m_workers[workerIndex].join();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WorkerPool::ParallelFor(int numJobs, const std::function<void(int jobIndex)>& job)
+{
+	if (m_workers.empty() || numJobs <= 1)
+	{
+		for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+		{
+			job(jobIndex);
+		}
+		return;
+	}
+
+	{
+		//A worker that woke late for the previous batch may still be inside RunJobs, let it drain before resetting the counter
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this]() { return m_numBusyWorkers == 0; });
+
+		m_job = &job;
+		m_numJobs = numJobs;
+		m_nextJobIndex = 0;
+		m_batchIndex++;
+	}
+	m_wakeCondition.notify_all();
+
+	RunJobs(job, numJobs);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [this]() { return m_numBusyWorkers == 0; });
+	m_job = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WorkerPool::WorkerMain()
+{
+	Profiler::SetThreadName("Worker Pool");
+
+	int lastBatchIndex = 0;
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wakeCondition.wait(lock, [this, lastBatchIndex]() { return m_isQuitting || m_batchIndex != lastBatchIndex; });
+
+		if (m_isQuitting)
+		{
+			return;
+		}
+
+		lastBatchIndex = m_batchIndex;
+		const std::function<void(int)>* job = m_job;
+		int numJobs = m_numJobs;
+		m_numBusyWorkers++;
+		lock.unlock();
+
+		if (job != nullptr)
+		{
+			RunJobs(*job, numJobs);
+		}
+
+		lock.lock();
+		m_numBusyWorkers--;
+		if (m_numBusyWorkers == 0)
+		{
+			m_doneCondition.notify_all();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WorkerPool::RunJobs(const std::function<void(int jobIndex)>& job, int numJobs)
+{
+	int jobIndex = m_nextJobIndex.fetch_add(1);
+	while (jobIndex < numJobs)
+	{
+		job(jobIndex);
+		jobIndex = m_nextJobIndex.fetch_add(1);
+	}
+}
@@ -0,0 +1,44 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+//Standard
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Small fixed size thread pool for splitting a loop into jobs. The calling thread works on the jobs too, so a pool of N
+// threads only spawns N - 1 workers. ParallelFor blocks until every job has finished
+//------------------------------------------------------------------------------------------------------------------------------
+class WorkerPool
+{
+public:
+	explicit WorkerPool(int numThreads);
+	~WorkerPool();
+
+	int									GetNumThreads() const { return (int)m_workers.size() + 1; }
+
+	void								ParallelFor(int numJobs, const std::function<void(int jobIndex)>& job);
+
+private:
+	void								WorkerMain();
+	void								RunJobs(const std::function<void(int jobIndex)>& job, int numJobs);
+
+private:
+	std::vector<std::thread>			m_workers;
+
+	std::mutex							m_mutex;
+	std::condition_variable				m_wakeCondition;
+	std::condition_variable				m_doneCondition;
+
+	//Everything below is guarded by m_mutex except the job counter
+	const std::function<void(int)>*		m_job = nullptr;
+	int									m_numJobs = 0;
+	int									m_batchIndex = 0;
+	int									m_numBusyWorkers = 0;
+	bool								m_isQuitting = false;
+
+	std::atomic<int>					m_nextJobIndex;
+};